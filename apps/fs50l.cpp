@@ -1,6 +1,7 @@
 #include "nexus/abstract/device.h"
 #include "nexus/abstract/listener.h"
 #include "nexus/modbus/rtu/client.h"
+#include "nexus/modbus/register_map.h"
 #include "nexus/http/server.h"
 
 #include "nexus/tools/filesystem.h"
@@ -15,39 +16,27 @@
 
 using namespace std::literals;
 
+using nexus::modbus::Field;
+using nexus::modbus::READ_HOLDING_REGISTERS;
+
+static constexpr Field fields[] = {
+    {"frequencyRunning", READ_HOLDING_REGISTERS, 0x3001, Field::U16, 1., 2},
+    {"busVoltage", READ_HOLDING_REGISTERS, 0x3002, Field::U16, .1, 1, "V"},
+    {"outputVoltage", READ_HOLDING_REGISTERS, 0x3003, Field::U16, .1, 1, "V"},
+    {"outputCurrent", READ_HOLDING_REGISTERS, 0x3004, Field::U16, 1., 1},
+    {"outputPower", READ_HOLDING_REGISTERS, 0x3005, Field::U16, 1., 1},
+    {"outputTorque", READ_HOLDING_REGISTERS, 0x3006, Field::U16, 1., 1},
+    {"runSpeed", READ_HOLDING_REGISTERS, 0x3007, Field::U16, 1., 2},
+    {"faultInfo", READ_HOLDING_REGISTERS, 0x8000, Field::U16, 1., 0, "", -1.},
+};
+
 class FS50L : virtual public nexus::modbus::rtu::Client, virtual public nexus::abstract::Device {
 public:
     FS50L(int address = 0x01, std::string port = "auto") : nexus::modbus::rtu::Client(address, port, B9600) {}
     virtual ~FS50L() {}
 
     void update() override {
-        auto res = this->ReadHoldingRegisters(0x3001, 7);
-        if (error() == nexus::modbus::Error::NONE) {
-            frequencyRunning = res[0];
-            busVoltage = res[1] * .1f;
-            outputVoltage = res[2] * .1f;
-            outputCurrent = res[3];
-            outputPower = res[4];
-            outputTorque = res[5];
-            runSpeed = res[6];
-        } else {
-            frequencyRunning = NAN;
-            busVoltage = NAN;
-            outputVoltage = NAN;
-            outputCurrent = NAN;
-            outputPower = NAN;
-            outputTorque = NAN;
-            runSpeed = NAN;
-        }
-
-        std::this_thread::sleep_for(std::chrono::milliseconds(1));
-
-        auto res2 = this->ReadHoldingRegisters(0x8000, 1);
-        if (error() == nexus::modbus::Error::NONE) {
-            faultInfo = res2[0];
-        } else {
-            faultInfo = -1;
-        }
+        registers.update(*this);
     }
 
     std::string path() const override { 
@@ -55,21 +44,13 @@ public:
     }
     
     std::string json() const override { 
-        return nexus::tools::json_concat(
-            nexus::modbus::rtu::Client::json(), 
-            "{"
-                "\"frequencyRunning\": " + nexus::tools::to_string(frequencyRunning, 2) + ", "
-                "\"busVoltage\": " + nexus::tools::to_string(busVoltage, 1) + ", "
-                "\"outputCurrent\": " + nexus::tools::to_string(outputCurrent, 1) + ", "
-                "\"outputPower\": " + nexus::tools::to_string(outputPower, 1) + ", "
-                "\"outputTorque\": " + nexus::tools::to_string(outputTorque, 1) + ", "
-                "\"runSpeed\": " + nexus::tools::to_string(runSpeed, 2) + ", "
-                "\"faultInfo\": " + std::to_string(faultInfo) + 
-            "}"
-        ); 
+        return nexus::tools::json_concat(nexus::modbus::rtu::Client::json(), registers.json()); 
     }
 
     std::string post(std::string_view method_name, std::string_view json_request) override {
+        // commands from http go ahead of the background polls
+        val urgent = nexus::serial::Arbiter::Scope(nexus::serial::Arbiter::HIGH);
+
         if (method_name == "forward_running") {
             this->WriteSingleRegister(0x1000, 0x0001);
             return error() == nexus::modbus::Error::NONE
@@ -126,14 +107,7 @@ public:
         return nexus::modbus::rtu::Client::patch(json_request);
     }
 
-    float frequencyRunning;
-    float busVoltage;
-    float outputVoltage;
-    float outputCurrent;
-    float outputPower;
-    float outputTorque;
-    float runSpeed;
-    int faultInfo;
+    nexus::modbus::RegisterMap<fields> registers;
 };
 
 int main(int argc, char* argv[]) {
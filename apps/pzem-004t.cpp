@@ -1,6 +1,7 @@
 #include "nexus/abstract/device.h"
 #include "nexus/abstract/listener.h"
 #include "nexus/modbus/rtu/client.h"
+#include "nexus/modbus/register_map.h"
 #include "nexus/http/server.h"
 
 #include "nexus/tools/filesystem.h"
@@ -13,37 +14,30 @@
 
 using namespace std::literals;
 
+using nexus::modbus::Field;
+using nexus::modbus::WordOrder;
+using nexus::modbus::READ_INPUT_REGISTERS;
+using nexus::modbus::READ_HOLDING_REGISTERS;
+
+/// 32 bit values come low register first
+static constexpr Field fields[] = {
+    {"voltage", READ_INPUT_REGISTERS, 0x0000, Field::U16, .1, 1, "V"},
+    {"current", READ_INPUT_REGISTERS, 0x0001, Field::U32, .001, 3, "A", NAN, NAN, WordOrder::LITTLE},
+    {"power", READ_INPUT_REGISTERS, 0x0003, Field::U32, .1, 1, "W", NAN, NAN, WordOrder::LITTLE},
+    {"energy", READ_INPUT_REGISTERS, 0x0005, Field::U32, 1., 1, "Wh", NAN, NAN, WordOrder::LITTLE},
+    {"frequency", READ_INPUT_REGISTERS, 0x0007, Field::U16, .1, 1, "Hz"},
+    {"powerFactor", READ_INPUT_REGISTERS, 0x0008, Field::U16, .01, 2},
+    {"alarm", READ_INPUT_REGISTERS, 0x0009, Field::FLAG, 1., 0, "", 0.},
+    {"alarmThreshold", READ_HOLDING_REGISTERS, 0x0001, Field::U16, 1., 1, "W"},
+};
+
 class PZEM : virtual public nexus::modbus::rtu::Client, virtual public nexus::abstract::Device {
 public:
     PZEM(int address = 0xF8, std::string port = "auto") : nexus::modbus::rtu::Client(address, port, B9600) {}
     virtual ~PZEM() {}
 
     void update() override {
-        auto res = this->ReadInputRegisters(0x0000, 10);
-        if (error() == nexus::modbus::Error::NONE) {
-            voltage = res[0] * .1f;
-            current = (res[1] | res[2] << 16) * .001f;
-            power = (res[3] | res[4] << 16) * .1f;
-            energy = (res[5] | res[6] << 16) * 1.f;
-            frequency = res[7] * .1f;
-            powerFactor = res[8] * .01f;
-            alarm = res[9] == 0xFFFF;
-        } else {
-            voltage = NAN;
-            current = NAN;
-            power = NAN;
-            energy = NAN;
-            frequency = NAN;
-            powerFactor = NAN;
-            alarm = false;
-        }
-
-        res = this->ReadHoldingRegisters(0x0001, 1);
-        if (error() == nexus::modbus::Error::NONE) {
-            alarmThreshold = res[0];
-        } else {
-            alarmThreshold = NAN;
-        }
+        registers.update(*this);
     }
     
     std::string path() const override { 
@@ -51,19 +45,7 @@ public:
     }
     
     std::string json() const override { 
-        return nexus::tools::json_concat(
-            nexus::modbus::rtu::Client::json(), 
-            "{"
-                "\"voltage\": " + nexus::tools::to_string(voltage, 1) + ", "
-                "\"current\": " + nexus::tools::to_string(current, 3) + ", "
-                "\"power\": " + nexus::tools::to_string(power, 1) + ", "
-                "\"energy\": " + nexus::tools::to_string(energy, 1) + ", "
-                "\"frequency\": " + nexus::tools::to_string(frequency, 1) + ", "
-                "\"powerFactor\": " + nexus::tools::to_string(powerFactor, 2) + ", "
-                "\"alarm\": " + nexus::tools::to_string(alarm) + ", "
-                "\"alarmThreshold\": " + nexus::tools::to_string(alarmThreshold, 1) +
-            "}"
-        ); 
+        return nexus::tools::json_concat(nexus::modbus::rtu::Client::json(), registers.json()); 
     }
 
     std::string post(std::string_view method_name, std::string_view json_request) override {
@@ -88,9 +70,9 @@ public:
         if (at.is_number()) {
             auto res = this->WriteSingleRegister(0x0002, at.to_int());
             if (error() == nexus::modbus::Error::NONE) {
-                alarmThreshold = res;
+                registers.set("alarmThreshold", res);
             }
-            response = nexus::tools::json_concat(response, "\"alarmThreshold\": " + std::to_string(alarmThreshold) + "}");
+            response = nexus::tools::json_concat(response, "\"alarmThreshold\": " + std::to_string(registers.get("alarmThreshold")) + "}");
         }
 
         return response.empty() 
@@ -98,14 +80,7 @@ public:
             : nexus::tools::json_concat(nexus::tools::json_response_status_success("success update parameter"), response);
     }
 
-    float voltage;
-    float current;
-    float power;
-    float energy;
-    float frequency;
-    float powerFactor;
-    bool alarm;
-    float alarmThreshold;
+    nexus::modbus::RegisterMap<fields> registers;
 };
 
 int main(int argc, char* argv[]) {
@@ -1,6 +1,7 @@
 #include "nexus/abstract/device.h"
 #include "nexus/abstract/listener.h"
 #include "nexus/modbus/rtu/client.h"
+#include "nexus/modbus/register_map.h"
 #include "nexus/http/server.h"
 
 #include "nexus/tools/filesystem.h"
@@ -15,61 +16,32 @@
 
 using namespace std::literals;
 
+using nexus::modbus::Field;
+using nexus::modbus::READ_HOLDING_REGISTERS;
+
+static constexpr Field fields[] = {
+    {"frequencyRunning", READ_HOLDING_REGISTERS, 0x1001, Field::U16, 1., 2},
+    {"busVoltage", READ_HOLDING_REGISTERS, 0x1002, Field::U16, .1, 1, "V"},
+    {"outputVoltage", READ_HOLDING_REGISTERS, 0x1003, Field::U16, 1., 1, "V"},
+    {"outputCurrent", READ_HOLDING_REGISTERS, 0x1004, Field::U16, .01, 2, "A"},
+    {"outputPower", READ_HOLDING_REGISTERS, 0x1005, Field::U16, 1., 1},
+    {"outputTorque", READ_HOLDING_REGISTERS, 0x1006, Field::U16, 1., 1},
+    {"analogInput1", READ_HOLDING_REGISTERS, 0x100a, Field::U16, 1., 1},
+    {"analogInput2", READ_HOLDING_REGISTERS, 0x100b, Field::U16, 1., 1},
+    {"analogInput3", READ_HOLDING_REGISTERS, 0x100c, Field::U16, 1., 1},
+    {"loadSpeed", READ_HOLDING_REGISTERS, 0x100f, Field::U16, 1., 1},
+    {"state", READ_HOLDING_REGISTERS, 0x3000, Field::U16, 1., 0, "", -1.},
+    {"faultInfo", READ_HOLDING_REGISTERS, 0x8000, Field::U16, 1., 0, "", -1.},
+};
+
 class SHZK : virtual public nexus::modbus::rtu::Client, virtual public nexus::abstract::Device {
 public:
     SHZK(int address = 0x01, std::string port = "auto") : nexus::modbus::rtu::Client(address, port, B9600) {}
     virtual ~SHZK() {}
 
     void update() override {
-        auto res = this->ReadHoldingRegisters(0x1001, 6);
-        if (error() == nexus::modbus::Error::NONE) {
-            frequencyRunning = res[0];
-            busVoltage = res[1] * .1f;
-            outputVoltage = res[2];
-            outputCurrent = res[3] * .01f;
-            outputPower = res[4];
-            outputTorque = res[5];
-        } else {
-            frequencyRunning = NAN;
-            busVoltage = NAN;
-            outputVoltage = NAN;
-            outputCurrent = NAN;
-            outputPower = NAN;
-            outputTorque = NAN;
-        }
-        
-        std::this_thread::sleep_for(std::chrono::milliseconds(23));
-
-        auto res2 = this->ReadHoldingRegisters(0x100a, 6);
-        if (error() == nexus::modbus::Error::NONE) {
-            analogInput1 = res2[0];
-            analogInput2 = res2[1];
-            analogInput3 = res2[2];
-            loadSpeed = res2[5];
-        } else {
-            analogInput1 = NAN;
-            analogInput2 = NAN;
-            analogInput3 = NAN;
-            loadSpeed = NAN;
-        }
-
-        std::this_thread::sleep_for(std::chrono::milliseconds(23));
-
-        auto res3 = this->ReadHoldingRegisters(0x3000, 1);
-        if (error() == nexus::modbus::Error::NONE) {
-            state = res3[0];
-        } else {
-            state = -1;
-        }
-
-        std::this_thread::sleep_for(std::chrono::milliseconds(23));
-
-        auto res4 = this->ReadHoldingRegisters(0x8000, 1);
-        if (error() == nexus::modbus::Error::NONE) {
-            faultInfo = res4[0];
-        } else {
-            faultInfo = -1;
-        }
+        // the monitoring block 0x1001 - 0x100f is one read, with the unused registers between the fields
+        registers.update(*this);
     }
 
     std::string path() const override { 
@@ -77,26 +49,13 @@ public:
     }
     
     std::string json() const override { 
-        return nexus::tools::json_concat(
-            nexus::modbus::rtu::Client::json(), 
-            "{"
-                "\"frequencyRunning\": " + nexus::tools::to_string(frequencyRunning, 2) + ", "
-                "\"busVoltage\": " + nexus::tools::to_string(busVoltage, 1) + ", "
-                "\"outputVoltage\": " + nexus::tools::to_string(outputVoltage, 1) + ", "
-                "\"outputCurrent\": " + nexus::tools::to_string(outputCurrent, 2) + ", "
-                "\"outputPower\": " + nexus::tools::to_string(outputPower, 1) + ", "
-                "\"outputTorque\": " + nexus::tools::to_string(outputTorque, 1) + ", "
-                "\"analogInput1\": " + nexus::tools::to_string(analogInput1, 1) + ", "
-                "\"analogInput2\": " + nexus::tools::to_string(analogInput2, 1) + ", "
-                "\"analogInput3\": " + nexus::tools::to_string(analogInput3, 1) + ", "
-                "\"loadSpeed\": " + nexus::tools::to_string(loadSpeed, 1) + ", "
-                "\"state\": " + std::to_string(state) + ", "
-                "\"faultInfo\": " + std::to_string(faultInfo) +
-            "}"
-        ); 
+        return nexus::tools::json_concat(nexus::modbus::rtu::Client::json(), registers.json()); 
     }
 
     std::string post(std::string_view method_name, std::string_view json_request) override {
+        // commands from http go ahead of the background polls
+        val urgent = nexus::serial::Arbiter::Scope(nexus::serial::Arbiter::HIGH);
+
         if (method_name == "forward_running") {
             this->WriteSingleRegister(0x2000, 0x0001);
             return error() == nexus::modbus::Error::NONE
@@ -153,18 +112,7 @@ public:
         return nexus::modbus::rtu::Client::patch(json_request);
     }
 
-    float frequencyRunning;
-    float busVoltage;
-    float outputVoltage;
-    float outputCurrent;
-    float outputPower;
-    float outputTorque;
-    float analogInput1;
-    float analogInput2;
-    float analogInput3;
-    float loadSpeed;
-    int state;
-    int faultInfo;
+    nexus::modbus::RegisterMap<fields, 3> registers;
 };
 
 int main(int argc, char* argv[]) {
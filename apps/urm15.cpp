@@ -1,6 +1,7 @@
 #include "nexus/abstract/device.h"
 #include "nexus/abstract/listener.h"
 #include "nexus/modbus/rtu/client.h"
+#include "nexus/modbus/register_map.h"
 #include "nexus/http/server.h"
 
 #include "nexus/tools/filesystem.h"
@@ -15,10 +16,18 @@
 
 using namespace std::literals;
 
+using nexus::modbus::Field;
+using nexus::modbus::READ_HOLDING_REGISTERS;
+
+/// 0xFFFF while there is no measurement
+static constexpr Field fields[] = {
+    {"distance", READ_HOLDING_REGISTERS, 0x0005, Field::U16, .1, 1, "cm", NAN, 0xFFFF},
+    {"temperature", READ_HOLDING_REGISTERS, 0x0006, Field::U16, .1, 1, "C", NAN, 0xFFFF},
+};
+
 class URM15 : virtual public nexus::modbus::rtu::Client, virtual public nexus::abstract::Device {
     int verbose;
-    float distance = NAN;
-    float temperature = NAN;
+    nexus::modbus::RegisterMap<fields> registers;
 
 public:
     URM15(int address = 0x0F, std::string port = "auto", speed_t speed = B9600, int verbose = 0) 
@@ -31,14 +40,11 @@ public:
         this->WriteSingleRegister(0x0008, 0b1101); // send trigger
 
         std::this_thread::sleep_for(65ms);
-        var res = this->ReadHoldingRegisters(0x0005, 2);
-
-        distance = error() or res[0] == 0xFFFF ? NAN : res[0] * 0.1f;
-        temperature = error() or res[1] == 0xFFFF ? NAN : res[1] * 0.1f;
+        registers.update(*this);
 
         if (verbose) error() ? 
             printf("Error code: %d\n", error()) :
-            printf("Distance = %.1f cm, Temperature = %.1f C\n", distance, temperature);
+            printf("%s\n", registers.text().c_str());
     }
 
     std::string path() const override { 
@@ -46,12 +52,7 @@ public:
     }
     
     std::string json() const override { 
-        return nexus::tools::json_concat(
-            nexus::modbus::rtu::Client::json(), "{"
-                "\"distance\": " + nexus::tools::to_string(distance, 1) + ", "
-                "\"temperature\": " + nexus::tools::to_string(temperature, 1) + 
-            "}"
-        ); 
+        return nexus::tools::json_concat(nexus::modbus::rtu::Client::json(), registers.json()); 
     }
 
     std::string post(std::string_view method_name, std::string_view json_request) override {
@@ -0,0 +1,66 @@
+#include "nexus/modbus/api.h"
+#include "nexus/tools/options.h"
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include <etl/keywords.h>
+
+using nexus::modbus::api::CrcKernel;
+
+int main(int argc, char* argv[]) {
+    var total = size_t(1) << 28;
+
+    nexus::tools::execute_options(argc, argv, {
+        {'b', "bytes", required_argument, [&] (const char* arg) {
+            total = size_t(std::atoll(arg)) << 20;
+        }},
+        {'h', "help", no_argument, [] (const char*) {
+            std::cout << "Modbus crc throughput of each kernel, 8 B to 64 KiB inputs\n";
+            std::cout << "Options:\n";
+            std::cout << "-b, --bytes  MiB hashed per input size and kernel. Default = 256\n";
+            std::cout << "-h, --help   Print help\n";
+            exit(0);
+        }},
+    });
+
+    var rng = std::mt19937(42);
+    var data = std::vector<uint8_t>(65536 + 8);
+    for (var& byte in data)
+        byte = rng();
+
+    val kernels = std::vector<std::pair<std::string, CrcKernel>>({
+        {"table", CrcKernel::TABLE}, {"slicing", CrcKernel::SLICING}, {"clmul", CrcKernel::CLMUL},
+    });
+    val names = std::vector<std::string>({"table", "slicing", "clmul"});
+
+    std::cout << "dispatched kernel: " << names[int(nexus::modbus::api::crcKernel())] << "\n";
+    std::cout << std::left << std::setw(10) << "bytes";
+    for (val &[name, kernel] in kernels)
+        std::cout << std::setw(22) << name + " ns, GB/s";
+    std::cout << "\n";
+
+    for (var size = size_t(8); size <= 65536; size *= 2) {
+        std::cout << std::left << std::setw(10) << size;
+        for (val &[name, kernel] in kernels) {
+            (void) name;
+            val n = std::max(total / size, size_t(1000));
+            var crc = uint16_t(0);
+
+            val start = std::chrono::steady_clock::now();
+            for (var i = size_t(0); i < n; ++i) {
+                // a buffer that depends on the last crc, so the calls don't overlap
+                crc = nexus::modbus::api::crc(nexus::byte_view{data.data() + (crc & 7), size}, kernel);
+            }
+            val elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+            asm volatile("" :: "r"(crc));
+            var cell = std::ostringstream();
+            cell << std::fixed << std::setprecision(1) << elapsed / n << ", " << std::setprecision(2) << size * n / elapsed;
+            std::cout << std::setw(22) << cell.str();
+        }
+        std::cout << "\n";
+    }
+
+    return 0;
+}
@@ -0,0 +1,179 @@
+#include "nexus/modbus/api.h"
+#include "nexus/tools/options.h"
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <etl/keywords.h>
+
+using Framing = nexus::abstract::Codec::Framing;
+
+/// Frame search over a stream that arrives in chunks, the searched bytes are consumed up to each found frame
+struct Search {
+    virtual ~Search() {}
+
+    /// @return Offset past the frame found in pending, 0 if none
+    virtual size_t find(nexus::byte_view pending) = 0;
+    virtual void consume(size_t) {}
+};
+
+/// Decode every window ending at every new byte, the search for codecs without framing
+struct DecodeWindows : Search {
+    nexus::modbus::api::Codec codec;
+    size_t cursor = 0;
+
+    size_t find(nexus::byte_view pending) override {
+        for (; cursor < pending.len(); ++cursor) {
+            val e = cursor + 1;
+            for (val i in etl::range(e))
+                if (not codec.decode(nexus::byte_view{pending.data() + i, e - i}).empty())
+                    return ++cursor;
+        }
+        return 0;
+    }
+
+    void consume(size_t n) override { cursor = cursor > n ? cursor - n : 0; }
+};
+
+/// frame() from the frame start, then decode(), windows are decoded for unknown function codes
+struct FrameDecode : Search {
+    nexus::modbus::api::Codec codec;
+    DecodeWindows fallback;
+    size_t start = 0;
+
+    size_t find(nexus::byte_view pending) override {
+        while (start < pending.len()) {
+            val res = codec.frame(nexus::byte_view{pending.data() + start, pending.len() - start});
+            if (res.status == Framing::COMPLETE) {
+                if (not codec.decode(nexus::byte_view{pending.data() + start, res.length}).empty())
+                    return start + res.length;
+                start += 1;
+            }
+            elif (res.status == Framing::DISCARD) {
+                start += std::max(res.length, size_t(1));
+            }
+            elif (res.status == Framing::NEED_MORE) {
+                return 0;
+            }
+            else {
+                return fallback.find(pending);
+            }
+        }
+        return 0;
+    }
+
+    void consume(size_t n) override {
+        start = start > n ? start - n : 0;
+        fallback.consume(n);
+    }
+};
+
+struct RollingCrc : Search {
+    nexus::modbus::api::FrameFinder finder;
+
+    size_t find(nexus::byte_view pending) override {
+        val found = finder.find(pending);
+        return found.length > 0 ? found.begin + found.length : 0;
+    }
+
+    void consume(size_t n) override { finder.consume(n); }
+};
+
+/// Feed the stream chunk by chunk
+/// @return frames found and ns per byte
+fun static run(Search& search, const std::vector<uint8_t>& stream, size_t chunk) -> std::pair<size_t, double> {
+    var pending = std::vector<uint8_t>();
+    pending.reserve(4096);
+
+    var frames = size_t(0);
+    val start = std::chrono::steady_clock::now();
+    for (var offset = size_t(0); offset < stream.size(); offset += chunk) {
+        pending.insert(pending.end(), stream.begin() + offset, stream.begin() + std::min(offset + chunk, stream.size()));
+        for (var end = search.find(pending); end > 0; end = search.find(pending)) {
+            ++frames;
+            pending.erase(pending.begin(), pending.begin() + end);
+            search.consume(end);
+        }
+
+        // an endless stream without frames is cut like a full rx buffer
+        if (pending.size() > 256) {
+            val n = pending.size() - 256;
+            pending.erase(pending.begin(), pending.begin() + n);
+            search.consume(n);
+        }
+    }
+    val elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    return {frames, elapsed / stream.size()};
+}
+
+int main(int argc, char* argv[]) {
+    var n_frames = size_t(20000);
+    var chunk = size_t(1);
+    var data_length = size_t(20);
+
+    nexus::tools::execute_options(argc, argv, {
+        {'n', "frames", required_argument, [&] (const char* arg) {
+            n_frames = std::atoi(arg);
+        }},
+        {'c', "chunk", required_argument, [&] (const char* arg) {
+            chunk = std::max(std::atoi(arg), 1);
+        }},
+        {'l', "length", required_argument, [&] (const char* arg) {
+            data_length = std::min(std::atoi(arg), 250);
+        }},
+        {'h', "help", no_argument, [] (const char*) {
+            std::cout << "Modbus RTU frame search over a stream: decoding every window, frame() + decode(), rolling crc\n";
+            std::cout << "Options:\n";
+            std::cout << "-n, --frames  Frames in each stream. Default = 20000\n";
+            std::cout << "-c, --chunk   Bytes per read. Default = 1\n";
+            std::cout << "-l, --length  Data bytes per frame. Default = 20\n";
+            std::cout << "-h, --help    Print help\n";
+            exit(0);
+        }},
+    });
+
+    val codec = nexus::modbus::api::Codec();
+    var rng = std::mt19937(42);
+
+    // read holding registers responses, the same with a vendor function code, and responses with line noise in between
+    val make_stream = [&] (uint8_t fc, size_t noise) {
+        var stream = std::vector<uint8_t>();
+        for (val i in etl::range(n_frames)) {
+            var pdu = std::vector<uint8_t>({0x01, fc, uint8_t(data_length)});
+            for (val j in etl::range(data_length))
+                pdu.push_back(uint8_t(rng() + i + j));
+
+            val frame = codec.encode(pdu).to_vector();
+            stream.insert(stream.end(), frame.begin(), frame.end());
+            for (val j in etl::range(noise)) {
+                (void) j;
+                stream.push_back(uint8_t(rng()));
+            }
+        }
+        return stream;
+    };
+
+    val streams = std::vector<std::pair<std::string, std::vector<uint8_t>>>({
+        {"known fc", make_stream(nexus::modbus::READ_HOLDING_REGISTERS, 0)},
+        {"vendor fc", make_stream(0x41, 0)},
+        {"known fc + noise", make_stream(nexus::modbus::READ_HOLDING_REGISTERS, 3)},
+    });
+
+    std::cout << "frames: " << n_frames << ", frame length: " << data_length + 5 << " bytes, bytes per read: " << chunk << "\n";
+    std::cout << std::left << std::setw(20) << "stream" << std::setw(20) << "search" << std::setw(10) << "frames"
+        << std::setw(12) << "ns/byte" << "ns/frame\n";
+
+    for (val &[name, stream] in streams) {
+        var windows = DecodeWindows();
+        var frame_decode = FrameDecode();
+        var rolling = RollingCrc();
+        for (val &[search_name, search] in std::vector<std::pair<std::string, Search*>>({
+            {"decode windows", &windows}, {"frame + decode", &frame_decode}, {"rolling crc", &rolling}
+        })) {
+            val [frames, ns] = run(*search, stream, chunk);
+            std::cout << std::left << std::setw(20) << name << std::setw(20) << search_name << std::setw(10) << frames
+                << std::setw(12) << std::fixed << std::setprecision(1) << ns << ns * stream.size() / std::max(frames, size_t(1)) << "\n";
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,150 @@
+#include "nexus/loopback/serial.h"
+#include "nexus/modbus/loopback/client.h"
+#include "nexus/modbus/rtu/server.h"
+#include "nexus/tools/options.h"
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <cstdlib>
+#include <new>
+#include <etl/keywords.h>
+
+using namespace std::literals;
+
+/// Heap allocations of the whole process, both ends of the line included
+static std::atomic<size_t> allocations = 0;
+
+void* operator new(size_t size) {
+    ++allocations;
+    if (void* ptr = std::malloc(size))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+
+/// The server's request handler, called directly
+struct Server : nexus::modbus::rtu::Server {
+    using nexus::modbus::rtu::Server::Server;
+    using nexus::modbus::rtu::Server::process_callback;
+};
+
+/// Run a stage n times and print its cost per call
+template <typename F>
+fun static measure(std::string_view stage, size_t n, F&& f) -> double {
+    val allocations_start = allocations.load();
+    val start = std::chrono::steady_clock::now();
+    for (var i = size_t(0); i < n; ++i)
+        f();
+    val elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    val allocs = double(allocations - allocations_start) / n;
+
+    std::cout << std::left << std::setw(28) << stage << std::setw(12) << std::fixed << std::setprecision(1) << elapsed / n
+        << std::setw(14) << size_t(n / (elapsed / 1e9)) << std::setprecision(2) << allocs << "\n";
+    return elapsed / n;
+}
+
+int main(int argc, char* argv[]) {
+    var n = size_t(200000);
+    var n_register = uint16_t(10);
+
+    nexus::tools::execute_options(argc, argv, {
+        {'n', "transactions", required_argument, [&] (const char* arg) {
+            n = std::atoi(arg);
+        }},
+        {'r', "registers", required_argument, [&] (const char* arg) {
+            n_register = std::atoi(arg);
+        }},
+        {'h', "help", no_argument, [] (const char*) {
+            std::cout << "Cost of the modbus stack per transaction over an in-process loopback line, without kernel I/O\n";
+            std::cout << "Options:\n";
+            std::cout << "-n, --transactions  Transactions per stage. Default = 200000\n";
+            std::cout << "-r, --registers     Holding registers read per transaction. Default = 10\n";
+            std::cout << "-h, --help          Print help\n";
+            exit(0);
+        }},
+    });
+
+    val codec = std::make_shared<nexus::modbus::api::Codec>();
+    val [a, b] = nexus::loopback::Serial::pair(codec, 4096, 1s);
+
+    var server = Server(0x01);
+    for (val reg in etl::range<uint16_t>(n_register))
+        server.HoldingRegisterGetter(reg, [reg] { return uint16_t(reg * 3); });
+    var listener = std::thread([&server, b = b] { server.serve(b); });
+
+    var client = nexus::modbus::loopback::Client(0x01, a);
+    if (client.ReadHoldingRegisters(0, n_register).size() != n_register) {
+        std::cerr << "no response\n";
+        return 1;
+    }
+
+    // the stages below run alone, then the server takes the line again
+    server.stop();
+    listener.join();
+
+    uint8_t req[6] = {0x01, nexus::modbus::READ_HOLDING_REGISTERS, 0, 0, uint8_t(n_register >> 8), uint8_t(n_register)};
+    val res = server.process_callback(req);
+    val encoded = codec->encode(res).to_vector();
+    val json = "{\"register_address\": 0, \"n_register\": " + std::to_string(n_register) + "}";
+
+    std::cout << "registers: " << n_register << ", request: 8 bytes, response: " << encoded.size() << " bytes\n";
+    std::cout << std::left << std::setw(28) << "stage" << std::setw(12) << "ns/op" << std::setw(14) << "ops/s" << "allocs/op\n";
+
+    measure("crc (response)", n, [&] {
+        val crc = nexus::modbus::api::crc(nexus::byte_view{encoded.data(), encoded.size() - 2});
+        asm volatile("" :: "r"(crc));
+    });
+    measure("encode (request)", n, [&] {
+        val frame = codec->encode(req);
+        asm volatile("" :: "r"(frame.data()));
+    });
+    measure("frame (response)", n, [&] {
+        val framing = codec->frame(encoded);
+        asm volatile("" :: "r"(framing.length));
+    });
+    measure("decode (response)", n, [&] {
+        val frame = codec->decode(encoded);
+        asm volatile("" :: "r"(frame.data()));
+    });
+    measure("server process_callback", n, [&] {
+        val frame = server.process_callback(req);
+        asm volatile("" :: "r"(frame.data()));
+    });
+    measure("loopback send + receive", n, [&] {
+        a->send(req);
+        val frame = b->receive();
+        asm volatile("" :: "r"(frame.data()));
+    });
+    measure("round trip, one thread", n, [&] {
+        a->send(req);
+        b->send(server.process_callback(b->receive()));
+        val frame = a->receive();
+        asm volatile("" :: "r"(frame.data()));
+    });
+
+    // with the server in its own thread, a round trip hands the cpu over twice when both can't spin on a cpu of their own
+    listener = std::thread([&server, b = b] { server.serve(b); });
+
+    var failed = size_t(0);
+    measure("ReadHoldingRegisters", n, [&] {
+        failed += client.ReadHoldingRegisters(0, n_register).size() != n_register;
+    });
+    var registers = std::vector<uint16_t>(n_register);
+    measure("ReadHoldingRegisters (buf)", n, [&] {
+        failed += client.ReadHoldingRegisters(0, n_register, registers.data()) != n_register;
+    });
+    measure("RESTful read (JSON)", n, [&] {
+        val res = client.post("read_holding_registers", json);
+        asm volatile("" :: "r"(res.data()));
+    });
+
+    server.stop();
+    listener.join();
+
+    if (failed > 0)
+        std::cout << "failed transactions: " << failed << "\n";
+
+    return 0;
+}
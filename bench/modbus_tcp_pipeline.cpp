@@ -0,0 +1,89 @@
+#include "nexus/modbus/tcp/server.h"
+#include "nexus/modbus/tcp/client.h"
+#include "nexus/tools/options.h"
+#include "nexus/tools/await.h"
+#include <iostream>
+#include <iomanip>
+#include <future>
+#include <thread>
+#include <etl/keywords.h>
+
+using namespace std::literals;
+using Protocol = nexus::modbus::tcp::Protocol;
+
+/// Run n transactions and print the cost per transaction
+template <typename F>
+fun static measure(std::string_view stage, size_t n, F&& f) -> void {
+    val start = std::chrono::steady_clock::now();
+    val failed = f();
+    val elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << std::left << std::setw(28) << stage << std::setw(12) << std::fixed << std::setprecision(1) << elapsed / n
+        << std::setw(14) << size_t(n / (elapsed / 1e6)) << failed << "\n";
+}
+
+int main(int argc, char* argv[]) {
+    var n = size_t(20000);
+    var port = 5020;
+
+    nexus::tools::execute_options(argc, argv, {
+        {'n', "transactions", required_argument, [&] (const char* arg) {
+            n = std::atoi(arg);
+        }},
+        {'p', "port", required_argument, [&] (const char* arg) {
+            port = std::atoi(arg);
+        }},
+        {'h', "help", no_argument, [] (const char*) {
+            std::cout << "Modbus TCP transactions over localhost, one at a time and pipelined\n";
+            std::cout << "Options:\n";
+            std::cout << "-n, --transactions  Transactions per stage. Default = 20000\n";
+            std::cout << "-p, --port          Server port. Default = 5020\n";
+            std::cout << "-h, --help          Print help\n";
+            exit(0);
+        }},
+    });
+
+    val host = std::string("127.0.0.1");
+    var server = nexus::modbus::tcp::Server();
+    for (val reg in etl::range<uint16_t>(10))
+        server.HoldingRegisterGetter(reg, [reg] { return uint16_t(reg * 3); });
+    var future = std::async(std::launch::async, [&] { return server.listen(host, port); });
+    std::this_thread::sleep_for(10ms);
+
+    std::cout << std::left << std::setw(28) << "stage" << std::setw(12) << "us/op" << std::setw(14) << "ops/s" << "failed\n";
+
+    // the server serves one connection at a time, each stage has its own
+    {
+        var client = nexus::modbus::tcp::Client(host, port, 1000ms, Protocol::RTU);
+        measure("RTU, one at a time", n, [&] {
+            var failed = size_t(0);
+            for (var i = size_t(0); i < n; ++i)
+                failed += client.ReadHoldingRegisters(0, 10).size() != 10;
+            return failed;
+        });
+    }
+    {
+        var client = nexus::modbus::tcp::Client(host, port, 1000ms, Protocol::MBAP);
+        measure("MBAP, one at a time", n, [&] {
+            var failed = size_t(0);
+            for (var i = size_t(0); i < n; ++i)
+                failed += client.ReadHoldingRegisters(0, 10).size() != 10;
+            return failed;
+        });
+
+        val req = nexus::byte_view({0xFF, nexus::modbus::READ_HOLDING_REGISTERS, 0, 0, 0, 10});
+        val requests = std::vector<nexus::byte_view>(n, nexus::byte_view{req.data(), req.len()});
+        for (val window in {size_t(4), size_t(8)}) {
+            measure("MBAP, pipeline window " + std::to_string(window), n, [&] {
+                var failed = size_t(0);
+                for (val& res in client.pipeline(requests, window))
+                    failed += res.len() != 23;
+                return failed;
+            });
+        }
+    }
+
+    server.stop();
+    nexus::await | future;
+    return 0;
+}
@@ -0,0 +1,125 @@
+#include "nexus/serial/hardware.h"
+#include "nexus/serial/reactor.h"
+#include "nexus/tools/options.h"
+#include <pty.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <iostream>
+#include <iomanip>
+#include <etl/keywords.h>
+
+using namespace std::literals;
+
+struct Usage {
+    long voluntary;
+    long involuntary;
+};
+
+/// Context switches of the whole process so far
+fun static usage() -> Usage {
+    struct rusage usage = {};
+    ::getrusage(RUSAGE_SELF, &usage);
+    return {usage.ru_nvcsw, usage.ru_nivcsw};
+}
+
+struct Result {
+    size_t frames;
+    double voluntary;
+    double involuntary;
+    size_t threads;
+};
+
+/// Run n_ports pty ports for the given duration.
+/// busy ports receive one frame every period, idle ports receive nothing.
+fun static run(std::string_view mode, bool busy, size_t n_ports, size_t n_threads, std::chrono::milliseconds duration) -> Result {
+    var masters = std::vector<int>(n_ports);
+    var slaves = std::vector<int>(n_ports);
+    var ports = std::vector<std::shared_ptr<nexus::serial::Hardware>>();
+    std::atomic<size_t> received = 0;
+
+    val reactor = mode == "reactor" ? std::make_shared<nexus::serial::Reactor>(n_threads) : nullptr;
+
+    for (val i in etl::range(n_ports)) {
+        char name[64] = {};
+        if (::openpty(&masters[i], &slaves[i], name, nullptr, nullptr) < 0)
+            throw std::runtime_error("openpty failed");
+
+        var ser = std::make_shared<nexus::serial::Hardware>(name, B115200, 100ms, nullptr);
+        ser->addCallback([&received] (nexus::byte_view) { ++received; });
+        if (reactor)
+            ser->attach(reactor);
+
+        ports.push_back(std::move(ser));
+    }
+
+    std::this_thread::sleep_for(100ms);
+    val start_usage = usage();
+    val start = std::chrono::steady_clock::now();
+
+    // every busy port gets a frame every 10ms
+    val frame = std::string_view("temperature=25.0 humidity=60.0\n");
+    for (var now = start; now < start + duration; now = std::chrono::steady_clock::now()) {
+        if (busy) for (val master in masters)
+            std::ignore = ::write(master, frame.data(), frame.size());
+
+        std::this_thread::sleep_until(now + 10ms);
+    }
+
+    val elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    val end_usage = usage();
+    val frames = received.load();
+
+    ports.clear();
+    for (val i in etl::range(n_ports)) {
+        ::close(masters[i]);
+        ::close(slaves[i]);
+    }
+
+    return {
+        frames,
+        (end_usage.voluntary - start_usage.voluntary) / elapsed,
+        (end_usage.involuntary - start_usage.involuntary) / elapsed,
+        reactor ? n_threads : n_ports,
+    };
+}
+
+int main(int argc, char* argv[]) {
+    var n_ports = size_t(32);
+    var n_threads = size_t(1);
+    var duration = 2000ms;
+
+    nexus::tools::execute_options(argc, argv, {
+        {'p', "ports", required_argument, [&] (const char* arg) {
+            n_ports = std::atoi(arg);
+        }},
+        {'t', "threads", required_argument, [&] (const char* arg) {
+            n_threads = std::atoi(arg);
+        }},
+        {'d', "duration", required_argument, [&] (const char* arg) {
+            duration = std::chrono::milliseconds(std::atoi(arg));
+        }},
+        {'h', "help", no_argument, [] (const char*) {
+            std::cout << "Serial reactor benchmark over pty pairs\n";
+            std::cout << "Options:\n";
+            std::cout << "-p, --ports     Number of ports. Default = 32\n";
+            std::cout << "-t, --threads   Number of reactor threads. Default = 1\n";
+            std::cout << "-d, --duration  Duration of each run in ms. Default = 2000\n";
+            std::cout << "-h, --help      Print help\n";
+            exit(0);
+        }},
+    });
+
+    std::cout << "ports: " << n_ports << ", reactor threads: " << n_threads << ", busy period: 10ms\n";
+    std::cout << "wakeups/s counts voluntary context switches, csw/s counts all of them\n";
+    std::cout << std::left << std::setw(10) << "mode" << std::setw(8) << "load" << std::setw(10) << "threads"
+        << std::setw(10) << "frames" << std::setw(14) << "wakeups/s" << std::setw(14) << "csw/s" << "\n";
+
+    for (val load in {"idle", "busy"}) for (val mode in {"thread", "reactor"}) {
+        val res = run(mode, load == "busy"sv, n_ports, n_threads, duration);
+        std::cout << std::left << std::setw(10) << mode << std::setw(8) << load << std::setw(10) << res.threads
+            << std::setw(10) << res.frames << std::fixed << std::setprecision(0)
+            << std::setw(14) << res.voluntary << std::setw(14) << res.voluntary + res.involuntary << "\n";
+    }
+
+    return 0;
+}
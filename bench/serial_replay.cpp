@@ -0,0 +1,122 @@
+#include "nexus/serial/replay.h"
+#include "nexus/modbus/api.h"
+#include "nexus/tools/options.h"
+#include <sys/resource.h>
+#include <unistd.h>
+#include <iostream>
+#include <iomanip>
+#include <etl/keywords.h>
+
+using namespace std::literals;
+
+/// CPU time consumed by the whole process
+fun static cpu_time() -> std::chrono::microseconds {
+    struct rusage usage = {};
+    ::getrusage(RUSAGE_SELF, &usage);
+    return std::chrono::seconds(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) +
+        std::chrono::microseconds(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec);
+}
+
+/// Synthetic capture: frames received in chunks of a few frames each, as a busy port reads them
+fun static make_capture(const std::string& path, std::string_view codec_name, size_t n_frames) -> void {
+    var capture = nexus::serial::Capture(path);
+    var chunk = std::vector<uint8_t>();
+    for (val i in etl::range(n_frames)) {
+        if (codec_name == "modbus") {
+            // read holding registers response with 10 registers
+            var pdu = std::vector<uint8_t>({0x01, 0x03, 20});
+            for (val j in etl::range(20))
+                pdu.push_back(uint8_t(i + j));
+
+            val frame = nexus::modbus::api::Codec().encode(pdu);
+            chunk.insert(chunk.end(), frame.begin(), frame.end());
+        } else {
+            val frame = "frame " + std::to_string(i) + " lorem ipsum dolor sit amet\n";
+            chunk.insert(chunk.end(), frame.begin(), frame.end());
+        }
+
+        if (chunk.size() >= 128 or i + 1 == n_frames) {
+            capture.append(nexus::serial::Capture::RX, chunk.data(), chunk.size());
+            chunk.clear();
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    var path = std::string();
+    var codec_name = std::string("newline");
+    var n_frames = size_t(100000);
+    var realtime = false;
+
+    nexus::tools::execute_options(argc, argv, {
+        {'f', "file", required_argument, [&] (const char* arg) {
+            path = arg;
+        }},
+        {'c', "codec", required_argument, [&] (const char* arg) {
+            codec_name = arg;
+        }},
+        {'n', "frames", required_argument, [&] (const char* arg) {
+            n_frames = std::atoi(arg);
+        }},
+        {'t', "realtime", no_argument, [&] (const char*) {
+            realtime = true;
+        }},
+        {'h', "help", no_argument, [] (const char*) {
+            std::cout << "Decode throughput of a replayed serial capture\n";
+            std::cout << "Options:\n";
+            std::cout << "-f, --file      Capture file, e.g. recorded with Hardware::setCapture(). Default = synthetic capture\n";
+            std::cout << "-c, --codec     Codec: newline, modbus. Default = newline\n";
+            std::cout << "-n, --frames    Frames in the synthetic capture. Default = 100000\n";
+            std::cout << "-t, --realtime  Keep the captured timing instead of replaying as fast as possible\n";
+            std::cout << "-h, --help      Print help\n";
+            exit(0);
+        }},
+    });
+
+    var synthetic = path.empty();
+    if (synthetic) {
+        path = "/tmp/bench_serial_replay_" + std::to_string(::getpid()) + ".cap";
+        make_capture(path, codec_name, n_frames);
+    }
+
+    std::shared_ptr<nexus::abstract::Codec> codec;
+    if (codec_name == "modbus")
+        codec = std::make_shared<nexus::modbus::api::Codec>();
+    else
+        codec = std::make_shared<nexus::serial::Hardware::Codec>();
+
+    std::atomic<size_t> frames = 0;
+    std::atomic<int64_t> last = 0;
+    val cpu_start = cpu_time();
+    val start = std::chrono::steady_clock::now();
+
+    var replay = nexus::serial::Replay(path, codec, realtime, 100ms, 4096);
+    replay.setDispatcher(std::make_shared<nexus::serial::Dispatcher>(1, 1024, nexus::serial::Dispatcher::BLOCK));
+    replay.addCallback([&] (nexus::byte_view) {
+        ++frames;
+        last = std::chrono::steady_clock::now().time_since_epoch().count();
+    });
+
+    // every chunk is fed, then the decoded frames trickle out until the count settles
+    replay.wait(24h);
+    for (var count = size_t(-1); count != frames;) {
+        count = frames;
+        std::this_thread::sleep_for(50ms);
+    }
+
+    val end = std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(last.load()));
+    val elapsed = std::chrono::duration<double>(std::max(end, start) - start).count();
+    val cpu = cpu_time() - cpu_start;
+
+    std::cout << "codec: " << codec_name << ", realtime: " << (realtime ? "yes" : "no") << ", capture: " << path << "\n";
+    std::cout << std::left << std::setw(10) << "chunks" << std::setw(12) << "bytes" << std::setw(10) << "frames"
+        << std::setw(12) << "frames/s" << std::setw(10) << "MB/s" << "cpu/frame(us)\n";
+    std::cout << std::left << std::setw(10) << replay.chunks() << std::setw(12) << replay.bytes() << std::setw(10) << frames
+        << std::setw(12) << size_t(frames / std::max(elapsed, 1e-9)) << std::setw(10) << std::fixed << std::setprecision(2)
+        << replay.bytes() / std::max(elapsed, 1e-9) / 1e6 << double(cpu.count()) / std::max(frames.load(), size_t(1)) << "\n";
+
+    if (synthetic)
+        ::unlink(path.c_str());
+
+    return 0;
+}
@@ -0,0 +1,229 @@
+#include "nexus/serial/hardware.h"
+#include "nexus/modbus/api.h"
+#include "nexus/tools/options.h"
+#include <pty.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <future>
+#include <set>
+#include <cstring>
+#include <iostream>
+#include <iomanip>
+#include <etl/keywords.h>
+
+using namespace std::literals;
+
+// heap allocations outside of the bench callback, the default operator delete frees them
+static std::atomic<size_t> allocations = 0;
+static thread_local bool counting = true;
+
+void* operator new(size_t size) {
+    if (counting)
+        ++allocations;
+    if (var ptr = ::malloc(size == 0 ? 1 : size))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+/// CPU time consumed by the whole process
+fun static cpu_time() -> std::chrono::microseconds {
+    struct rusage usage = {};
+    ::getrusage(RUSAGE_SELF, &usage);
+    return std::chrono::seconds(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) + 
+        std::chrono::microseconds(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec);
+}
+
+fun static make_frames(std::string_view codec, size_t n_frames) -> std::vector<std::vector<uint8_t>> {
+    var res = std::vector<std::vector<uint8_t>>();
+    for (val i in etl::range(n_frames)) {
+        if (codec == "modbus") {
+            // read holding registers response with 10 registers
+            var pdu = std::vector<uint8_t>({0x01, 0x03, 20});
+            for (val j in etl::range(20))
+                pdu.push_back(uint8_t(i + j));
+            
+            res.push_back(nexus::modbus::api::Codec().encode(pdu).to_vector());
+        } else {
+            val frame = "frame " + std::to_string(i) + " lorem ipsum dolor sit amet\n";
+            res.emplace_back(frame.begin(), frame.end());
+        }
+    }
+    return res;
+}
+
+/// The RX loop before the streaming engine: one read() per byte, 
+/// then a decode attempt on every suffix of the buffer and a thread per frame callback
+fun static legacy_loop(int fd, const nexus::abstract::Codec& codec, std::function<void(nexus::byte_view)> callback, std::atomic<bool>& isRunning) {
+    uint8_t rxBuffer[256] = {};
+    size_t rxIndex = 0;
+    std::mutex codecMutex;
+
+    while (isRunning) {
+        val n = ::read(fd, rxBuffer + rxIndex, 1);
+        if (n <= 0)
+            continue;
+        
+        var processed = false;
+        for (val i in etl::range(rxIndex + 1)) {
+            codecMutex.lock();
+            var receivedMessage = codec.decode(nexus::byte_view{rxBuffer + i, rxIndex + 1 - i});
+            if (not receivedMessage.empty()) {
+                processed = true;
+                std::ignore = std::async(std::launch::async, [&callback, receivedMessage] { callback(receivedMessage.copy()); });
+            }
+            codecMutex.unlock();
+
+            if (processed)
+                break;
+        }
+
+        rxIndex = processed ? 0 : (rxIndex + 1) % sizeof(rxBuffer);
+    }
+}
+
+struct Result {
+    size_t frames;
+    size_t misframed;
+    size_t allocations;
+    std::chrono::duration<double> elapsed;
+    std::chrono::microseconds cpu;
+};
+
+/// Run an engine. With a gap, the frames are written one by one with that much silence in between,
+/// like on a serial bus, otherwise all at once
+fun static run(std::string_view engine, std::string_view codec_name, size_t n_frames, std::chrono::microseconds gap) -> Result {
+    int master, slave;
+    char name[64] = {};
+    if (::openpty(&master, &slave, name, nullptr, nullptr) < 0)
+        throw std::runtime_error("openpty failed");
+
+    struct termios tty = {};
+    ::tcgetattr(slave, &tty);
+    ::cfmakeraw(&tty);
+    tty.c_cc[VTIME] = 1;
+    tty.c_cc[VMIN] = 0;
+    ::tcsetattr(slave, TCSANOW, &tty);
+
+    std::shared_ptr<nexus::abstract::Codec> codec;
+    if (codec_name == "modbus") 
+        codec = std::make_shared<nexus::modbus::api::Codec>();
+    else 
+        codec = std::make_shared<nexus::serial::Hardware::Codec>();
+
+    val frames = make_frames(codec_name, n_frames);
+    var payloads = std::set<std::vector<uint8_t>>();
+    for (val &frame in frames)
+        payloads.insert(codec->decode(frame).to_vector());
+
+    std::atomic<size_t> received = 0;
+    std::atomic<size_t> misframed = 0;
+    val callback = [&] (nexus::byte_view frame) { 
+        counting = false;
+        if (payloads.count(frame.to_vector()) == 0)
+            ++misframed;
+        counting = true;
+        ++received;
+    };
+
+    std::atomic<bool> isRunning = true;
+    std::unique_ptr<nexus::serial::Hardware> ser;
+    std::thread legacy;
+
+    if (engine == "legacy") {
+        legacy = std::thread(legacy_loop, slave, std::cref(*codec), callback, std::ref(isRunning));
+    } else {
+        ser = std::make_unique<nexus::serial::Hardware>(name, B115200, 100ms, codec);
+        ser->setDispatcher(std::make_shared<nexus::serial::Dispatcher>(1, 64, nexus::serial::Dispatcher::BLOCK));
+        ser->addCallback(callback);
+        if (engine == "silence")
+            ser->setSilenceFraming(true, gap / 2);
+    }
+
+    var stream = std::vector<uint8_t>();
+    for (val &frame in frames)
+        stream.insert(stream.end(), frame.begin(), frame.end());
+
+    std::this_thread::sleep_for(10ms);
+    val cpu_start = cpu_time();
+    val allocations_start = allocations.load();
+    val start = std::chrono::steady_clock::now();
+
+    if (gap.count() > 0) {
+        for (val &frame in frames) {
+            std::ignore = ::write(master, frame.data(), frame.size());
+            std::this_thread::sleep_for(gap);
+        }
+    } else {
+        for (size_t offset = 0; offset < stream.size();) {
+            val n = ::write(master, stream.data() + offset, etl::min(stream.size() - offset, size_t(4096)));
+            if (n < 0)
+                break;
+            offset += n;
+        }
+    }
+
+    val deadline = start + 60s;
+    while (received < n_frames and std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(100us);
+
+    val elapsed = std::chrono::steady_clock::now() - start;
+    val cpu = cpu_time() - cpu_start;
+    val n_allocations = allocations - allocations_start;
+
+    isRunning = false;
+    ser.reset();
+    if (legacy.joinable())
+        legacy.join();
+
+    ::close(master);
+    ::close(slave);
+    return {received, misframed, n_allocations, elapsed, cpu};
+}
+
+int main(int argc, char* argv[]) {
+    var n_frames = size_t(2000);
+    var codec_name = std::string("newline");
+    var gap = std::chrono::microseconds(0);
+
+    nexus::tools::execute_options(argc, argv, {
+        {'n', "frames", required_argument, [&] (const char* arg) { 
+            n_frames = std::atoi(arg); 
+        }},
+        {'c', "codec", required_argument, [&] (const char* arg) { 
+            codec_name = arg; 
+        }},
+        {'g', "gap", required_argument, [&] (const char* arg) { 
+            gap = std::chrono::microseconds(std::atoi(arg)); 
+        }},
+        {'h', "help", no_argument, [] (const char*) {
+            std::cout << "Serial RX engine benchmark over a pty pair\n";
+            std::cout << "Options:\n";
+            std::cout << "-n, --frames  Number of frames to send. Default = 2000\n";
+            std::cout << "-c, --codec   Frame codec: newline, modbus. Default = newline\n";
+            std::cout << "-g, --gap     Silence between frames in us, 0 sends all frames at once. Default = 0\n";
+            std::cout << "-h, --help    Print help\n";
+            exit(0);
+        }},
+    });
+
+    var bytes = size_t(0);
+    for (val &frame in make_frames(codec_name, n_frames))
+        bytes += frame.size();
+
+    std::cout << "codec: " << codec_name << ", frames: " << n_frames << ", bytes: " << bytes << ", gap: " << gap.count() << "us\n";
+    std::cout << std::left << std::setw(12) << "engine" << std::setw(10) << "received" << std::setw(11) << "misframed"
+        << std::setw(14) << "bytes/s" << std::setw(15) << "cpu/frame(us)" << std::setw(14) << "allocs/frame" << "\n";
+
+    for (val engine in {"legacy", "streaming", "silence"}) {
+        if (engine == "silence"sv and gap.count() == 0)
+            continue;
+
+        val res = run(engine, codec_name, n_frames, gap);
+        std::cout << std::left << std::setw(12) << engine << std::setw(10) << res.frames << std::setw(11) << res.misframed
+            << std::setw(14) << size_t(bytes / res.elapsed.count()) 
+            << std::setw(15) << std::fixed << std::setprecision(2) << double(res.cpu.count()) / std::max(res.frames, size_t(1)) 
+            << std::setw(14) << double(res.allocations) / std::max(res.frames, size_t(1)) << "\n";
+    }
+
+    return 0;
+}
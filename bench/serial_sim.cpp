@@ -0,0 +1,166 @@
+#include "nexus/serial/hardware.h"
+#include "nexus/serial/reactor.h"
+#include "nexus/serial/simulator.h"
+#include "nexus/modbus/rtu/simulator.h"
+#include "nexus/modbus/rtu/client.h"
+#include "nexus/tools/histogram.h"
+#include "nexus/tools/options.h"
+#include <sys/resource.h>
+#include <iostream>
+#include <iomanip>
+#include <etl/keywords.h>
+
+using namespace std::literals;
+
+/// CPU time consumed by the whole process
+fun static cpu_time() -> std::chrono::microseconds {
+    struct rusage usage = {};
+    ::getrusage(RUSAGE_SELF, &usage);
+    return std::chrono::seconds(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) +
+        std::chrono::microseconds(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec);
+}
+
+struct Result {
+    size_t frames;
+    size_t timeouts;
+    std::chrono::duration<double> elapsed;
+    std::chrono::microseconds cpu;
+    uint64_t p50;
+    uint64_t p99;
+};
+
+/// Request/response round trips against n_ports simulated devices, one client thread per port
+fun static run(std::string_view codec_name, size_t n_ports, std::chrono::milliseconds duration, std::chrono::microseconds delay, bool use_reactor) -> Result {
+    val reactor = use_reactor ? std::make_shared<nexus::serial::Reactor>() : nullptr;
+    // the port's only codec is the device's, a modbus frame must not look like a newline frame
+    val codec = codec_name == "modbus" 
+        ? std::shared_ptr<nexus::abstract::Codec>(std::make_shared<nexus::modbus::api::Codec>()) 
+        : std::make_shared<nexus::serial::Hardware::Codec>();
+    var devices = std::vector<std::unique_ptr<nexus::serial::Simulator>>();
+    var ports = std::vector<std::shared_ptr<nexus::serial::Hardware>>();
+
+    for (val i in etl::range(n_ports)) {
+        if (codec_name == "modbus") {
+            var slave = std::make_unique<nexus::modbus::rtu::Simulator>(1);
+            for (val reg in etl::range<uint16_t>(10))
+                slave->HoldingRegisterGetter(reg, [reg, i] { return uint16_t(reg + i); });
+            devices.push_back(std::move(slave));
+        } else {
+            devices.push_back(std::make_unique<nexus::serial::Simulator>(codec, nexus::serial::Simulator::echo()));
+        }
+
+        devices.back()->setDelay(delay);
+        var ser = std::make_shared<nexus::serial::Hardware>(devices.back()->port(), B115200, 100ms, codec);
+        if (reactor)
+            ser->attach(reactor);
+        ports.push_back(std::move(ser));
+    }
+
+    var rtt = nexus::tools::Histogram();
+    std::atomic<size_t> frames = 0;
+    std::atomic<size_t> timeouts = 0;
+    std::atomic<bool> isRunning = true;
+
+    val client = [&] (std::shared_ptr<nexus::serial::Hardware> ser) {
+        var modbus = codec_name == "modbus" ? std::make_unique<nexus::modbus::rtu::Client>(1, ser) : nullptr;
+        val request = std::string_view("temperature=25.0 humidity=60.0\n");
+        val all = [] (nexus::byte_view) { return true; };
+
+        while (isRunning) {
+            val start = std::chrono::steady_clock::now();
+            var ok = false;
+            if (modbus) {
+                ok = modbus->ReadHoldingRegisters(0, 10).size() == 10;
+            } else {
+                val after = ser->sequence(codec);
+                ser->sendCodec(codec, request);
+                ok = not ser->receiveMessages(codec, all, 1, after).empty();
+            }
+
+            if (ok) {
+                rtt.record(std::chrono::steady_clock::now() - start);
+                ++frames;
+            } else {
+                ++timeouts;
+            }
+        }
+    };
+
+    std::this_thread::sleep_for(50ms);
+    val cpu_start = cpu_time();
+    val start = std::chrono::steady_clock::now();
+
+    var clients = std::vector<std::thread>();
+    for (val &ser in ports)
+        clients.emplace_back(client, ser);
+
+    std::this_thread::sleep_for(duration);
+    isRunning = false;
+    for (var &thread in clients)
+        thread.join();
+
+    val elapsed = std::chrono::steady_clock::now() - start;
+    val cpu = cpu_time() - cpu_start;
+    return {frames, timeouts, elapsed, cpu, rtt.percentile(50), rtt.percentile(99)};
+}
+
+int main(int argc, char* argv[]) {
+    var max_ports = size_t(64);
+    var duration = std::chrono::milliseconds(1000);
+    var codec_name = std::string("newline");
+    var delay = std::chrono::microseconds(0);
+    var use_reactor = false;
+    var max_cpu = 0.0;
+
+    nexus::tools::execute_options(argc, argv, {
+        {'p', "ports", required_argument, [&] (const char* arg) {
+            max_ports = std::atoi(arg);
+        }},
+        {'d', "duration", required_argument, [&] (const char* arg) {
+            duration = std::chrono::milliseconds(std::atoi(arg));
+        }},
+        {'c', "codec", required_argument, [&] (const char* arg) {
+            codec_name = arg;
+        }},
+        {'w', "delay", required_argument, [&] (const char* arg) {
+            delay = std::chrono::microseconds(std::atoi(arg));
+        }},
+        {'r', "reactor", no_argument, [&] (const char*) {
+            use_reactor = true;
+        }},
+        {'m', "max-cpu", required_argument, [&] (const char* arg) {
+            max_cpu = std::atof(arg);
+        }},
+        {'h', "help", no_argument, [] (const char*) {
+            std::cout << "Serial round trip benchmark against simulated devices on pseudo terminals\n";
+            std::cout << "Options:\n";
+            std::cout << "-p, --ports     Maximum number of ports, doubled from 1. Default = 64\n";
+            std::cout << "-d, --duration  Duration per port count in ms. Default = 1000\n";
+            std::cout << "-c, --codec     Device: newline (echo), modbus (RTU slave). Default = newline\n";
+            std::cout << "-w, --delay     Device reply delay in us. Default = 0\n";
+            std::cout << "-r, --reactor   Poll the ports with a shared reactor\n";
+            std::cout << "-m, --max-cpu   Exit with 1 if a run needs more CPU per frame in us, 0 disables. Default = 0\n";
+            std::cout << "-h, --help      Print help\n";
+            exit(0);
+        }},
+    });
+
+    std::cout << "codec: " << codec_name << ", delay: " << delay.count() << "us, reactor: " << (use_reactor ? "yes" : "no")
+        << ", cpu includes the simulated devices\n";
+    std::cout << std::left << std::setw(8) << "ports" << std::setw(10) << "frames" << std::setw(10) << "timeouts"
+        << std::setw(12) << "frames/s" << std::setw(10) << "p50(us)" << std::setw(10) << "p99(us)" << "cpu/frame(us)\n";
+
+    var failed = false;
+    for (var n = size_t(1); n <= max_ports; n *= 2) {
+        val res = run(codec_name, n, duration, delay, use_reactor);
+        val cpu_per_frame = double(res.cpu.count()) / std::max(res.frames, size_t(1));
+        std::cout << std::left << std::setw(8) << n << std::setw(10) << res.frames << std::setw(10) << res.timeouts
+            << std::setw(12) << size_t(res.frames / res.elapsed.count()) << std::setw(10) << res.p50 << std::setw(10) << res.p99
+            << std::fixed << std::setprecision(2) << cpu_per_frame << "\n";
+
+        if (max_cpu > 0 and cpu_per_frame > max_cpu)
+            failed = true;
+    }
+
+    return failed ? 1 : 0;
+}
@@ -5,6 +5,8 @@
 
 #ifdef __cplusplus
 #include "nexus/tools/byte_view.h"
+#include "nexus/tools/frame_buffer.h"
+#include <memory>
 
 namespace Project::nexus::abstract { 
 
@@ -29,6 +31,54 @@ namespace Project::nexus::abstract {
 
         /// Decode raw buffer.
         virtual nexus::byte_view decode(nexus::byte_view buffer) const { return buffer; };
+
+        /// Room `encodeInto()` needs before and after the raw bytes.
+        virtual size_t headroom() const { return 0; }
+        virtual size_t tailroom() const { return 0; }
+
+        /// Encode the raw bytes of the frame in place.
+        /// Codecs with a header or trailer grow the frame into its headroom and tailroom, the default copies `encode()`.
+        virtual void encodeInto(nexus::tools::FrameBuffer& frame) const;
+
+        /// Decode without copying.
+        /// @return View into buffer, valid as long as buffer is. Empty if the buffer is not a valid frame.
+        virtual nexus::byte_view decodeView(nexus::byte_view buffer) const { return decode(buffer); }
+
+        /// Result of incremental framing.
+        struct Framing {
+            enum Status { UNSUPPORTED, NEED_MORE, COMPLETE, DISCARD };
+            Status status = UNSUPPORTED;
+            size_t length = 0; ///< NEED_MORE: missing bytes, COMPLETE: frame length, DISCARD: leading bytes to drop
+        };
+
+        /// Find the frame at the start of the bytes received so far.
+        /// A COMPLETE frame is then passed to `decode()`.
+        /// Codecs that can't tell frame boundaries return UNSUPPORTED, the caller then tries `decode()` on every window.
+        virtual Framing frame(nexus::byte_view) const { return {}; }
+
+        /// Stateful frame search in the bytes of one stream, for streams that `frame()` can't follow.
+        class Finder {
+        public:
+            virtual ~Finder() {}
+
+            /// Frame found in the pending bytes.
+            struct Found {
+                size_t begin = 0;  ///< offset of the frame
+                size_t length = 0; ///< encoded length, 0 if there is no frame yet
+                nexus::byte_view message; ///< decoded frame, may be a view into the pending bytes
+            };
+
+            /// Find the frame that ends first. Only the bytes appended since the previous call are searched,
+            /// the pending bytes may only grow at the end or lose bytes at the front through `consume()`.
+            virtual Found find(nexus::byte_view pending) = 0;
+
+            /// The first n pending bytes are dropped.
+            virtual void consume(size_t n) = 0;
+        };
+
+        /// New finder for one stream, used instead of `decode()` on every window when `frame()` is UNSUPPORTED.
+        /// nullptr if the codec has none.
+        virtual std::unique_ptr<Finder> finder() const { return nullptr; }
     };
 }
 
@@ -0,0 +1,40 @@
+#ifndef PROJECT_NEXUS_LOOPBACK_CLIENT_H
+#define PROJECT_NEXUS_LOOPBACK_CLIENT_H
+
+#include "nexus/abstract/client.h"
+#include "nexus/loopback/serial.h"
+
+#ifdef __cplusplus
+
+namespace Project::nexus::loopback {
+
+    /// Request/response client over one end of a loopback line, the server answers on the other end.
+    class Client : virtual public abstract::Client {
+    public:
+        explicit Client(std::shared_ptr<Serial> end) : end(std::move(end)) {}
+        virtual ~Client() {}
+
+        std::string path() const override { return "/loopback_client"; }
+
+        void reconnect() override { end->reconnect(); }
+        void disconnect() override { end->disconnect(); }
+        bool isConnected() const override { return end->isConnected(); }
+
+        /// Send the request and wait for the next frame.
+        /// @return Response, or empty on timeout.
+        nexus::byte_view request(nexus::byte_view buffer) override;
+
+        std::shared_ptr<Serial> getSerial() const { return end; }
+
+    protected:
+        std::shared_ptr<Serial> end;
+    };
+}
+
+#else
+typedef void* nexus_loopback_client_t;
+
+/// end: one end made by nexus_loopback_serial_pair, the client takes ownership
+nexus_loopback_client_t nexus_loopback_client_new(nexus_serial_t end);
+#endif
+#endif // PROJECT_NEXUS_LOOPBACK_CLIENT_H
@@ -0,0 +1,84 @@
+#ifndef PROJECT_NEXUS_LOOPBACK_SERIAL_H
+#define PROJECT_NEXUS_LOOPBACK_SERIAL_H
+
+#include "nexus/abstract/serial.h"
+#include "nexus/abstract/codec.h"
+
+#ifdef __cplusplus
+#include <memory>
+#include <atomic>
+#include <chrono>
+#include <utility>
+
+namespace Project::nexus::loopback {
+
+    /// One end of an in-process serial line: what one end sends, the other end receives.
+    /// The bytes go through lock-free ring buffers instead of the kernel and a receiver spins briefly before it sleeps,
+    /// so a request/response round trip makes no syscall. Measures or tests a protocol stack without any I/O.
+    class Serial : virtual public abstract::Serial {
+    public:
+        struct Line;
+
+        /// Create the two connected ends of a line.
+        /// @param codec Encodes what is sent, frames and decodes what is received.
+        /// nullptr for raw bytes, a receive then returns all the bytes received so far.
+        /// @param capacity Ring buffer size of each direction.
+        /// @param timeout Receive timeout, and how long a send waits for room in a full ring buffer.
+        static std::pair<std::shared_ptr<Serial>, std::shared_ptr<Serial>> pair(std::shared_ptr<abstract::Codec> codec = nullptr,
+            size_t capacity = 4096, std::chrono::milliseconds timeout = std::chrono::milliseconds(100));
+
+        Serial(std::shared_ptr<Line> line, int side);
+        virtual ~Serial();
+
+        std::string path() const override { return "/loopback_serial"; }
+
+        /// RESTful GET
+        /// @return Response as json string. Format: {"isConnected": <bool>, "sent": <int>, "received": <int>, "bytesDiscarded": <int>}
+        std::string json() const override;
+
+        /// Connect the line again.
+        void reconnect() override;
+
+        /// Disconnect the line, both ends: sends fail and receives return at once.
+        void disconnect() override;
+        bool isConnected() const override;
+
+        int send(byte_view buffer) override;
+
+        using abstract::Serial::receive;
+
+        /// Next received frame that passes the filter, frames that don't are dropped.
+        /// @return Decoded frame, or empty on timeout or when disconnected.
+        byte_view receive(std::function<bool(byte_view)> filter) override;
+
+        /// Same as above, the frame goes into a buffer of the caller instead of a new one.
+        /// @param until Stop waiting at this time if it comes before the timeout.
+        /// @return False on timeout or when disconnected.
+        bool receive(const std::function<bool(byte_view)>& filter, tools::FrameBuffer& res, 
+            std::chrono::steady_clock::time_point until = std::chrono::steady_clock::time_point::max());
+
+        /// Frames sent and received by this end.
+        size_t sent() const { return sent_; }
+        size_t received() const { return received_; }
+
+    private:
+        byte_view receiveFrame(const std::function<bool(byte_view)>& filter, tools::FrameBuffer* res, std::chrono::steady_clock::time_point until);
+
+        std::shared_ptr<Line> line;
+        int side;
+
+        std::atomic<size_t> sent_ = 0;
+        std::atomic<size_t> received_ = 0;
+        std::atomic<size_t> bytesDiscarded = 0;
+    };
+}
+
+#else
+typedef void* nexus_serial_t;
+typedef void* nexus_codec_t;
+
+/// Create the two ends of a loopback line, delete them with nexus_serial_delete.
+/// codec: encodes and decodes the frames, the ends take ownership. NULL for raw bytes.
+void nexus_loopback_serial_pair(nexus_codec_t codec, size_t capacity, int timeout, nexus_serial_t* a, nexus_serial_t* b);
+#endif
+#endif // PROJECT_NEXUS_LOOPBACK_SERIAL_H
@@ -5,6 +5,7 @@
 #include "nexus/abstract/client.h"
 
 #ifdef __cplusplus
+#include <vector>
 
 namespace Project::nexus::modbus {
     enum Error {
@@ -33,9 +34,75 @@ namespace Project::nexus::modbus::api {
         std::string path() const override { return "/modbus_codec"; }
         nexus::byte_view encode(nexus::byte_view buffer) const override;
         nexus::byte_view decode(nexus::byte_view buffer) const override;
+
+        /// The crc is appended in the tailroom.
+        size_t tailroom() const override { return 2; }
+        void encodeInto(nexus::tools::FrameBuffer& frame) const override;
+
+        /// The frame without its crc, viewing the buffer's bytes.
+        nexus::byte_view decodeView(nexus::byte_view buffer) const override;
+
+        /// Frame length from the function code, trying both the request and the response layout.
+        /// Unknown function codes are UNSUPPORTED.
+        Framing frame(nexus::byte_view buffer) const override;
+
+        /// Rolling crc search, see `FrameFinder`.
+        std::unique_ptr<Finder> finder() const override;
     };
-    
+
+    /// Finds RTU frames in a stream by their crc, keeping the running crc of every candidate frame start:
+    /// a received byte is one table step per live candidate, instead of a crc over every candidate window.
+    /// Candidates with a known function code can only end at the lengths their header allows,
+    /// the others, e.g. vendor specific function codes, anywhere up to the maximum frame length.
+    class FrameFinder : public abstract::Codec::Finder {
+    public:
+        explicit FrameFinder(size_t maxLength = 256) : maxLength(maxLength) {}
+
+        Found find(nexus::byte_view pending) override;
+        void consume(size_t n) override;
+
+        /// Candidate frame starts still searched.
+        size_t live() const { return candidates.size(); }
+
+        /// Frame length including crc, plus the byte count at offset if header > 0,
+        /// where header is the number of bytes needed to read that byte count
+        struct Layout { uint8_t header; uint8_t offset; uint16_t length; };
+
+        /// Layouts of the requests and responses of a function code.
+        /// @return Number of layouts, 0 for unknown function codes.
+        static uint8_t layouts(uint8_t fc, Layout (&res)[2]);
+
+    private:
+
+        struct Candidate {
+            size_t start;
+            uint16_t crc;
+            uint8_t n; ///< number of layouts, UNRESOLVED until the function code is in, 0 for unknown function codes
+            Layout layouts[2];
+        };
+        static constexpr uint8_t UNRESOLVED = 0xFF;
+
+        size_t maxLength;
+        size_t scanned = 0; ///< bytes of the pending bytes already searched
+        std::vector<Candidate> candidates;
+        Found found;
+    };
+
+    /// Crc kernels, from the slowest.
+    enum class CrcKernel {
+        TABLE,   ///< one table lookup per byte
+        SLICING, ///< slicing-by-16 tables, 16 bytes per step
+        CLMUL,   ///< carry-less multiply folding, 64 bytes per step. x86-64 with PCLMULQDQ and SSE4.1
+    };
+
+    /// Modbus crc by the fastest kernel the cpu supports.
     uint16_t crc(nexus::byte_view buffer);
+
+    /// Modbus crc by the given kernel, or by the fastest one if the cpu doesn't support it.
+    uint16_t crc(nexus::byte_view buffer, CrcKernel kernel);
+
+    /// Kernel `crc` uses, picked once at runtime.
+    CrcKernel crcKernel();
 }
 
 #else
@@ -2,14 +2,27 @@
 #define PROJECT_NEXUS_MODBUS_API_CLIENT_H
 
 #include "nexus/modbus/api.h"
+#include "nexus/modbus/read_plan.h"
+#include "nexus/modbus/types.h"
 
 #ifdef __cplusplus
+#include "nexus/serial/dispatcher.h"
+#include "nexus/serial/arbiter.h"
+#include <future>
 
 namespace Project::nexus::modbus::api {
+
+    /// Result of an asynchronous call: the value and the error the blocking call would have left.
+    template <typename T>
+    struct Response {
+        T value;
+        Error error;
+    };
+
     class Client : virtual public abstract::Client {
     public:
         Client(int server_address) : server_address(server_address) {}
-        virtual ~Client() {}
+        virtual ~Client() { stopAsync(); }
 
         std::string json() const override;
         std::string post(std::string_view method_name, std::string_view json_request) override;
@@ -19,6 +32,13 @@ namespace Project::nexus::modbus::api {
         
         std::vector<uint16_t> ReadHoldingRegisters(uint16_t register_address, uint16_t n_register);
         std::vector<uint16_t> ReadInputRegisters(uint16_t register_address, uint16_t n_register);
+
+        /// The registers go into the caller's buffer, without allocating on clients that transact in their own frame buffers.
+        /// Decode them with `modbus::decode`.
+        /// @param res At least n_register registers.
+        /// @return Number of registers read, 0 on error.
+        size_t ReadHoldingRegisters(uint16_t register_address, uint16_t n_register, uint16_t* res);
+        size_t ReadInputRegisters(uint16_t register_address, uint16_t n_register, uint16_t* res);
         
         bool WriteSingleCoil(uint16_t register_address, bool value);
         uint16_t WriteSingleRegister(uint16_t register_address, uint16_t value);
@@ -28,12 +48,92 @@ namespace Project::nexus::modbus::api {
 
         void WriteMultipleCoils(uint16_t register_address, uint16_t n_register, const std::vector<bool>& values);
         void WriteMultipleRegisters(uint16_t register_address, uint16_t n_register, const std::vector<uint16_t>& values);
+
+        /// Runs the merged transactions of the plan one after another, the error is the first one of them.
+        ReadPlan::Result Read(const ReadPlan& plan);
     
         Error error() const { return error_; }
 
+        using Deadline = std::chrono::steady_clock::time_point;
+
+        template <typename T>
+        using Callback = std::function<void(Response<T>)>;
+
+        /// Asynchronous variants of the calls above, they don't touch `error()`.
+        /// A call that isn't answered by its deadline completes with TIMEOUT.
+        /// It goes on the line at the priority of the caller's `serial::Arbiter::Scope`.
+        /// The callback runs on the client's I/O thread, it should hand heavy work on.
+        /// One dropped by a DROP_OLDEST dispatcher runs on the thread queuing the call that pushed it out.
+        /// @return false if the call couldn't be queued, the callback isn't called then.
+        bool ReadCoilsAsync(uint16_t register_address, uint16_t n_register, Deadline deadline, Callback<std::vector<bool>> callback);
+        bool ReadDiscreteInputsAsync(uint16_t register_address, uint16_t n_register, Deadline deadline, Callback<std::vector<bool>> callback);
+        bool ReadHoldingRegistersAsync(uint16_t register_address, uint16_t n_register, Deadline deadline, Callback<std::vector<uint16_t>> callback);
+        bool ReadInputRegistersAsync(uint16_t register_address, uint16_t n_register, Deadline deadline, Callback<std::vector<uint16_t>> callback);
+        bool WriteSingleCoilAsync(uint16_t register_address, bool value, Deadline deadline, Callback<bool> callback);
+        bool WriteSingleRegisterAsync(uint16_t register_address, uint16_t value, Deadline deadline, Callback<uint16_t> callback);
+        bool WriteMultipleCoilsAsync(uint16_t register_address, uint16_t n_register, const std::vector<bool>& values, Deadline deadline, Callback<bool> callback);
+        bool WriteMultipleRegistersAsync(uint16_t register_address, uint16_t n_register, const std::vector<uint16_t>& values, Deadline deadline, Callback<bool> callback);
+        bool ReadExceptionStatusAsync(Deadline deadline, Callback<uint8_t> callback);
+        bool DiagnosticAsync(uint8_t sub_function, Deadline deadline, Callback<std::vector<uint8_t>> callback);
+
+        /// All the transactions of the plan are queued at once, the callback gets the result when the last one is done.
+        bool ReadAsync(const ReadPlan& plan, Deadline deadline, Callback<ReadPlan::Result> callback);
+
+        /// Future forms, a call that couldn't be queued is a TIMEOUT right away.
+        std::future<Response<std::vector<bool>>> ReadCoilsAsync(uint16_t register_address, uint16_t n_register, Deadline deadline);
+        std::future<Response<std::vector<bool>>> ReadDiscreteInputsAsync(uint16_t register_address, uint16_t n_register, Deadline deadline);
+        std::future<Response<std::vector<uint16_t>>> ReadHoldingRegistersAsync(uint16_t register_address, uint16_t n_register, Deadline deadline);
+        std::future<Response<std::vector<uint16_t>>> ReadInputRegistersAsync(uint16_t register_address, uint16_t n_register, Deadline deadline);
+        std::future<Response<bool>> WriteSingleCoilAsync(uint16_t register_address, bool value, Deadline deadline);
+        std::future<Response<uint16_t>> WriteSingleRegisterAsync(uint16_t register_address, uint16_t value, Deadline deadline);
+        std::future<Response<bool>> WriteMultipleCoilsAsync(uint16_t register_address, uint16_t n_register, const std::vector<bool>& values, Deadline deadline);
+        std::future<Response<bool>> WriteMultipleRegistersAsync(uint16_t register_address, uint16_t n_register, const std::vector<uint16_t>& values, Deadline deadline);
+        std::future<Response<uint8_t>> ReadExceptionStatusAsync(Deadline deadline);
+        std::future<Response<std::vector<uint8_t>>> DiagnosticAsync(uint8_t sub_function, Deadline deadline);
+        std::future<Response<ReadPlan::Result>> ReadAsync(const ReadPlan& plan, Deadline deadline);
+
+        /// Run the asynchronous transactions of this client on a shared pool, e.g. one dispatcher for the clients of many lines.
+        /// Without one, the client takes `defaultDispatcher()` at the first asynchronous call.
+        /// Set it before the first asynchronous call. Any overflow policy works, a transaction it drops completes with TIMEOUT.
+        void setDispatcher(std::shared_ptr<serial::Dispatcher> dispatcher) { dispatcher_ = std::move(dispatcher); }
+
     protected:
+        /// One transaction of the methods above, whose response only has to live until the next one.
+        /// Defaults to `request()`, clients with reusable frame buffers answer with a view into them.
+        virtual nexus::byte_view transact(nexus::byte_view buffer) { return request(buffer); }
+
+        /// As `transact()`, giving up at the deadline. Defaults to `transact()`, which waits for the transport's timeout.
+        virtual nexus::byte_view transactUntil(nexus::byte_view buffer, Deadline until) { (void) until; return transact(buffer); }
+
+        size_t read_registers(FunctionCode function_code, uint16_t register_address, uint16_t n_register, uint16_t* res);
+
+        /// One asynchronous transaction, done is called once with the response, or with an empty one after the deadline.
+        /// Defaults to running `transactUntil()` on the dispatcher, one transaction of this client at a time:
+        /// a half-duplex line answers one request at a time anyway, the arbiter orders the clients sharing it.
+        /// @return false if the transaction couldn't be queued.
+        virtual bool transactAsync(std::vector<uint8_t> request, Deadline deadline, std::function<void(nexus::byte_view)> done);
+
+        /// Dispatcher of the asynchronous transactions without one set, by default a single worker of this client.
+        virtual std::shared_ptr<serial::Dispatcher> defaultDispatcher();
+
+        /// Run work on the dispatcher and call done with its response, or with an empty one if the dispatcher drops it.
+        /// @return false if it couldn't be queued, done isn't called then.
+        bool dispatchAsync(std::function<nexus::byte_view()> work, std::function<void(nexus::byte_view)> done);
+
+        /// Complete the queued asynchronous transactions with TIMEOUT and wait for the running one.
+        /// Called by the destructors of the clients, before their transport goes.
+        void stopAsync();
+
         int server_address;
         Error error_ = Error::NONE;
+        std::mutex transactMutex; ///< one transaction in the frame buffers at a time, blocking or asynchronous
+
+    private:
+        std::shared_ptr<serial::Dispatcher> dispatcher_;
+        std::mutex asyncMutex;
+        std::condition_variable asyncIdle;
+        size_t asyncPending = 0;
+        std::atomic<bool> asyncStopped = false;
     };
 }
 
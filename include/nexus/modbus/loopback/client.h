@@ -0,0 +1,42 @@
+#ifndef PROJECT_NEXUS_MODBUS_LOOPBACK_CLIENT_H
+#define PROJECT_NEXUS_MODBUS_LOOPBACK_CLIENT_H
+
+#include "nexus/modbus/api_client.h"
+#include "nexus/loopback/client.h"
+
+#ifdef __cplusplus
+
+namespace Project::nexus::modbus::loopback {
+
+    /// Modbus client over one end of a loopback line, e.g. with a `modbus::rtu::Server` serving the other end.
+    /// Make the line with `api::Codec` for RTU framing and CRC.
+    class Client : public modbus::api::Client {
+    public:
+        Client(int server_address, std::shared_ptr<nexus::loopback::Serial> end) : modbus::api::Client(server_address), cli(std::move(end)) {}
+        virtual ~Client() { stopAsync(); }
+
+        std::string path() const override { return "/modbus_loopback_client"; }
+
+        void reconnect() override { cli.reconnect(); }
+        void disconnect() override { cli.disconnect(); }
+        bool isConnected() const override { return cli.isConnected(); }
+
+        nexus::byte_view request(nexus::byte_view buffer) override;
+
+    protected:
+        /// The response is received into the rx buffer.
+        nexus::byte_view transact(nexus::byte_view buffer) override;
+        nexus::byte_view transactUntil(nexus::byte_view buffer, Deadline until) override;
+
+        nexus::loopback::Client cli;
+        nexus::tools::FrameBuffer rx;
+    };
+}
+
+#else
+typedef void* nexus_modbus_loopback_client_t;
+
+/// end: one end made by nexus_loopback_serial_pair with the modbus codec, the client takes ownership
+nexus_modbus_loopback_client_t nexus_modbus_loopback_client_new(int server_address, nexus_serial_t end);
+#endif
+#endif // PROJECT_NEXUS_MODBUS_LOOPBACK_CLIENT_H
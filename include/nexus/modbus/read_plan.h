@@ -0,0 +1,72 @@
+#ifndef PROJECT_NEXUS_MODBUS_READ_PLAN_H
+#define PROJECT_NEXUS_MODBUS_READ_PLAN_H
+
+#include "nexus/modbus/api.h"
+
+#ifdef __cplusplus
+#include <vector>
+
+namespace Project::nexus::modbus::api {
+
+    /// Register ranges a poll needs, read in as few transactions as the protocol allows.
+    /// Ranges of the same table are merged when the registers between them are at most `gap`,
+    /// up to 125 registers or 2000 coils per transaction. The registers in the gaps are read too,
+    /// so the gap should only span registers the device answers for.
+    class ReadPlan {
+    public:
+        explicit ReadPlan(uint16_t gap = 0) : gap(gap) {}
+
+        ReadPlan& Coils(uint16_t register_address, uint16_t n_register) { return add(READ_COILS, register_address, n_register); }
+        ReadPlan& DiscreteInputs(uint16_t register_address, uint16_t n_register) { return add(READ_DISCRETE_INPUTS, register_address, n_register); }
+        ReadPlan& HoldingRegisters(uint16_t register_address, uint16_t n_register) { return add(READ_HOLDING_REGISTERS, register_address, n_register); }
+        ReadPlan& InputRegisters(uint16_t register_address, uint16_t n_register) { return add(READ_INPUT_REGISTERS, register_address, n_register); }
+
+        /// One read request.
+        struct Transaction {
+            FunctionCode function_code;
+            uint16_t register_address;
+            uint16_t n_register;
+        };
+
+        /// The merged reads, by function code and register address.
+        const std::vector<Transaction>& transactions() const { return transactions_; }
+
+        /// Values read by the transactions of a plan.
+        class Result {
+        public:
+            /// Values of the range, empty if any of it wasn't read.
+            std::vector<bool> Coils(uint16_t register_address, uint16_t n_register) const;
+            std::vector<bool> DiscreteInputs(uint16_t register_address, uint16_t n_register) const;
+            std::vector<uint16_t> HoldingRegisters(uint16_t register_address, uint16_t n_register) const;
+            std::vector<uint16_t> InputRegisters(uint16_t register_address, uint16_t n_register) const;
+
+            /// The first error of the transactions, NONE if all of them succeeded.
+            Error error() const { return error_; }
+
+            /// Values of a transaction of the plan, in the order of `transactions()`.
+            void set(const Transaction& transaction, std::vector<uint16_t> values, Error err);
+
+        private:
+            struct Read {
+                Transaction transaction;
+                std::vector<uint16_t> values; ///< coils and discrete inputs as 0 or 1, empty on error
+            };
+
+            std::vector<uint16_t> values(FunctionCode function_code, uint16_t register_address, uint16_t n_register) const;
+
+            std::vector<Read> reads;
+            Error error_ = Error::NONE;
+        };
+
+    private:
+        ReadPlan& add(FunctionCode function_code, uint16_t register_address, uint16_t n_register);
+        void plan();
+
+        uint16_t gap;
+        std::vector<Transaction> ranges;
+        std::vector<Transaction> transactions_;
+    };
+}
+
+#endif
+#endif // PROJECT_NEXUS_MODBUS_READ_PLAN_H
@@ -0,0 +1,256 @@
+#ifndef PROJECT_NEXUS_MODBUS_REGISTER_MAP_H
+#define PROJECT_NEXUS_MODBUS_REGISTER_MAP_H
+
+#include "nexus/modbus/api_client.h"
+
+#ifdef __cplusplus
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace Project::nexus::modbus {
+
+    /// One value of a device: where its registers are, how they decode and how it shows in json.
+    struct Field {
+        /// BOOL is true for any nonzero register, FLAG only for 0xFFFF, the "on" of e.g. alarm registers.
+        enum Type { U16, I16, U32, I32, F32, F64, BOOL, FLAG };
+
+        const char* name;           ///< json key
+        FunctionCode function_code; ///< READ_HOLDING_REGISTERS or READ_INPUT_REGISTERS
+        uint16_t register_address;
+        Type type = U16;
+        double scale = 1.;
+        int precision = 1;          ///< decimals in json and text, BOOL and FLAG show as true or false
+        const char* unit = "";      ///< shown by `text()`, the json has the bare number
+        double fallback = NAN;      ///< value when the registers couldn't be read, NaN shows as "NaN"
+        double invalid = NAN;       ///< decoded value the device sends for no value, e.g. 0xFFFF as U16 or -1 as I16. NaN for none
+        WordOrder word_order = WordOrder::BIG;
+        ByteOrder byte_order = ByteOrder::BIG;
+
+        constexpr size_t registers() const { return type == F64 ? 4 : type == U32 or type == I32 or type == F32 ? 2 : 1; }
+    };
+
+    /// Registers of a device declared once as constexpr fields, e.g.
+    /// `static constexpr modbus::Field fields[] = {{"voltage", READ_INPUT_REGISTERS, 0x0000, Field::U16, .1}, ...};`
+    /// The read plan, the register of each field and the decoding of each field are worked out at compile time:
+    /// an update is one read per merged block into a fixed register array and a straight-line decode of every field.
+    /// @tparam Fields The fields, a constexpr array with static storage.
+    /// @tparam Gap Unused registers a block may span to merge two fields, they have to be readable.
+    template <const auto& Fields, uint16_t Gap = 0>
+    class RegisterMap {
+    public:
+        static constexpr size_t N = std::size(Fields);
+
+        /// A read request covering one or more fields.
+        struct Block {
+            FunctionCode function_code;
+            uint16_t register_address;
+            uint16_t n_register;
+            uint16_t offset; ///< of its registers in the register array
+        };
+
+        struct Plan {
+            std::array<Block, N> blocks;
+            size_t n_blocks;
+            size_t n_registers;
+            std::array<size_t, N> block;    ///< of each field
+            std::array<size_t, N> register_; ///< of each field in the register array
+        };
+
+        /// The fields by function code and address, merged into blocks of at most 125 registers.
+        static constexpr Plan plan = [] {
+            Plan res = {};
+            std::array<size_t, N> order = {};
+            for (size_t i = 0; i < N; ++i)
+                order[i] = i;
+
+            // insertion sort, constexpr
+            auto before = [] (const Field& a, const Field& b) {
+                return a.function_code != b.function_code ? a.function_code < b.function_code : a.register_address < b.register_address;
+            };
+            for (size_t i = 1; i < N; ++i)
+                for (size_t j = i; j > 0 and before(Fields[order[j]], Fields[order[j - 1]]); --j) {
+                    auto tmp = order[j];
+                    order[j] = order[j - 1];
+                    order[j - 1] = tmp;
+                }
+
+            for (size_t k = 0; k < N; ++k) {
+                const auto& field = Fields[order[k]];
+                const auto begin = size_t(field.register_address);
+                const auto end = begin + field.registers();
+
+                if (res.n_blocks > 0) {
+                    auto& last = res.blocks[res.n_blocks - 1];
+                    const auto last_end = size_t(last.register_address) + last.n_register;
+                    if (last.function_code == field.function_code and begin <= last_end + Gap and end - last.register_address <= 125) {
+                        if (end > last_end) {
+                            res.n_registers += end - last_end;
+                            last.n_register = uint16_t(end - last.register_address);
+                        }
+                        res.block[order[k]] = res.n_blocks - 1;
+                        res.register_[order[k]] = last.offset + (begin - last.register_address);
+                        continue;
+                    }
+                }
+
+                res.blocks[res.n_blocks] = {field.function_code, field.register_address, uint16_t(end - begin), uint16_t(res.n_registers)};
+                res.block[order[k]] = res.n_blocks;
+                res.register_[order[k]] = res.n_registers;
+                res.n_registers += end - begin;
+                ++res.n_blocks;
+            }
+            return res;
+        }();
+
+        /// Read every block and decode every field. No heap allocation on clients with their own frame buffers.
+        /// @return True if all of the blocks were read.
+        bool update(api::Client& cli) {
+            auto res = true;
+            for (size_t i = 0; i < plan.n_blocks; ++i) {
+                const auto& b = plan.blocks[i];
+                const auto dest = registers.data() + b.offset;
+                const auto n = b.function_code == READ_INPUT_REGISTERS
+                    ? cli.ReadInputRegisters(b.register_address, b.n_register, dest)
+                    : cli.ReadHoldingRegisters(b.register_address, b.n_register, dest);
+                read[i] = n == b.n_register;
+                res = res and read[i];
+            }
+            decodeFields(std::make_index_sequence<N>());
+            return res;
+        }
+
+        /// Value of a field by its index in the fields.
+        double operator[](size_t i) const { return values[i]; }
+
+        /// Value of a field by its json key, NaN if there is no such field.
+        double get(std::string_view name) const {
+            for (size_t i = 0; i < N; ++i)
+                if (name == Fields[i].name)
+                    return values[i];
+            return NAN;
+        }
+
+        /// Set the value of a field by its json key, e.g. after a write, until the next update reads it.
+        /// @return false if there is no such field.
+        bool set(std::string_view name, double value) {
+            for (size_t i = 0; i < N; ++i)
+                if (name == Fields[i].name) {
+                    values[i] = value;
+                    return true;
+                }
+            return false;
+        }
+
+        /// The fields as a json object, formatted into one buffer.
+        std::string json() const {
+            auto res = std::string();
+            res.reserve(json_size);
+            res += '{';
+            for (size_t i = 0; i < N; ++i) {
+                const auto& field = Fields[i];
+                if (i > 0)
+                    res += ", ";
+                res += '"';
+                res += field.name;
+                res += "\": ";
+                if (field.type != Field::BOOL and field.type != Field::FLAG and std::isnan(values[i]))
+                    res += "\"NaN\"";
+                else
+                    appendValue(res, i);
+            }
+            res += '}';
+            return res;
+        }
+
+        /// The fields with their units for logs, e.g. `distance = 12.3 cm, temperature = 21.5 C`.
+        std::string text() const {
+            auto res = std::string();
+            res.reserve(json_size);
+            for (size_t i = 0; i < N; ++i) {
+                const auto& field = Fields[i];
+                if (i > 0)
+                    res += ", ";
+                res += field.name;
+                res += " = ";
+                appendValue(res, i);
+                if (field.unit[0] != '\0') {
+                    res += ' ';
+                    res += field.unit;
+                }
+            }
+            return res;
+        }
+
+    private:
+        void appendValue(std::string& res, size_t i) const {
+            const auto& field = Fields[i];
+            if (field.type == Field::BOOL or field.type == Field::FLAG) {
+                res += values[i] == 1. ? "true" : "false";
+                return;
+            }
+            if (std::isnan(values[i])) {
+                res += "NaN";
+                return;
+            }
+            char number[32];
+            res.append(number, std::min(sizeof(number) - 1, size_t(::snprintf(number, sizeof(number), "%.*f", field.precision, values[i]))));
+        }
+
+        /// Keys, separators and numbers of typical width
+        static constexpr size_t json_size = [] {
+            size_t res = 2;
+            for (size_t i = 0; i < N; ++i)
+                res += std::char_traits<char>::length(Fields[i].name) + 6 + 12;
+            return res;
+        }();
+
+        template <size_t... I>
+        void decodeFields(std::index_sequence<I...>) {
+            ((values[I] = decodeField<I>()), ...);
+        }
+
+        template <size_t I>
+        double decodeField() const {
+            constexpr Field field = Fields[I];
+            static_assert(field.function_code == READ_HOLDING_REGISTERS or field.function_code == READ_INPUT_REGISTERS, "fields are registers");
+            if (not read[plan.block[I]])
+                return field.fallback;
+
+            const auto r = registers.data() + plan.register_[I];
+            constexpr auto W = field.word_order;
+            constexpr auto B = field.byte_order;
+            double raw;
+            if constexpr (field.type == Field::I16) raw = modbus::decode<int16_t, W, B>(r);
+            else if constexpr (field.type == Field::U32) raw = modbus::decode<uint32_t, W, B>(r);
+            else if constexpr (field.type == Field::I32) raw = modbus::decode<int32_t, W, B>(r);
+            else if constexpr (field.type == Field::F32) raw = modbus::decode<float, W, B>(r);
+            else if constexpr (field.type == Field::F64) raw = modbus::decode<double, W, B>(r);
+            else raw = modbus::decode<uint16_t, W, B>(r);
+
+            if (raw == field.invalid)
+                return field.fallback;
+            if constexpr (field.type == Field::BOOL)
+                return raw != 0 ? 1. : 0.;
+            if constexpr (field.type == Field::FLAG)
+                return raw == 0xFFFF ? 1. : 0.;
+            return raw * field.scale;
+        }
+
+        std::array<uint16_t, plan.n_registers> registers = {};
+        std::array<bool, N> read = {};
+        std::array<double, N> values = [] {
+            std::array<double, N> res = {};
+            for (size_t i = 0; i < N; ++i)
+                res[i] = Fields[i].fallback;
+            return res;
+        }();
+    };
+}
+
+#endif
+#endif // PROJECT_NEXUS_MODBUS_REGISTER_MAP_H
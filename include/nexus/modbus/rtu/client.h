@@ -8,6 +8,8 @@
 
 namespace Project::nexus::modbus::rtu {
 
+    /// Modbus RTU client. The request/response transactions go through the line's `serial::Arbiter`,
+    /// one with a t3.5 gap is set up for the line if it has none.
     class Client : public modbus::api::Client, public serial::Hardware::Interface {
     public:
         struct Args { 
@@ -26,11 +28,23 @@ namespace Project::nexus::modbus::rtu {
 
         std::string path() const override { return "/modbus_rtu_client"; }
 
+        /// RESTful GET
+        /// @return Response as json string. Format: {<api::Client json>, "arbiter": <serial::Arbiter json or null>}
+        std::string json() const override;
+
         void reconnect() override { ser_->reconnect(); }
         void disconnect() override { ser_->disconnect();  }
         bool isConnected() const override { return ser_->isConnected(); }
 
         nexus::byte_view request(nexus::byte_view buffer) override;
+
+    protected:
+        /// The arbiter's turn, at the priority of the current scope, and the response are waited for until the deadline at most.
+        nexus::byte_view transactUntil(nexus::byte_view buffer, Deadline until) override;
+
+        /// The line's dispatcher: one worker for the clients of the line and its frame callbacks,
+        /// whose arbiter runs one transaction at a time anyway.
+        std::shared_ptr<serial::Dispatcher> defaultDispatcher() override { return ser_->getDispatcher(); }
     };
 }
 
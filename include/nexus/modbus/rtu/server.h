@@ -18,6 +18,11 @@ namespace Project::nexus::modbus::rtu {
         bool listen(std::string port, speed_t speed, std::chrono::milliseconds timeout = std::chrono::milliseconds(100));
         bool listen(std::shared_ptr<serial::Hardware> ser);
 
+        /// Serve the requests received by any serial, e.g. one end of a `loopback::Serial` line.
+        /// The requests are polled with `receive()`, the serial's timeout bounds how long `stop()` takes.
+        /// A name of its own, an overload of `listen` would be ambiguous for the subclasses of `serial::Hardware`.
+        bool serve(std::shared_ptr<abstract::Serial> ser);
+
         void stop();
         bool isRunning() const override { return is_running; }
 
@@ -29,7 +34,7 @@ namespace Project::nexus::modbus::rtu {
     private:
         std::mutex mtx;
         std::condition_variable cv;
-        bool is_running = false;
+        std::atomic<bool> is_running = false;
     };
 }
 
@@ -0,0 +1,34 @@
+#ifndef PROJECT_NEXUS_MODBUS_RTU_SIMULATOR_H
+#define PROJECT_NEXUS_MODBUS_RTU_SIMULATOR_H
+
+#include "nexus/modbus/api_server.h"
+#include "nexus/serial/simulator.h"
+
+#ifdef __cplusplus
+
+namespace Project::nexus::modbus::rtu {
+
+    /// Modbus RTU slave on a simulated serial port, answering with the registered getters and setters.
+    /// Register them before the first request arrives.
+    class Simulator : public api::Server, public serial::Simulator {
+    public:
+        explicit Simulator(int server_address);
+        virtual ~Simulator();
+
+        std::string path() const override { return "/modbus_rtu_simulator"; }
+
+        /// @return Json string. Format: <Server json> merged with <Simulator json>
+        std::string json() const override;
+
+        bool isRunning() const override { return not port().empty(); }
+    };
+}
+
+#else
+typedef void* nexus_modbus_rtu_simulator_t;
+
+nexus_modbus_rtu_simulator_t nexus_modbus_rtu_simulator_new(int server_address);
+const char* nexus_modbus_rtu_simulator_port(nexus_modbus_rtu_simulator_t sim);
+
+#endif
+#endif // PROJECT_NEXUS_MODBUS_RTU_SIMULATOR_H
@@ -5,22 +5,32 @@
 #include "nexus/tcp/client.h"
 
 #ifdef __cplusplus
+#include <unordered_map>
 
 namespace Project::nexus::modbus::tcp {
 
+    /// Framing of the transactions on the connection.
+    enum class Protocol {
+        RTU,  ///< RTU frames with crc over TCP, one transaction at a time
+        MBAP, ///< Modbus TCP: MBAP header with transaction id and unit id, transactions can be pipelined
+    };
+
     class Client : public modbus::api::Client {
     public:
         struct Args {
-            std::string host; 
+            std::string host;
             int port;
             std::chrono::milliseconds timeout = std::chrono::milliseconds(1000);
+            Protocol protocol = Protocol::RTU;
+            int server_address = 0xFF; ///< unit id for MBAP
         };
 
-        Client(Args args) : modbus::api::Client(0xFF), cli(args.host, args.port, args.timeout) {}
-        Client(std::string host, int port, std::chrono::milliseconds timeout = std::chrono::milliseconds(1000)) 
-            : Client(Args{host, port, timeout}) {}
-        
-        virtual ~Client() {}
+        Client(Args args)
+            : modbus::api::Client(args.server_address), cli(args.host, args.port, args.timeout), protocol_(args.protocol), timeout(args.timeout) {}
+        Client(std::string host, int port, std::chrono::milliseconds timeout = std::chrono::milliseconds(1000), Protocol protocol = Protocol::RTU)
+            : Client(Args{host, port, timeout, protocol}) {}
+
+        virtual ~Client();
 
         std::string path() const override { return "/modbus_tcp_client"; };
 
@@ -32,8 +42,64 @@ namespace Project::nexus::modbus::tcp {
 
         nexus::byte_view request(nexus::byte_view buffer) override;
 
+        /// Pipelined transactions: with MBAP, up to window requests are in flight on the connection
+        /// and the responses are matched by transaction id in whatever order they come. RTU runs them one after another.
+        /// @param requests Requests as for `request()`: server address, function code, data.
+        /// Once asynchronous calls are in use, the requests go through the reader thread with them.
+        /// @return Responses in the order of the requests, empty for the ones that timed out.
+        std::vector<nexus::byte_view> pipeline(const std::vector<nexus::byte_view>& requests, size_t window = 16);
+
+        Protocol protocol() const { return protocol_; }
+
     protected:
+        /// Encodes, sends, receives and decodes in the client's frame buffers, the response views the rx buffer.
+        nexus::byte_view transact(nexus::byte_view buffer) override;
+
+        /// As `transact()`, waiting for the response until the deadline at most.
+        nexus::byte_view transactUntil(nexus::byte_view buffer, Deadline until) override;
+
+        /// With MBAP the request is sent right away and the reader thread, started by the first one,
+        /// matches the responses by transaction id: any number of transactions are in flight on the connection.
+        /// The callbacks run on the dispatcher, not on the reader.
+        bool transactAsync(std::vector<uint8_t> request, Deadline deadline, std::function<void(nexus::byte_view)> done) override;
+
+        /// Next MBAP response in the rx stream, its unit id and pdu viewing the rx buffer until the next call.
+        /// @return Transaction id and response, empty on timeout.
+        std::pair<uint16_t, nexus::byte_view> receiveMbap(std::chrono::steady_clock::time_point deadline);
+
         nexus::tcp::Client cli;
+        Protocol protocol_;
+        std::chrono::milliseconds timeout;
+        modbus::api::Codec codec;
+        nexus::tools::FrameBuffer tx;
+        nexus::tools::FrameBuffer rx;
+        uint16_t transaction = 0;
+        size_t received = 0; ///< rx bytes of the last MBAP response, dropped at the next receive
+
+    private:
+        /// A blocking MBAP transaction while the reader owns the rx buffer, the response is a copy.
+        /// The reader completes it with an empty response at the deadline.
+        std::future<nexus::byte_view> submit(nexus::byte_view buffer, Deadline deadline);
+
+        /// Send an MBAP request and register it with the reader, which calls done.
+        bool sendMbap(std::vector<uint8_t> request, Deadline deadline, std::function<void(nexus::byte_view)> done);
+
+        void readerWork();
+
+        /// Call the completion of a transaction in flight, if it still is.
+        void complete(uint16_t id, nexus::byte_view res);
+
+        struct InFlight {
+            Deadline deadline;
+            std::function<void(nexus::byte_view)> done;
+        };
+
+        std::mutex txMutex; ///< tx, the transaction id and the start of the reader
+        std::mutex inFlightMutex;
+        std::condition_variable inFlightAdded;
+        std::unordered_map<uint16_t, InFlight> inFlight;
+        std::thread reader;
+        bool closing = false;
     };
 }
 
@@ -42,5 +108,8 @@ typedef void* nexus_modbus_tcp_client_t;
 
 nexus_modbus_tcp_client_t nexus_modbus_tcp_client_new(const char* host, int port);
 
+/// Modbus TCP client with MBAP framing.
+nexus_modbus_tcp_client_t nexus_modbus_tcp_client_new_mbap(const char* host, int port, int unit_id, int timeout);
+
 #endif
 #endif // PROJECT_NEXUS_MODBUS_RTU_CLIENT_H
\ No newline at end of file
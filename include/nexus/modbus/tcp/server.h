@@ -8,6 +8,8 @@
 
 namespace Project::nexus::modbus::tcp {
 
+    /// Modbus server over TCP. Serves RTU frames with crc and MBAP framed Modbus TCP on the same port,
+    /// pipelined MBAP requests that arrive together are answered together.
     class Server : virtual public api::Server, virtual public nexus::tcp::Server {
     public:
         Server();
@@ -19,6 +21,9 @@ namespace Project::nexus::modbus::tcp {
 
     protected:
         using nexus::tcp::Server::addCallback;
+
+        /// Responses to the MBAP frames in the buffer, up to the first one that is not.
+        std::vector<uint8_t> process_mbap(nexus::byte_view buffer) const;
     };
 }
 
@@ -0,0 +1,77 @@
+#ifndef PROJECT_NEXUS_MODBUS_TYPES_H
+#define PROJECT_NEXUS_MODBUS_TYPES_H
+
+#ifdef __cplusplus
+#include <cstdint>
+#include <cstring>
+#include <cstddef>
+#include <type_traits>
+
+namespace Project::nexus::modbus {
+
+    /// Order of the registers of a value wider than one register.
+    enum class WordOrder {
+        BIG,    ///< most significant register first, e.g. ABCD
+        LITTLE, ///< least significant register first, e.g. CDAB
+    };
+
+    /// Order of the two bytes in a register.
+    enum class ByteOrder {
+        BIG,    ///< as the protocol sends them, e.g. ABCD
+        LITTLE, ///< swapped, e.g. BADC
+    };
+
+    /// Number of registers a value takes.
+    template <typename T>
+    constexpr size_t registers_of = sizeof(T) / 2;
+
+    /// Value of T from its registers, e.g. a float32 from two registers.
+    /// The orders are template arguments, each combination compiles to its own shifts without branches.
+    template <typename T, WordOrder W = WordOrder::BIG, ByteOrder B = ByteOrder::BIG>
+    T decode(const uint16_t* registers) {
+        static_assert(std::is_trivially_copyable_v<T> and sizeof(T) % 2 == 0 and sizeof(T) <= 8, "T takes 1, 2 or 4 registers");
+        using U = std::conditional_t<sizeof(T) == 8, uint64_t, std::conditional_t<sizeof(T) == 4, uint32_t, uint16_t>>;
+        constexpr size_t n = registers_of<T>;
+
+        U bits = 0;
+        for (size_t i = 0; i < n; ++i) {
+            uint16_t word = registers[W == WordOrder::BIG ? i : n - 1 - i];
+            if constexpr (B == ByteOrder::LITTLE)
+                word = uint16_t(word << 8 | word >> 8);
+            if constexpr (n > 1)
+                bits = U(bits << 16);
+            bits |= word;
+        }
+
+        T res;
+        ::memcpy(&res, &bits, sizeof(T));
+        return res;
+    }
+
+    /// Values of T from consecutive registers, registers_of<T> each.
+    template <typename T, WordOrder W = WordOrder::BIG, ByteOrder B = ByteOrder::BIG>
+    void decode(const uint16_t* registers, T* values, size_t n) {
+        for (size_t i = 0; i < n; ++i)
+            values[i] = decode<T, W, B>(registers + i * registers_of<T>);
+    }
+
+    /// Registers of a value, the inverse of `decode`.
+    template <typename T, WordOrder W = WordOrder::BIG, ByteOrder B = ByteOrder::BIG>
+    void encode(T value, uint16_t* registers) {
+        static_assert(std::is_trivially_copyable_v<T> and sizeof(T) % 2 == 0 and sizeof(T) <= 8, "T takes 1, 2 or 4 registers");
+        using U = std::conditional_t<sizeof(T) == 8, uint64_t, std::conditional_t<sizeof(T) == 4, uint32_t, uint16_t>>;
+        constexpr size_t n = registers_of<T>;
+
+        U bits;
+        ::memcpy(&bits, &value, sizeof(T));
+        for (size_t i = 0; i < n; ++i) {
+            uint16_t word = uint16_t(bits >> (16 * (n - 1 - i)));
+            if constexpr (B == ByteOrder::LITTLE)
+                word = uint16_t(word << 8 | word >> 8);
+            registers[W == WordOrder::BIG ? i : n - 1 - i] = word;
+        }
+    }
+}
+
+#endif
+#endif // PROJECT_NEXUS_MODBUS_TYPES_H
@@ -0,0 +1,114 @@
+#ifndef PROJECT_NEXUS_SERIAL_ARBITER_H
+#define PROJECT_NEXUS_SERIAL_ARBITER_H
+
+#ifdef __cplusplus
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <string>
+#include <set>
+#include <utility>
+#include "nexus/tools/histogram.h"
+
+namespace Project::nexus::serial {
+
+    /// Bus arbiter of a half-duplex line, e.g. RS-485, shared by the clients of the line.
+    /// Runs one request/response transaction at a time: higher priority first, in arrival order within a priority,
+    /// and never sooner than the inter-frame gap after the previous transaction.
+    class Arbiter {
+    public:
+        enum Priority : int { LOW = -1, NORMAL = 0, HIGH = 1 };
+
+        /// Exclusive use of the line, released on destruction. An empty slot holds nothing.
+        class Slot {
+        public:
+            Slot() = default;
+            Slot(Slot&& other) noexcept : arbiter(std::exchange(other.arbiter, nullptr)) {}
+            Slot& operator=(Slot&& other) noexcept;
+            ~Slot();
+
+            /// Whether the slot holds the line.
+            explicit operator bool() const { return arbiter != nullptr; }
+
+        private:
+            friend class Arbiter;
+            explicit Slot(Arbiter* arbiter) : arbiter(arbiter) {}
+            Arbiter* arbiter = nullptr;
+        };
+
+        /// Priority of the transactions the current thread starts within the scope, e.g. the writes of an HTTP request.
+        class Scope {
+        public:
+            explicit Scope(int priority);
+            Scope(const Scope&) = delete;
+            Scope& operator=(const Scope&) = delete;
+            ~Scope();
+
+            /// Priority of the current thread, NORMAL outside of any scope.
+            /// Work handed to another thread takes it along, e.g. an asynchronous transaction.
+            static int priority();
+
+        private:
+            int previous;
+        };
+
+        /// @param [in] gap Minimum silence between two transactions, e.g. `Hardware::t35()` of the line.
+        explicit Arbiter(std::chrono::microseconds gap);
+
+        /// Disabled copy constructor to prevent unintended object copies.
+        Arbiter(const Arbiter&) = delete;
+
+        /// Disabled copy assignment operator to prevent unintended object assignments.
+        Arbiter& operator=(const Arbiter&) = delete;
+
+        virtual ~Arbiter() {}
+
+        /// Wait for the line. The arbiter must outlive the slot.
+        /// @param [in] priority Transaction priority, higher runs first.
+        Slot acquire(int priority);
+
+        /// Wait for the line until the deadline at most.
+        /// @return The slot, or an empty one if the turn hasn't come by then.
+        Slot acquire(int priority, std::chrono::steady_clock::time_point until);
+
+        /// Wait for the line with the priority of the current `Scope`, NORMAL outside of any scope.
+        Slot acquire();
+
+        /// Number of transactions waiting for the line.
+        size_t queued() const;
+
+        /// Bus statistics
+        /// @return Json string. Format: {"gapUs": <int>, "transactions": <int>, "queued": <int>, "busyUs": <int>,
+        /// "utilization": <float>, "queueWaitUs": <Histogram json>}
+        std::string json() const;
+
+    private:
+        void release();
+
+        std::chrono::microseconds gap;
+        std::chrono::steady_clock::time_point created = std::chrono::steady_clock::now();
+
+        mutable std::mutex mtx;
+        std::condition_variable cv;
+        std::set<std::pair<int, uint64_t>> waiting; ///< (-priority, ticket), the first one goes next
+        uint64_t tickets = 0;
+        bool busy = false;
+        std::chrono::steady_clock::time_point lastRelease = {};
+
+        // statistics, protected by mtx
+        size_t transactions = 0;
+        std::chrono::steady_clock::time_point busySince = {};
+        std::chrono::microseconds busyTotal = {};
+
+        tools::Histogram queueWait;
+    };
+}
+
+#else
+typedef void* nexus_serial_arbiter_t;
+
+nexus_serial_arbiter_t nexus_serial_arbiter_new(int gap_us);
+void nexus_serial_arbiter_delete(nexus_serial_arbiter_t arbiter);
+
+#endif
+#endif
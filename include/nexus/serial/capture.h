@@ -0,0 +1,104 @@
+#ifndef PROJECT_NEXUS_SERIAL_CAPTURE_H
+#define PROJECT_NEXUS_SERIAL_CAPTURE_H
+
+#ifdef __cplusplus
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <cstdint>
+
+namespace Project::nexus::serial {
+
+    /// Append-only capture of the raw byte stream of a port, memory mapped.
+    /// File format: "NXCAP\x01\0\0", the uint64 size of the recorded part, then the chunks,
+    /// each an int64 time in nanoseconds since the capture started, a uint32 length, a uint8 direction and the bytes.
+    /// Little endian, unaligned. The recorded size is updated after every chunk, a capture cut short stays readable.
+    class Capture {
+    public:
+        enum Direction : uint8_t { RX = 0, TX = 1 };
+
+        /// Create or truncate the capture file.
+        /// @param [in] path File path.
+        /// @param [in] capacity Initial size of the mapping, doubled whenever it is full.
+        explicit Capture(std::string path, size_t capacity = 1 << 20);
+
+        /// Disabled copy constructor to prevent unintended object copies.
+        Capture(const Capture&) = delete;
+
+        /// Disabled copy assignment operator to prevent unintended object assignments.
+        Capture& operator=(const Capture&) = delete;
+
+        /// Unmap and truncate the file to the recorded size.
+        virtual ~Capture();
+
+        /// False if the file can't be created or mapped, nothing is recorded then.
+        bool isOpen() const { return map != nullptr; }
+
+        /// Record a chunk, timestamped now.
+        void append(Direction direction, const uint8_t* data, size_t length);
+
+        size_t chunks() const { return chunks_; }
+        size_t bytes() const { return bytes_; }
+
+        /// Capture statistics
+        /// @return Json string. Format: {"path": <string>, "chunks": <int>, "bytes": <int>, "size": <int>}
+        std::string json() const;
+
+        /// Chunks of a capture file, read from a read only mapping without copying.
+        class Reader {
+        public:
+            struct Chunk {
+                std::chrono::nanoseconds time; ///< since the capture started
+                Direction direction;
+                const uint8_t* data; ///< valid while the reader lives
+                size_t length;
+            };
+
+            explicit Reader(const std::string& path);
+            Reader(const Reader&) = delete;
+            Reader& operator=(const Reader&) = delete;
+            ~Reader();
+
+            /// False if the file is missing or not a capture.
+            bool isOpen() const { return map != nullptr; }
+
+            /// Next chunk.
+            /// @return false at the end of the capture.
+            bool next(Chunk& chunk);
+
+            /// Start over from the first chunk.
+            void rewind();
+
+        private:
+            const uint8_t* map = nullptr;
+            size_t size = 0;   ///< mapped size
+            size_t end = 0;    ///< end of the recorded part
+            size_t offset = 0;
+        };
+
+    private:
+        bool grow(size_t size);
+
+        std::string path;
+        int fd = -1;
+        uint8_t* map = nullptr;
+        size_t capacity;
+
+        mutable std::mutex mtx;
+        size_t used = 0; ///< header and chunks, protected by mtx
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+        std::atomic<size_t> chunks_ = 0;
+        std::atomic<size_t> bytes_ = 0;
+    };
+}
+
+#else
+typedef void* nexus_serial_capture_t;
+
+nexus_serial_capture_t nexus_serial_capture_new(const char* path);
+void nexus_serial_capture_delete(nexus_serial_capture_t capture);
+
+#endif
+#endif
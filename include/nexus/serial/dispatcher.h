@@ -0,0 +1,106 @@
+#ifndef PROJECT_NEXUS_SERIAL_DISPATCHER_H
+#define PROJECT_NEXUS_SERIAL_DISPATCHER_H
+
+#ifdef __cplusplus
+#include <functional>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <chrono>
+#include <string>
+#include <memory>
+#include "nexus/tools/byte_view.h"
+
+namespace Project::nexus::serial {
+
+    /// Bounded task queue served by a fixed pool of worker threads.
+    /// Used to run frame callbacks outside of the rx path.
+    class Dispatcher {
+    public:
+        using Task = std::function<void()>;
+
+        /// Task that runs for many frames. Posting a frame to it doesn't allocate.
+        using FrameTask = std::function<void(byte_view)>;
+
+        /// What to do when a task is posted to a full queue.
+        /// A worker never waits for room in its own queue, BLOCK drops what it posts to a full one.
+        enum Overflow { DROP_OLDEST, BLOCK, DROP_NEWEST };
+
+        /// Start the worker threads.
+        /// @param [in] n_workers Number of worker threads. With one worker, tasks run in the order they are posted.
+        /// @param [in] capacity Maximum number of queued tasks.
+        /// @param [in] overflow Overflow policy.
+        explicit Dispatcher(size_t n_workers = 1, size_t capacity = 64, Overflow overflow = BLOCK);
+
+        /// Disabled copy constructor to prevent unintended object copies.
+        Dispatcher(const Dispatcher&) = delete;
+
+        /// Disabled copy assignment operator to prevent unintended object assignments.
+        Dispatcher& operator=(const Dispatcher&) = delete;
+
+        /// Run the queued tasks, then join the worker threads.
+        virtual ~Dispatcher();
+
+        /// Queue a task. An exception it throws is counted as a failure and dropped.
+        /// @return false if the task is dropped.
+        bool dispatch(Task task);
+
+        /// Queue a frame for a frame task.
+        /// @return false if the frame is dropped.
+        bool dispatch(std::shared_ptr<const FrameTask> task, byte_view frame);
+
+        /// Number of queued tasks.
+        size_t depth() const;
+
+        /// Queue statistics
+        /// @return Json string. Format: {"workers": <int>, "capacity": <int>, "depth": <int>, "maxDepth": <int>,
+        /// "dispatched": <int>, "dropped": <int>, "failed": <int>, "latencyAvgUs": <int>, "latencyMaxUs": <int>}
+        std::string json() const;
+
+    private:
+        void work();
+        bool onWorker() const;
+
+        struct Item {
+            Task task;
+            std::shared_ptr<const FrameTask> frameTask;
+            byte_view frame;
+            std::chrono::steady_clock::time_point enqueued;
+        };
+
+        bool push(Item item);
+
+        size_t capacity;
+        Overflow overflow;
+
+        // queued items live in a ring of preallocated slots
+        mutable std::mutex mtx;
+        std::condition_variable cvPush;
+        std::condition_variable cvPop;
+        std::vector<Item> queue;
+        size_t head = 0; ///< slot of the oldest item
+        size_t count = 0;
+        bool isRunning = true;
+        std::vector<std::thread> workers;
+
+        // statistics, protected by mtx
+        size_t maxDepth = 0;
+        size_t dispatched = 0;
+        size_t dropped = 0;
+        size_t failed = 0; ///< tasks that threw
+        std::chrono::microseconds latencyTotal = {};
+        std::chrono::microseconds latencyMax = {};
+    };
+}
+
+#else
+typedef void* nexus_serial_dispatcher_t;
+
+/// overflow: 0 = drop oldest, 1 = block, 2 = drop newest
+nexus_serial_dispatcher_t nexus_serial_dispatcher_new(size_t n_workers, size_t capacity, int overflow);
+void nexus_serial_dispatcher_delete(nexus_serial_dispatcher_t dispatcher);
+
+#endif
+#endif
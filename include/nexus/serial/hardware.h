@@ -3,7 +3,16 @@
 
 #include "nexus/abstract/serial.h"
 #include "nexus/abstract/codec.h"
+#include "nexus/tools/ring_buffer.h"
+#include "nexus/tools/frame_buffer.h"
+#include "nexus/serial/dispatcher.h"
+#include "nexus/serial/arbiter.h"
+#include "nexus/serial/capture.h"
+#include "nexus/tools/frame_pool.h"
+#include "nexus/tools/histogram.h"
+#include "nexus/tools/baud_rate.h"
 #include <termios.h>
+#include <sys/uio.h>
 
 #ifdef __cplusplus
 #include <thread>
@@ -11,15 +20,21 @@
 #include <atomic>
 #include <condition_variable>
 #include <list>
+#include <array>
+#include <deque>
+#include <vector>
 #include <unordered_map>
 #include <memory>
+#include <future>
 
 namespace Project::nexus::serial {
+    class Reactor;
+    class Hotplug;
 
     class Hardware : public abstract::Serial {
     public:
         using Callback = std::function<void(byte_view)>;
-        using CallbackList = std::list<std::function<void(byte_view)>>;
+        using CallbackList = std::list<std::shared_ptr<const Callback>>;
         using CallbackId = CallbackList::iterator;
 
         using CodecList = std::unordered_map<std::shared_ptr<abstract::Codec>, CallbackList>;
@@ -27,9 +42,27 @@ namespace Project::nexus::serial {
 
         using ReceiveFilter = std::function<bool(byte_view)>;
 
-        Hardware(std::string port, speed_t speed, std::chrono::milliseconds timeout, std::shared_ptr<abstract::Codec> codec);
+        /// Decoded frame, queued per codec.
+        struct Message {
+            uint64_t seq; ///< per codec sequence number, starting from 1
+            std::chrono::steady_clock::time_point firstByte; ///< time the first byte of the frame was received
+            std::chrono::steady_clock::time_point timestamp; ///< time the frame was complete
+            byte_view data; ///< shared with the callbacks and the other receivers of the frame
+        };
+
+        /// @param speed termios constant, e.g. B115200, or any baud rate, e.g. 250000. Rates without a constant are set with termios2.
+        Hardware(std::string port, speed_t speed, std::chrono::milliseconds timeout, std::shared_ptr<abstract::Codec> codec, size_t rxBufferSize = 256);
         virtual ~Hardware();
 
+        /// RESTful GET
+        /// @return Response as json string. Format: {"isConnected": <bool>, "baudRate": <int>, "rxBufferSize": <int>, "bytesReceived": <int>, 
+        /// "framesDecoded": <int>, "bytesDiscarded": <int>, "overflows": <int>, "messagesDropped": <int>, "silenceUs": <int>, 
+        /// "dispatcher": <Dispatcher json>, "framePool": <FramePool json>, "tx": {"depth": <int>, "frames": <int>, "writes": <int>, 
+        /// "bytes": <int>, "queueDelayAvgUs": <int>, "queueDelayMaxUs": <int>, "wireAvgUs": <int>, "wireMaxUs": <int>}, 
+        /// "responseLatencyUs": <Histogram json>, "interByteGapUs": <Histogram json>,
+        /// "arbiter": <Arbiter json or null>, "capture": <Capture json or null>}
+        std::string json() const override;
+
         void reconnect() override;
         void disconnect() override;
         bool isConnected() const override;
@@ -39,45 +72,216 @@ namespace Project::nexus::serial {
         byte_view receive(std::function<bool(byte_view)> filter) override;
         
         int sendCodec(std::shared_ptr<abstract::Codec> codec, byte_view buffer);
+
+        /// Completion of an asynchronous send: number of bytes written, or -1.
+        using SendCallback = std::function<void(int)>;
+
+        /// Encode and queue a frame for the writer thread, which writes the queued frames together with writev.
+        /// Blocks only while the tx queue is full.
+        /// @param callback Called on the writer thread once the frame is written, nullptr to fire and forget.
+        /// @return false if the port is not connected, the callback is not called then.
+        bool sendAsync(std::shared_ptr<abstract::Codec> codec, byte_view buffer, SendCallback callback);
+
+        /// Encode and queue a frame for the writer thread.
+        /// @return Number of bytes written, or -1.
+        std::future<int> sendAsync(std::shared_ptr<abstract::Codec> codec, byte_view buffer);
+
+        /// Maximum number of frames waiting for the writer thread.
+        void setTxQueueCapacity(size_t capacity);
+
+        /// Time the last write to the port finished, by sendCodec or the writer thread.
+        std::chrono::steady_clock::time_point lastSent() const;
         byte_view receiveCodec(std::shared_ptr<abstract::Codec> codec, std::function<bool(byte_view)> filter);
 
+        /// Take queued frames of the codec that pass the filter, oldest first, 
+        /// waiting up to `timeout` for the first one. Frames that don't pass stay queued.
+        /// @param max Maximum number of frames to take.
+        /// @param after Only take frames with a greater sequence number, e.g. `sequence()` before sending a request.
+        /// @param until Stop waiting at this time if it comes before the timeout.
+        std::vector<Message> receiveMessages(std::shared_ptr<abstract::Codec> codec, std::function<bool(byte_view)> filter, 
+            size_t max = SIZE_MAX, uint64_t after = 0, std::chrono::steady_clock::time_point until = std::chrono::steady_clock::time_point::max());
+
+        /// Sequence number of the latest frame decoded by the codec, 0 if none.
+        uint64_t sequence(std::shared_ptr<abstract::Codec> codec) const;
+
+        /// Maximum number of queued frames per codec. The oldest frame is dropped when a codec's queue is full.
+        void setMessageQueueCapacity(size_t capacity);
+
+        /// Register a codec. Registering the same codec again only counts another registration.
+        /// The rx thread picks up the new handler table on its next pass, decoding is never stalled.
         CodecId addCodec(std::shared_ptr<abstract::Codec> codec);
+
+        /// Drop one registration of a codec, its handler is removed with the last one. The default codec stays.
         void removeCodec(CodecId codec);
 
         CallbackId addCallback(Callback callback);
         void removeCallback(CallbackId callback);
 
-        std::string port; 
-        speed_t speed;
-        std::chrono::milliseconds timeout; 
+        /// Let a shared reactor poll this port instead of the dedicated worker thread.
+        /// @param reactor The reactor, or nullptr to go back to the dedicated worker thread.
+        void attach(std::shared_ptr<Reactor> reactor);
+
+        /// Go back to the dedicated worker thread.
+        void detach();
+
+        /// Let a hotplug manager keep this port connected: a disconnected port is reopened on the manager's thread
+        /// with exponential backoff, and `reconnect()` only schedules an attempt instead of blocking the caller.
+        /// @param hotplug The manager, or nullptr to reconnect only on request again.
+        void setHotplug(std::shared_ptr<Hotplug> hotplug);
+
+        /// Run the frame callbacks on another dispatcher, e.g. one shared by several ports.
+        /// By default each port has its own dispatcher with one worker and a BLOCK queue of 64 frames:
+        /// the rx thread waits for room rather than losing a frame. A DROP policy sheds frames under load instead.
+        void setDispatcher(std::shared_ptr<Dispatcher> dispatcher);
+        std::shared_ptr<Dispatcher> getDispatcher() const;
+
+        /// Serialise the request/response transactions of the clients sharing this line, see `Arbiter`.
+        /// @param arbiter The line's arbiter, or nullptr to let the clients talk over each other again.
+        void setArbiter(std::shared_ptr<Arbiter> arbiter);
+        std::shared_ptr<Arbiter> getArbiter() const;
+
+        /// Record every chunk read from and written to the port, see `Capture` and `Replay`.
+        /// @param capture The capture, or nullptr to stop recording.
+        void setCapture(std::shared_ptr<Capture> capture);
+        std::shared_ptr<Capture> getCapture() const;
+
+        /// Frame on line silence, as Modbus RTU does: the received bytes are decoded once, as one frame,
+        /// after the line has been silent for the gap.
+        /// @param enable Enable or disable silence framing.
+        /// @param gap Silence that ends a frame. Zero means t3.5 at `speed`.
+        void setSilenceFraming(bool enable, std::chrono::microseconds gap = {});
+
+        /// Modbus RTU t3.5: 3.5 characters of 11 bits, fixed to 1750us above 19200 baud.
+        static std::chrono::microseconds t35(speed_t speed);
+
+        /// Time `bytes` take on the wire at `speed`, 10 bits per byte.
+        static std::chrono::nanoseconds wireTime(speed_t speed, size_t bytes);
+
+        /// Change the baud rate, the port is reopened if it is connected.
+        void setBaudRate(int baud);
+
+        /// Baud rate of `speed`.
+        int baudRate() const { return tools::baud_rate(speed); }
+
+        /// Change the device path, it's opened on the next connect.
+        void setPort(std::string port);
+
+        /// Device path, e.g. /dev/ttyUSB0, or the one picked for "auto" once connected.
+        std::string getPort() const;
+
+        std::atomic<speed_t> speed; ///< termios constant or baud rate, read by the tx thread while it may change
+        std::atomic<std::chrono::milliseconds> timeout; ///< response timeout, counted from the time the request has left the wire
 
     protected:
-        
-        // file descriptor
-        int fd = -1;
+        std::string port; ///< guarded by connectMutex, connect() may pick it for "auto"
+
+        /// For subclasses that bring their own device: adopt an open descriptor, e.g. one end of a socket pair,
+        /// instead of opening the port. Such a subclass overrides `reconnect()`.
+        /// @param dev Open descriptor, or -1 to stay disconnected until `adopt()`.
+        Hardware(int dev, std::string port, speed_t speed, std::chrono::milliseconds timeout, std::shared_ptr<abstract::Codec> codec, size_t rxBufferSize);
+
+        /// Publish an open descriptor as the port's and wake up the reader. The port must be disconnected.
+        void adopt(int dev);
+
+        // file descriptor, -1 while disconnected
+        std::atomic<int> fd = -1;
 
         // tx and rx buffer
-        uint8_t rxBuffer[256] = {};
+        tools::RingBuffer rxBuffer;
+        tools::FrameBuffer txFrame; ///< `sendCodec()` encodes in place, guarded by txMutex
         std::mutex txMutex;
         std::mutex rxMutex;
 
+        // rx statistics
+        std::atomic<size_t> bytesReceived = 0;
+        std::atomic<size_t> framesDecoded = 0;
+        std::atomic<size_t> bytesDiscarded = 0; ///< garbage before a frame or dropped on overflow
+        std::atomic<size_t> overflows = 0;
+        std::atomic<size_t> messagesDropped = 0; ///< queued frames that were never received
+
+        // timing statistics in microseconds
+        tools::Histogram responseLatency; ///< write finished until the next frame is complete
+        tools::Histogram interByteGap;    ///< between two reads while a frame is pending in rxBuffer
+        std::atomic<int64_t> lastTx = 0;  ///< steady clock nanoseconds when the last write finished
+        std::atomic<int64_t> txDrained = 0; ///< steady clock nanoseconds when the last written byte is off the wire
+        std::atomic<bool> awaitingResponse = false;
+        void sent(size_t bytes);
+        void frameComplete();
+
+        // bounded FIFO of decoded frames in preallocated slots
+        struct MessageQueue {
+            std::vector<Message> slots;
+            size_t head = 0; ///< slot of the oldest frame
+            size_t count = 0;
+
+            /// Queue a frame, dropping the oldest one if there are already `capacity` frames.
+            /// @return false if a frame was dropped.
+            bool push(Message message, size_t capacity);
+
+            /// Move up to `max` frames that match out, oldest first. The other frames stay queued in order.
+            void take(std::vector<Message>& res, size_t max, const std::function<bool(const Message&)>& match);
+        };
+
         // received message
         struct MessageHandler {
-            explicit MessageHandler(std::shared_ptr<abstract::Codec> codec) : codec(codec) {}
+            explicit MessageHandler(std::shared_ptr<abstract::Codec> codec) : codec(codec), finder(codec->finder()) {
+                runCallbacks = [this] (byte_view frame) {
+                    // no lock while they run, a callback may add or remove callbacks, the next frame sees the change
+                    const auto snapshot = std::atomic_load(&callbackSnapshot);
+                    for (const auto& callback : *snapshot)
+                        (*callback)(frame);
+                };
+            }
+
             std::shared_ptr<abstract::Codec> codec;
-            std::vector<uint8_t> message;
-            CallbackList callbacks;
+            std::unique_ptr<abstract::Codec::Finder> finder; ///< searches instead of decoding every window when framing is UNSUPPORTED
+            size_t registrations = 1; ///< protected by codecMutex
+            size_t cursor = 0; ///< first cursor bytes of rxBuffer have been searched for frames by this codec
+
+            // incremental framing state
+            abstract::Codec::Framing::Status framing = abstract::Codec::Framing::NEED_MORE;
+            size_t start = 0; ///< the next frame of this codec starts here
+            size_t end = 0;   ///< NEED_MORE: frame again when rxBuffer has this many bytes, COMPLETE: frame end
+            byte_view frame;  ///< COMPLETE: decoded frame
+            MessageQueue messages; ///< protected by mtx
+            uint64_t seq = 0;
+            CallbackList callbacks; ///< protected by callbackMutex
+
+            // copy-on-write snapshot of the callbacks, published under callbackMutex
+            using CallbackSnapshot = std::vector<std::shared_ptr<const Callback>>;
+            std::shared_ptr<const CallbackSnapshot> callbackSnapshot = std::make_shared<const CallbackSnapshot>();
+            void publishCallbacks() { std::atomic_store(&callbackSnapshot, std::make_shared<const CallbackSnapshot>(callbacks.begin(), callbacks.end())); }
+
+            std::mutex callbackMutex;
+            Dispatcher::FrameTask runCallbacks; ///< posted to the dispatcher for every frame
             std::mutex mtx;
             std::condition_variable cv;
         };
 
         template <typename T>
-        auto makeMessageHandler() { return std::make_unique<MessageHandler>(std::make_shared<T>()); }
+        auto makeMessageHandler() { return std::make_shared<MessageHandler>(std::make_shared<T>()); }
 
-        auto makeMessageHandler(std::shared_ptr<abstract::Codec> codec) { return std::make_unique<MessageHandler>(codec); }
+        auto makeMessageHandler(std::shared_ptr<abstract::Codec> codec) { return std::make_shared<MessageHandler>(codec); }
 
-        std::list<std::unique_ptr<MessageHandler>> messageHandlers;
+        // copy-on-write handler table, the first handler is the default codec.
+        // Readers load a snapshot without locking, writers replace the whole table under codecMutex
+        using HandlerTable = std::vector<std::shared_ptr<MessageHandler>>;
+        std::shared_ptr<const HandlerTable> messageHandlers;
+        std::atomic<uint64_t> handlersVersion = 0;
         std::mutex codecMutex;
+        std::shared_ptr<const HandlerTable> loadHandlers() const { return std::atomic_load(&messageHandlers); }
+        void storeHandlers(HandlerTable table);
+        std::shared_ptr<MessageHandler> findMessageHandler(CodecId codec) const;
+
+        std::atomic<size_t> messageQueueCapacity = 16;
+
+        // frame callbacks are queued here, never run on the rx path. Accessed with std::atomic_load and std::atomic_store
+        std::shared_ptr<Dispatcher> dispatcher;
+        std::shared_ptr<Arbiter> arbiter; ///< accessed with std::atomic_load and std::atomic_store
+        std::shared_ptr<Capture> capture; ///< accessed with std::atomic_load and std::atomic_store
+
+        // decoded frames are copied once into pooled blocks shared by the callbacks and receivers
+        std::shared_ptr<tools::FramePool> framePool;
 
     private:
         // worker thread
@@ -85,6 +289,79 @@ namespace Project::nexus::serial {
         std::thread worker;
         void work();
 
+        // shared reactor, if attached
+        friend class Reactor;
+        std::shared_ptr<Reactor> reactor;
+        std::atomic<bool> isAttached = false;
+
+        // connection, opened without holding the tx and rx locks so senders and receivers fail fast meanwhile,
+        // closed with both held so the old number isn't read or written once it is reused
+        friend class Hotplug;
+        std::shared_ptr<Hotplug> hotplug; ///< accessed with std::atomic_load and std::atomic_store
+        mutable std::mutex connectMutex;  ///< serialises connect(), guards `port`
+        std::mutex idleMutex;
+        std::condition_variable idleCv;   ///< the worker thread waits here while disconnected
+        bool connect();
+
+        /// Close the descriptor with rxMutex held by the caller, txMutex is taken too. The hotplug manager isn't woken.
+        /// @return false if it was closed already.
+        bool disconnectRx();
+
+        // rx pipeline
+        std::shared_ptr<const HandlerTable> rxHandlers; ///< snapshot used by the rx path, reloaded when handlersVersion changes
+        uint64_t rxHandlersVersion = 0;
+        const HandlerTable& rxTable();
+        ssize_t process();
+        ssize_t tryRead();
+        void decodeFrames();
+        std::pair<size_t, size_t> tryDecode();
+        void deliver(const std::shared_ptr<MessageHandler>& handler, byte_view receivedMessage, size_t begin);
+        void consume(size_t n);
+
+        // arrival time of the recent reads by stream offset, to timestamp the first byte of a frame
+        struct RxChunk {
+            uint64_t end; ///< stream offset after the read
+            std::chrono::steady_clock::time_point time;
+        };
+        std::array<RxChunk, 32> rxChunks = {};
+        uint64_t rxChunkCount = 0;
+        uint64_t rxConsumed = 0; ///< stream offset of the first byte of rxBuffer
+        std::chrono::steady_clock::time_point arrival(size_t offset) const;
+
+        // asynchronous tx, the writer thread starts with the first queued frame
+        struct TxFrame {
+            byte_view data;
+            std::chrono::steady_clock::time_point enqueued;
+            SendCallback callback;
+        };
+
+        mutable std::mutex txQueueMutex;
+        std::condition_variable txPush;
+        std::condition_variable txPop;
+        std::deque<TxFrame> txQueue;
+        size_t txQueueCapacity = 64;
+        bool txRunning = false;
+        std::thread txWorker;
+        void txWork();
+        void txWrite(const std::vector<TxFrame>& batch, std::vector<struct iovec>& iov, std::vector<int>& results);
+        std::string txJson() const;
+
+        // tx statistics, protected by txQueueMutex
+        size_t txFrames = 0;
+        size_t txWrites = 0;
+        size_t txBytes = 0;
+        std::chrono::microseconds txDelayTotal = {}; ///< enqueue until the writer picks the frame up
+        std::chrono::microseconds txDelayMax = {};
+        std::chrono::microseconds txWireTotal = {};  ///< time spent in writev
+        std::chrono::microseconds txWireMax = {};
+
+        // silence framing
+        std::atomic<int64_t> silenceUs = 0; ///< zero if silence framing is off
+        std::chrono::steady_clock::time_point lastRx; ///< time of the last received bytes, protected by rxMutex
+        std::chrono::steady_clock::time_point silenceDeadline() const;
+        bool waitReadable(); ///< wait for data, or for the silence that ends a frame
+        void closeFrame();
+
     public:
         /// Default Codec for Serial Hardware.
         class Codec : public abstract::Codec {
@@ -95,6 +372,7 @@ namespace Project::nexus::serial {
             std::string path() const override { return "/default_serial_hardware_codec"; }
             byte_view encode(byte_view buffer) const override;
             byte_view decode(byte_view buffer) const override;
+            Framing frame(byte_view buffer) const override;
         };
     
         friend class Interface;
@@ -116,6 +394,8 @@ namespace Project::nexus::serial {
             std::shared_ptr<Hardware> ser_;
             std::shared_ptr<abstract::Codec> codec_;
             std::list<CallbackId> callbacks_;
+            bool addedCodec_ = false; ///< the codec is registered by this interface
+
         };
     };
 }
@@ -124,8 +404,15 @@ namespace Project::nexus::serial {
 typedef void* nexus_serial_hardware_t;
 typedef void* nexus_serial_hardware_codec_id_t;
 typedef void* nexus_serial_hardware_callback_id_t;
+typedef void* nexus_serial_reactor_t;
+typedef void* nexus_serial_dispatcher_t;
+typedef void* nexus_serial_hotplug_t;
+typedef void* nexus_serial_arbiter_t;
+typedef void* nexus_serial_capture_t;
 
+/// speed: termios constant, e.g. B115200, or any baud rate, e.g. 3000000
 nexus_serial_hardware_t nexus_serial_hardware_new(const char* port, speed_t speed, int timeout, nexus_codec_t codec);
+nexus_serial_hardware_t nexus_serial_hardware_new_with_rx_buffer(const char* port, speed_t speed, int timeout, nexus_codec_t codec, size_t rx_buffer_size);
 
 int nexus_serial_hardware_send_codec(nexus_serial_hardware_t ser, nexus_codec_t codec, const uint8_t* buffer, size_t length);
 uint8_t* nexus_serial_hardware_receive_codec(nexus_serial_hardware_t ser, nexus_codec_t codec, int (*filter)(const uint8_t* buffer, size_t length), size_t* length);
@@ -136,5 +423,22 @@ void nexus_serial_hardware_remove_codec(nexus_serial_hardware_t ser, nexus_seria
 nexus_serial_hardware_callback_id_t nexus_serial_hardware_add_callback(nexus_serial_hardware_t ser, void (*callback)(const uint8_t* buffer, size_t length));
 void nexus_serial_hardware_remove_callback(nexus_serial_hardware_t ser, nexus_serial_hardware_callback_id_t callback);
 
+void nexus_serial_hardware_attach(nexus_serial_hardware_t ser, nexus_serial_reactor_t reactor);
+void nexus_serial_hardware_detach(nexus_serial_hardware_t ser);
+void nexus_serial_hardware_set_hotplug(nexus_serial_hardware_t ser, nexus_serial_hotplug_t hotplug);
+
+void nexus_serial_hardware_set_arbiter(nexus_serial_hardware_t ser, nexus_serial_arbiter_t arbiter);
+void nexus_serial_hardware_set_capture(nexus_serial_hardware_t ser, nexus_serial_capture_t capture);
+
+void nexus_serial_hardware_set_dispatcher(nexus_serial_hardware_t ser, nexus_serial_dispatcher_t dispatcher);
+/// Change the baud rate, e.g. 3000000. The port is reopened if it is connected.
+void nexus_serial_hardware_set_baud_rate(nexus_serial_hardware_t ser, int baud);
+void nexus_serial_hardware_set_silence_framing(nexus_serial_hardware_t ser, int enable, int gap_us);
+void nexus_serial_hardware_set_message_queue_capacity(nexus_serial_hardware_t ser, size_t capacity);
+
+/// Queue a frame for the writer thread. callback may be NULL, it is called with the number of bytes written or -1.
+/// @return 0 if queued, -1 if not connected.
+int nexus_serial_hardware_send_codec_async(nexus_serial_hardware_t ser, nexus_codec_t codec, const uint8_t* buffer, size_t length, void (*callback)(int res));
+
 #endif
 #endif
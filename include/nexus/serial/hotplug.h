@@ -0,0 +1,108 @@
+#ifndef PROJECT_NEXUS_SERIAL_HOTPLUG_H
+#define PROJECT_NEXUS_SERIAL_HOTPLUG_H
+
+#include "nexus/serial/hardware.h"
+
+#ifdef __cplusplus
+#include <vector>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <unordered_map>
+#include <chrono>
+
+namespace Project::nexus::serial {
+
+    /// Reconnect manager shared by many serial hardware ports.
+    /// One thread watches the device directory with inotify and reopens disconnected ports with exponential backoff,
+    /// retrying at once when a tty device appears. Ports join with `Hardware::setHotplug()`.
+    class Hotplug {
+    public:
+        /// Start watching the device directory.
+        /// @param [in] dir Directory of the tty devices.
+        /// @param [in] minBackoff First retry delay after a failed reconnect, doubled on every failure.
+        /// @param [in] maxBackoff Upper bound of the retry delay.
+        explicit Hotplug(
+            std::string dir = "/dev",
+            std::chrono::milliseconds minBackoff = std::chrono::milliseconds(100),
+            std::chrono::milliseconds maxBackoff = std::chrono::seconds(5)
+        );
+
+        /// Disabled copy constructor to prevent unintended object copies.
+        Hotplug(const Hotplug&) = delete;
+
+        /// Disabled copy assignment operator to prevent unintended object assignments.
+        Hotplug& operator=(const Hotplug&) = delete;
+
+        /// Stop and join the watcher thread.
+        virtual ~Hotplug();
+
+        /// USB serial devices in the directory, as `tools::detectVirtualComm()` finds them.
+        /// Cached, the directory is only scanned again after a tty device was added or removed.
+        std::vector<std::string> ports();
+
+        /// Number of watched ports.
+        size_t len() const;
+
+        /// Watcher statistics
+        /// @return Json string. Format: {"dir": <string>, "ports": <int>, "events": <int>, "scans": <int>,
+        /// "attempts": <int>, "reconnects": <int>}
+        std::string json() const;
+
+    protected:
+        friend class Hardware;
+        friend class Reactor;
+
+        /// Keep the port connected from now on.
+        void add(Hardware* ser);
+
+        /// Stop watching the port. Waits for a reconnect attempt of the port in progress, if any.
+        void remove(Hardware* ser);
+
+        /// The port was disconnected, or should reconnect: try again without waiting for the backoff.
+        void wake(Hardware* ser);
+
+    private:
+        void work();
+        void readEvents();
+        int waitTimeout() const;
+        void reconnectDue();
+
+        std::string dir;
+        std::chrono::milliseconds minBackoff;
+        std::chrono::milliseconds maxBackoff;
+
+        int infd = -1;
+        int evfd = -1;
+        std::atomic<bool> isRunning = true;
+        std::thread worker;
+
+        struct Entry {
+            std::chrono::steady_clock::time_point next; ///< next attempt, max if connected
+            std::chrono::milliseconds backoff;
+        };
+
+        mutable std::mutex mtx;
+        std::unordered_map<Hardware*, Entry> entries;
+        std::mutex attemptMutex; ///< held while a port is reconnecting
+
+        std::mutex cacheMutex;
+        std::vector<std::string> cache;
+        bool stale = true;
+
+        std::atomic<size_t> events = 0;
+        std::atomic<size_t> scans = 0;
+        std::atomic<size_t> attempts = 0;
+        std::atomic<size_t> reconnects = 0;
+    };
+}
+
+#else
+typedef void* nexus_serial_hotplug_t;
+
+nexus_serial_hotplug_t nexus_serial_hotplug_new();
+void nexus_serial_hotplug_delete(nexus_serial_hotplug_t hotplug);
+
+#endif
+#endif
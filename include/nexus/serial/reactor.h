@@ -0,0 +1,78 @@
+#ifndef PROJECT_NEXUS_SERIAL_REACTOR_H
+#define PROJECT_NEXUS_SERIAL_REACTOR_H
+
+#include "nexus/serial/hardware.h"
+
+#ifdef __cplusplus
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <unordered_set>
+#include <unordered_map>
+#include <chrono>
+
+namespace Project::nexus::serial {
+
+    /// Shared epoll loop that polls many serial hardware ports with one or a few threads,
+    /// instead of one blocking worker thread per port.
+    /// Ports join with `Hardware::attach()` and leave with `Hardware::detach()`.
+    class Reactor {
+    public:
+        /// Start the reactor threads.
+        /// @param [in] n_threads Number of threads waiting on the epoll instance.
+        explicit Reactor(size_t n_threads = 1);
+
+        /// Disabled copy constructor to prevent unintended object copies.
+        Reactor(const Reactor&) = delete;
+
+        /// Disabled copy assignment operator to prevent unintended object assignments.
+        Reactor& operator=(const Reactor&) = delete;
+
+        /// Stop and join the reactor threads.
+        virtual ~Reactor();
+
+        /// Number of attached ports.
+        size_t len() const;
+
+        /// Number of times a reactor thread returned from epoll_wait.
+        size_t wakeups() const { return wakeups_; }
+
+    protected:
+        friend class Hardware;
+
+        /// Start polling the port's current fd.
+        void add(Hardware* ser);
+
+        /// Stop polling the port. Waits for the port's data being processed by a reactor thread, if any.
+        void remove(Hardware* ser);
+
+    private:
+        void work();
+        void arm(Hardware* ser, int op);
+
+        // silence framing deadlines
+        void schedule(Hardware* ser, std::chrono::steady_clock::time_point deadline);
+        int waitTimeout() const;
+        void closeSilentFrames();
+
+        int epfd = -1;
+        int evfd = -1;
+        std::atomic<bool> isRunning = true;
+        std::atomic<size_t> wakeups_ = 0;
+        std::vector<std::thread> workers;
+
+        mutable std::mutex mtx;
+        std::unordered_set<Hardware*> ports;
+        std::unordered_map<Hardware*, std::chrono::steady_clock::time_point> deadlines;
+    };
+}
+
+#else
+typedef void* nexus_serial_reactor_t;
+
+nexus_serial_reactor_t nexus_serial_reactor_new(size_t n_threads);
+void nexus_serial_reactor_delete(nexus_serial_reactor_t reactor);
+
+#endif
+#endif
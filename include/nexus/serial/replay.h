@@ -0,0 +1,72 @@
+#ifndef PROJECT_NEXUS_SERIAL_REPLAY_H
+#define PROJECT_NEXUS_SERIAL_REPLAY_H
+
+#include "nexus/serial/hardware.h"
+
+#ifdef __cplusplus
+
+namespace Project::nexus::serial {
+
+    /// Serial port that plays back the received bytes of a `Capture`.
+    /// The bytes come in through a socket pair, so they take the same rx path as those of a device:
+    /// framing, codecs, message queues, callbacks and statistics. What is sent to the port is discarded.
+    class Replay : public Hardware {
+    public:
+        /// Start playing.
+        /// @param path Capture file.
+        /// @param codec Codec of the port, nullptr for the default codec.
+        /// @param realtime Feed the chunks at their captured times, or as fast as the port takes them.
+        Replay(std::string path, std::shared_ptr<abstract::Codec> codec, bool realtime = true,
+            std::chrono::milliseconds timeout = std::chrono::milliseconds(100), size_t rxBufferSize = 256);
+
+        virtual ~Replay();
+
+        /// RESTful GET
+        /// @return Response as json string. Format: {<Hardware json>, "replay": {"realtime": <bool>, "chunks": <int>,
+        /// "bytes": <int>, "finished": <bool>, "txDiscarded": <int>}}
+        std::string json() const override;
+
+        /// Play the capture again from the start.
+        void reconnect() override;
+
+        /// Wait until all the received bytes of the capture are fed to the port.
+        /// @return false on timeout.
+        bool wait(std::chrono::milliseconds timeout);
+
+        /// Received chunks and bytes fed so far.
+        size_t chunks() const { return chunks_; }
+        size_t bytes() const { return bytes_; }
+
+    private:
+        void start();
+        void stop();
+        void play();
+        bool feed(const uint8_t* data, size_t length);
+        bool drain(int timeout);
+
+        bool realtime;
+        int peer = -1; ///< the player's end of the socket pair
+        std::thread player;
+
+        mutable std::mutex mtx;
+        std::condition_variable cv;
+        bool isPlaying = false; ///< protected by mtx
+        bool isFinished = false; ///< protected by mtx
+
+        std::atomic<size_t> chunks_ = 0;
+        std::atomic<size_t> bytes_ = 0;
+        std::atomic<size_t> txDiscarded = 0;
+    };
+}
+
+#else
+typedef void* nexus_serial_hardware_t;
+typedef void* nexus_codec_t;
+
+/// A replay is a serial hardware port, the nexus_serial_hardware_* functions and nexus_serial_delete apply to it.
+/// realtime: 1 to keep the captured timing, 0 to play as fast as possible
+nexus_serial_hardware_t nexus_serial_replay_new(const char* path, nexus_codec_t codec, int realtime);
+int nexus_serial_replay_wait(nexus_serial_hardware_t replay, int timeout);
+
+#endif
+#endif
@@ -0,0 +1,117 @@
+#ifndef PROJECT_NEXUS_SERIAL_SIMULATOR_H
+#define PROJECT_NEXUS_SERIAL_SIMULATOR_H
+
+#include "nexus/abstract/codec.h"
+
+#ifdef __cplusplus
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <string>
+#include <functional>
+#include <chrono>
+#include <memory>
+
+namespace Project::nexus::serial {
+
+    /// Simulated serial device behind a pseudo terminal, `serial::Hardware` opens `port()` like a real port.
+    /// A device thread frames the bytes written to the port with the codec and writes back the encoded replies.
+    class Simulator {
+    public:
+        /// Decoded reply to a decoded request, empty for no reply.
+        using Responder = std::function<std::vector<uint8_t>(byte_view)>;
+
+        /// Time the device takes before it replies, called for every reply.
+        using Delay = std::function<std::chrono::microseconds()>;
+
+        /// Open the pseudo terminal and start the device thread.
+        /// @param codec Frames the requests and encodes the replies, nullptr for newline terminated frames.
+        /// Codecs without incremental framing get every burst of bytes as one frame.
+        Simulator(std::shared_ptr<abstract::Codec> codec, Responder responder);
+
+        /// Disabled copy constructor to prevent unintended object copies.
+        Simulator(const Simulator&) = delete;
+
+        /// Disabled copy assignment operator to prevent unintended object assignments.
+        Simulator& operator=(const Simulator&) = delete;
+
+        /// Stop the device thread and close the pseudo terminal.
+        virtual ~Simulator();
+
+        /// Replies with the request.
+        static Responder echo();
+
+        /// Replies to known requests with a fixed reply, other requests get no reply.
+        static Responder script(const std::vector<std::pair<byte_view, byte_view>>& replies);
+
+        /// Path of the simulated port, e.g. /dev/pts/3. Empty if the pseudo terminal can't be opened.
+        const std::string& port() const { return port_; }
+
+        /// Constant reply delay.
+        void setDelay(std::chrono::microseconds delay);
+
+        /// Reply delay computed per reply, e.g. random jitter.
+        void setDelay(Delay delay);
+
+        /// Write raw bytes as the device, e.g. unsolicited frames or line noise.
+        /// @return Number of bytes written, or -1.
+        int inject(byte_view buffer);
+
+        size_t requests() const { return requests_; }
+        size_t replies() const { return replies_; }
+
+        /// Device statistics
+        /// @return Json string. Format: {"port": <string>, "requests": <int>, "replies": <int>,
+        /// "bytesReceived": <int>, "bytesDiscarded": <int>}
+        std::string json() const;
+
+    protected:
+        /// Open the pseudo terminal, the device thread is started by `start()`.
+        /// For a derived class whose responder calls into it, the thread must not run before that class is constructed.
+        Simulator(std::shared_ptr<abstract::Codec> codec, Responder responder, bool start);
+
+        /// Start the device thread, no-op if it runs already or the pseudo terminal isn't open.
+        void start();
+
+        /// Stop the device thread. A derived class that started it stops it in its own destructor.
+        void stop();
+
+    private:
+        void work();
+        void decodeRequests();
+        void reply(byte_view request);
+
+        std::shared_ptr<abstract::Codec> codec;
+        Responder responder;
+
+        std::mutex delayMutex;
+        Delay delay;
+
+        int master = -1;
+        int slave = -1; ///< kept open, the port survives while `serial::Hardware` reconnects
+        std::string port_;
+        std::mutex txMutex;
+        std::vector<uint8_t> rxBuffer;
+
+        std::atomic<size_t> requests_ = 0;
+        std::atomic<size_t> replies_ = 0;
+        std::atomic<size_t> bytesReceived = 0;
+        std::atomic<size_t> bytesDiscarded = 0;
+
+        std::atomic<bool> isRunning = false;
+        std::thread worker;
+    };
+}
+
+#else
+typedef void* nexus_serial_simulator_t;
+
+nexus_serial_simulator_t nexus_serial_simulator_new_echo(nexus_codec_t codec);
+void nexus_serial_simulator_delete(nexus_serial_simulator_t sim);
+
+const char* nexus_serial_simulator_port(nexus_serial_simulator_t sim);
+void nexus_serial_simulator_set_delay(nexus_serial_simulator_t sim, int delay_us);
+int nexus_serial_simulator_inject(nexus_serial_simulator_t sim, const uint8_t* buffer, size_t length);
+#endif
+#endif // PROJECT_NEXUS_SERIAL_SIMULATOR_H
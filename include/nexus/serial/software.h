@@ -17,6 +17,7 @@ namespace Project::nexus::serial {
             static constexpr const char* port = "auto"; 
             static constexpr speed_t speed = B115200;
             static constexpr std::chrono::milliseconds timeout = std::chrono::milliseconds(100);
+            static constexpr size_t rxBufferSize = 256;
         };
 
         /// Arguments for constructing a `Serial` object.
@@ -25,6 +26,7 @@ namespace Project::nexus::serial {
             speed_t speed=Default::speed;
             std::chrono::milliseconds timeout=Default::timeout; 
             std::shared_ptr<abstract::Codec> codec = nullptr; 
+            size_t rxBufferSize=Default::rxBufferSize;
         };
 
         /// Constructor with args struct.
@@ -4,6 +4,7 @@
 #include "nexus/abstract/client.h"
 
 #ifdef __cplusplus
+#include "nexus/tools/frame_buffer.h"
 #include <functional>
 #include <atomic>
 #include <chrono>
@@ -28,6 +29,18 @@ namespace Project::nexus::tcp {
 
         nexus::byte_view request(nexus::byte_view buffer) override;
 
+        /// Send the buffer and receive the response into a reusable frame, allocating nothing once the frame is large enough.
+        /// @return false on error, see `error()`.
+        bool request(nexus::byte_view buffer, tools::FrameBuffer& res);
+
+        /// Send all the bytes, without waiting for a response.
+        /// @return false on error, see `error()`.
+        bool send(nexus::byte_view buffer);
+
+        /// Wait for bytes up to the timeout and append the ones available to res, for responses that are read as a stream.
+        /// @return false on timeout or error, see `error()`.
+        bool receive(tools::FrameBuffer& res, std::chrono::milliseconds timeout);
+
         enum Error {
             NONE,
             SOCKET,
@@ -44,10 +57,11 @@ namespace Project::nexus::tcp {
         Args args;
         int client_socket = -1;
         Error setup_error = Error::NONE;
-        Error error_ = Error::NONE;
+        std::atomic<Error> error_ = Error::NONE; ///< set by senders and by a reader thread alike
     
     private:
         // helper methods
+        bool transmit(nexus::byte_view buffer);
         bool receiveTimeout(std::chrono::milliseconds timeout);
 
         template <typename T, typename R = T>
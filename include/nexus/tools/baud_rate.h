@@ -0,0 +1,42 @@
+#ifndef PROJECT_NEXUS_TOOLS_BAUD_RATE_H
+#define PROJECT_NEXUS_TOOLS_BAUD_RATE_H
+
+#include <termios.h>
+#include <utility>
+
+namespace Project::nexus::tools {
+
+    /// termios speed constants and their baud rates. The constants are 1..15 and 4097..4111,
+    /// no realistic baud rate has one of these values, so a `speed_t` holds either one unambiguously.
+    static constexpr std::pair<speed_t, int> baud_rates[] = {
+        {B50, 50}, {B75, 75}, {B110, 110}, {B134, 134}, {B150, 150}, {B200, 200}, {B300, 300}, {B600, 600},
+        {B1200, 1200}, {B1800, 1800}, {B2400, 2400}, {B4800, 4800}, {B9600, 9600}, {B19200, 19200},
+        {B38400, 38400}, {B57600, 57600}, {B115200, 115200}, {B230400, 230400}, {B460800, 460800},
+        {B500000, 500000}, {B576000, 576000}, {B921600, 921600}, {B1000000, 1000000}, {B1152000, 1152000},
+        {B1500000, 1500000}, {B2000000, 2000000}, {B2500000, 2500000}, {B3000000, 3000000},
+        {B3500000, 3500000}, {B4000000, 4000000},
+    };
+
+    /// Baud rate of a speed, which is a termios constant, e.g. B115200, or already a baud rate, e.g. 250000.
+    constexpr int baud_rate(speed_t speed) {
+        for (auto &item : baud_rates)
+            if (item.first == speed)
+                return item.second;
+        return int(speed);
+    }
+
+    /// termios constant of a baud rate, B0 if there is none and the rate has to be set with termios2.
+    constexpr speed_t speed_constant(int baud) {
+        for (auto &item : baud_rates)
+            if (item.second == baud)
+                return item.first;
+        return B0;
+    }
+
+    /// Set any baud rate with termios2 and BOTHER, e.g. 250000 or 12 Mbaud.
+    /// Defined in src/serial/termios2.cpp, <asm/termbits.h> can't be included together with <termios.h>.
+    /// @return false if the driver rejects the rate.
+    bool set_custom_baud_rate(int fd, int baud);
+}
+
+#endif
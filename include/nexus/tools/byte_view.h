@@ -4,15 +4,47 @@
 #include "nexus/tools/check_index.h"
 #include <vector>
 #include <string>
+#include <atomic>
+#include <utility>
 
 namespace Project::nexus {
+
+    /// Reference counted immutable storage shared by byte_views.
+    class shared_buffer {
+    public:
+        void retain() const { refs.fetch_add(1, std::memory_order_relaxed); }
+        void release() const { if (refs.fetch_sub(1, std::memory_order_acq_rel) == 1) destroy(); }
+
+    protected:
+        shared_buffer() = default;
+        virtual ~shared_buffer() {}
+
+        /// Called when the last reference is released.
+        virtual void destroy() const { delete this; }
+
+        mutable std::atomic<size_t> refs = 1;
+    };
+
     class byte_view {
     public:
         byte_view() : buf(nullptr), length(0) {}
         byte_view(const uint8_t* buf, size_t length) : buf(buf), length(length) {} 
-        
-        byte_view(const byte_view& other) : buf(other.buf), length(other.length), vec(std::move(other.vec)) {} 
-        byte_view& operator=(const byte_view& other) { buf = other.buf; length = other.length; vec = std::move(other.vec); return *this; }
+
+        /// View that adopts one reference of owner.
+        byte_view(const uint8_t* buf, size_t length, const shared_buffer* owner) : buf(buf), length(length), owner(owner) {}
+
+        /// Copies share the bytes. The first copy of a view holding a vector moves the vector into shared storage.
+        byte_view(const byte_view& other) : buf(other.buf), length(other.length), owner(other.share()) {} 
+        byte_view(byte_view&& other) noexcept : buf(other.buf), length(other.length), vec(std::move(other.vec)), owner(std::exchange(other.owner, nullptr)) {}
+        byte_view& operator=(byte_view other) noexcept { 
+            std::swap(buf, other.buf); 
+            std::swap(length, other.length); 
+            std::swap(vec, other.vec); 
+            std::swap(owner, other.owner); 
+            return *this; 
+        }
+
+        ~byte_view() { if (owner) owner->release(); }
 
         byte_view(const std::vector<uint8_t>& v) : byte_view(v.data(), v.size()) {}
         byte_view(std::vector<uint8_t>&& v) : buf(v.data()), length(v.size()), vec(std::move(v)) {}
@@ -43,6 +75,9 @@ namespace Project::nexus {
         auto &back() const { return buf[length - 1]; }
         bool empty() const { return length == 0; }
 
+        /// The view keeps its bytes alive, either by holding a vector or a reference to shared storage.
+        bool is_owning() const { return owner != nullptr or not vec.empty(); }
+
         byte_view copy() const { return std::vector(buf, buf + length); }
         byte_view move() const { return *this; }
 
@@ -56,7 +91,7 @@ namespace Project::nexus {
 
         byte_view slice(int start, int stop, int step = 1) const {
             if (step == 1)
-                return start <= stop ? byte_view{buf + start, size_t(stop - start)} : byte_view{};
+                return start <= stop ? byte_view{buf + start, size_t(stop - start), share()} : byte_view{};
             
             std::vector<uint8_t> res;
             if (step > 0) {
@@ -82,6 +117,24 @@ namespace Project::nexus {
         const uint8_t* buf;
         size_t length;
         mutable std::vector<uint8_t> vec;
+        mutable const shared_buffer* owner = nullptr;
+
+        class vector_buffer : public shared_buffer {
+        public:
+            explicit vector_buffer(std::vector<uint8_t>&& vec) : vec(std::move(vec)) {}
+            std::vector<uint8_t> vec;
+        };
+
+        /// New reference to the shared storage, if any.
+        const shared_buffer* share() const {
+            if (not vec.empty()) {
+                owner = new vector_buffer(std::move(vec));
+                vec.clear();
+            }
+            if (owner)
+                owner->retain();
+            return owner;
+        }
     };
 }
 
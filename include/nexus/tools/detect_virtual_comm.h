@@ -4,23 +4,29 @@
 #include <string>
 #include <cstring>
 #include <vector>
+#include <algorithm>
 #include <dirent.h>
 
 namespace Project::nexus::tools {
 
-    inline std::vector<std::string> detectVirtualComm() {
+    /// USB serial devices (ttyACM*, ttyUSB*) in a device directory, sorted by name.
+    inline std::vector<std::string> detectVirtualComm(std::string path = "/dev") {
         struct dirent *ent;
         std::vector<std::string> res;
-        auto dir = opendir("/dev/");
-        
-        if (dir) {
-            while ((ent = readdir(dir)) != nullptr) {
-                if (::strstr(ent->d_name, "ttyACM") != nullptr || ::strstr(ent->d_name, "ttyUSB") != nullptr) 
-                    res.push_back(std::string("/dev/") + ent->d_name);
-            }
+        if (path.empty() || path.back() != '/')
+            path += '/';
+
+        auto dir = opendir(path.c_str());
+        if (!dir)
+            return res;
+
+        while ((ent = readdir(dir)) != nullptr) {
+            if (::strstr(ent->d_name, "ttyACM") != nullptr || ::strstr(ent->d_name, "ttyUSB") != nullptr) 
+                res.push_back(path + ent->d_name);
         }
 
         closedir(dir);
+        std::sort(res.begin(), res.end());
         return res;
     }
 }
@@ -0,0 +1,98 @@
+#ifndef PROJECT_NEXUS_TOOLS_FRAME_BUFFER_H
+#define PROJECT_NEXUS_TOOLS_FRAME_BUFFER_H
+
+#include "nexus/tools/byte_view.h"
+#include <algorithm>
+#include <cstring>
+
+namespace Project::nexus::tools {
+
+    /// Reusable frame storage with room reserved before and after the bytes, like Linux's sk_buff.
+    /// Codecs prepend a header with `push()`, append a trailer with `put()`, and strip them with `pull()` and `trim()`
+    /// in place. The storage only grows, so once it fits the largest frame, framing allocates nothing.
+    class FrameBuffer {
+    public:
+        explicit FrameBuffer(size_t capacity = 0) : storage(capacity) {}
+
+        /// Empty the frame, its bytes then start after headroom.
+        void reset(size_t headroom = 0) {
+            grow(headroom, 0);
+            head = headroom;
+            length = 0;
+        }
+
+        /// Replace the bytes, which may be a view into this frame, keeping at least headroom and tailroom around them.
+        /// By reference, a copy of an owning view would share its bytes through a heap allocation.
+        void assign(const byte_view& buffer, size_t headroom = 0, size_t tailroom = 0) {
+            if (headroom + buffer.len() + tailroom > storage.size()) {
+                std::vector<uint8_t> res(headroom + buffer.len() + tailroom);
+                std::copy(buffer.begin(), buffer.end(), res.begin() + headroom);
+                storage.swap(res);
+            } else {
+                ::memmove(storage.data() + headroom, buffer.data(), buffer.len());
+            }
+            head = headroom;
+            length = buffer.len();
+        }
+
+        const uint8_t* data() const { return storage.data() + head; }
+        uint8_t* data() { return storage.data() + head; }
+        size_t len() const { return length; }
+        bool empty() const { return length == 0; }
+
+        size_t headroom() const { return head; }
+        size_t tailroom() const { return storage.size() - head - length; }
+        size_t capacity() const { return storage.size(); }
+
+        /// Add n bytes in front, growing the storage if the headroom is short.
+        /// @return Pointer to the added bytes, the new start of the frame.
+        uint8_t* push(size_t n) {
+            grow(n, 0);
+            head -= n;
+            length += n;
+            return data();
+        }
+
+        /// Add n bytes at the end, growing the storage if the tailroom is short.
+        /// @return Pointer to the added bytes.
+        uint8_t* put(size_t n) {
+            grow(0, n);
+            length += n;
+            return data() + length - n;
+        }
+
+        /// Remove n bytes from the front, they become headroom.
+        void pull(size_t n) {
+            n = std::min(n, length);
+            head += n;
+            length -= n;
+        }
+
+        /// Remove n bytes from the end, they become tailroom.
+        void trim(size_t n) {
+            length -= std::min(n, length);
+        }
+
+        /// View of the bytes, valid until the frame changes.
+        byte_view view() const { return byte_view{data(), length}; }
+
+    private:
+        /// Make sure of at least this much headroom and tailroom, keeping the bytes.
+        void grow(size_t headroom, size_t tailroom) {
+            if (head >= headroom and this->tailroom() >= tailroom)
+                return;
+
+            const size_t newHead = std::max(head, headroom);
+            std::vector<uint8_t> res(newHead + length + std::max(this->tailroom(), tailroom));
+            std::copy(data(), data() + length, res.begin() + newHead);
+            storage.swap(res);
+            head = newHead;
+        }
+
+        std::vector<uint8_t> storage;
+        size_t head = 0;
+        size_t length = 0;
+    };
+}
+
+#endif
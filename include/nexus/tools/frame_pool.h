@@ -0,0 +1,118 @@
+#ifndef PROJECT_NEXUS_TOOLS_FRAME_POOL_H
+#define PROJECT_NEXUS_TOOLS_FRAME_POOL_H
+
+#include "nexus/tools/byte_view.h"
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <cstring>
+
+namespace Project::nexus::tools {
+
+    /// Slab allocated, reference counted frame buffers.
+    /// A block goes back to the pool when the last byte_view referencing it is gone,
+    /// so after warm-up a frame is copied once and shared without heap allocations.
+    /// Must be owned by a std::shared_ptr, blocks keep the pool alive.
+    class FramePool : public std::enable_shared_from_this<FramePool> {
+    public:
+        /// @param blockSize Size of every block. Larger frames fall back to a heap allocated copy.
+        /// @param slabSize Number of blocks allocated at once when the pool runs out of blocks.
+        explicit FramePool(size_t blockSize, size_t slabSize = 16)
+            : blockSize_(std::max(blockSize, size_t(1))), slabSize(std::max(slabSize, size_t(1))) {}
+
+        FramePool(const FramePool&) = delete;
+        FramePool& operator=(const FramePool&) = delete;
+
+        /// Copy the bytes into a block.
+        byte_view copy(byte_view buffer) {
+            if (buffer.len() > blockSize_) {
+                std::lock_guard<std::mutex> lock(mtx);
+                ++fallbacks;
+                return buffer.copy();
+            }
+
+            auto block = acquire();
+            ::memcpy(block->data, buffer.data(), buffer.len());
+            return byte_view{block->data, buffer.len(), block};
+        }
+
+        /// View that keeps its bytes alive: owning views are shared as they are, others are copied into a block.
+        byte_view share(byte_view buffer) {
+            return buffer.is_owning() ? buffer : copy(buffer);
+        }
+
+        size_t blockSize() const { return blockSize_; }
+
+        /// Number of allocated blocks.
+        size_t blocks() const { std::lock_guard<std::mutex> lock(mtx); return slabs.size() * slabSize; }
+
+        /// Number of blocks not referenced by any byte_view.
+        size_t available() const { std::lock_guard<std::mutex> lock(mtx); return free.size(); }
+
+        /// Pool statistics
+        /// @return Json string. Format: {"blockSize": <int>, "blocks": <int>, "available": <int>, "fallbacks": <int>}
+        std::string json() const {
+            std::lock_guard<std::mutex> lock(mtx);
+            return "{"
+                "\"blockSize\": " + std::to_string(blockSize_) + ", "
+                "\"blocks\": " + std::to_string(slabs.size() * slabSize) + ", "
+                "\"available\": " + std::to_string(free.size()) + ", "
+                "\"fallbacks\": " + std::to_string(fallbacks) +
+            "}";
+        }
+
+    private:
+        struct Block : public shared_buffer {
+            std::shared_ptr<FramePool> pool; ///< set while the block is referenced
+            uint8_t* data = nullptr;
+
+            void reset() { refs.store(1, std::memory_order_relaxed); }
+
+            void destroy() const override {
+                auto self = const_cast<Block*>(this);
+                auto keep = std::move(self->pool);
+                keep->recycle(self); // the pool, and this block with it, may be deleted when keep goes out of scope
+            }
+        };
+
+        struct Slab {
+            std::unique_ptr<Block[]> blocks;
+            std::unique_ptr<uint8_t[]> data;
+        };
+
+        Block* acquire() {
+            auto self = shared_from_this();
+            std::lock_guard<std::mutex> lock(mtx);
+            if (free.empty()) {
+                auto slab = Slab{std::make_unique<Block[]>(slabSize), std::make_unique<uint8_t[]>(slabSize * blockSize_)};
+                free.reserve(slabSize * (slabs.size() + 1));
+                for (size_t i = 0; i < slabSize; ++i) {
+                    slab.blocks[i].data = slab.data.get() + i * blockSize_;
+                    free.push_back(&slab.blocks[i]);
+                }
+                slabs.push_back(std::move(slab));
+            }
+
+            auto block = free.back();
+            free.pop_back();
+            block->reset();
+            block->pool = std::move(self);
+            return block;
+        }
+
+        void recycle(Block* block) {
+            std::lock_guard<std::mutex> lock(mtx);
+            free.push_back(block);
+        }
+
+        size_t blockSize_;
+        size_t slabSize;
+
+        mutable std::mutex mtx;
+        std::vector<Slab> slabs;
+        std::vector<Block*> free;
+        size_t fallbacks = 0;
+    };
+}
+
+#endif
@@ -0,0 +1,118 @@
+#ifndef PROJECT_NEXUS_TOOLS_HISTOGRAM_H
+#define PROJECT_NEXUS_TOOLS_HISTOGRAM_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <cstdint>
+
+namespace Project::nexus::tools {
+
+    /// Lock-free log-linear histogram in the style of HdrHistogram.
+    /// Values below 32 are counted exactly, larger values within 1/16 of their magnitude, up to 2^36.
+    class Histogram {
+    public:
+        static constexpr int subBits = 4;
+        static constexpr uint64_t subCount = 1 << subBits;
+        static constexpr uint64_t maxValue = (uint64_t(1) << 36) - 1;
+        static constexpr size_t bucketCount = (36 - subBits + 1) * subCount;
+
+        Histogram() = default;
+        Histogram(const Histogram&) = delete;
+        Histogram& operator=(const Histogram&) = delete;
+
+        void record(uint64_t value) {
+            value = value < maxValue ? value : maxValue;
+            buckets[index(value)].fetch_add(1, std::memory_order_relaxed);
+            count_.fetch_add(1, std::memory_order_relaxed);
+            sum.fetch_add(value, std::memory_order_relaxed);
+
+            for (auto m = min_.load(std::memory_order_relaxed); value < m and not min_.compare_exchange_weak(m, value, std::memory_order_relaxed);) {}
+            for (auto m = max_.load(std::memory_order_relaxed); value > m and not max_.compare_exchange_weak(m, value, std::memory_order_relaxed);) {}
+        }
+
+        /// Record a duration in microseconds, negative durations count as zero.
+        template <typename Rep, typename Period>
+        void record(std::chrono::duration<Rep, Period> duration) {
+            auto us = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+            record(uint64_t(us < 0 ? 0 : us));
+        }
+
+        uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+        uint64_t min() const { return count() == 0 ? 0 : min_.load(std::memory_order_relaxed); }
+        uint64_t max() const { return max_.load(std::memory_order_relaxed); }
+        uint64_t mean() const { auto n = count(); return n == 0 ? 0 : sum.load(std::memory_order_relaxed) / n; }
+
+        /// Highest value equivalent to the given percentile, e.g. 99.9.
+        uint64_t percentile(double p) const {
+            auto n = count();
+            if (n == 0)
+                return 0;
+
+            auto target = uint64_t(p / 100.0 * n + 0.5);
+            target = target == 0 ? 1 : target;
+            uint64_t seen = 0;
+            for (size_t i = 0; i < bucketCount; ++i) {
+                seen += buckets[i].load(std::memory_order_relaxed);
+                if (seen >= target)
+                    return highest(i) < max() ? highest(i) : max();
+            }
+            return max();
+        }
+
+        void reset() {
+            for (auto &bucket : buckets)
+                bucket.store(0, std::memory_order_relaxed);
+            count_ = 0;
+            sum = 0;
+            min_ = UINT64_MAX;
+            max_ = 0;
+        }
+
+        /// Histogram summary
+        /// @return Json string. Format: {"count": <int>, "min": <int>, "mean": <int>, "p50": <int>, "p90": <int>,
+        /// "p99": <int>, "p999": <int>, "max": <int>}
+        std::string json() const {
+            return "{"
+                "\"count\": " + std::to_string(count()) + ", "
+                "\"min\": " + std::to_string(min()) + ", "
+                "\"mean\": " + std::to_string(mean()) + ", "
+                "\"p50\": " + std::to_string(percentile(50)) + ", "
+                "\"p90\": " + std::to_string(percentile(90)) + ", "
+                "\"p99\": " + std::to_string(percentile(99)) + ", "
+                "\"p999\": " + std::to_string(percentile(99.9)) + ", "
+                "\"max\": " + std::to_string(max()) +
+            "}";
+        }
+
+        /// Bucket of a value: exact below 2 * subCount, then subCount linear buckets per power of two.
+        static size_t index(uint64_t value) {
+            if (value < 2 * subCount)
+                return value;
+
+            auto magnitude = 63 - __builtin_clzll(value);
+            auto shift = magnitude - subBits;
+            return (shift + 1) * subCount + ((value >> shift) - subCount);
+        }
+
+        /// Highest value that falls into a bucket.
+        static uint64_t highest(size_t index) {
+            if (index < 2 * subCount)
+                return index;
+
+            auto shift = index / subCount - 1;
+            auto sub = index % subCount + subCount;
+            return ((sub + 1) << shift) - 1;
+        }
+
+    private:
+        std::array<std::atomic<uint64_t>, bucketCount> buckets = {};
+        std::atomic<uint64_t> count_ = 0;
+        std::atomic<uint64_t> sum = 0;
+        std::atomic<uint64_t> min_ = UINT64_MAX;
+        std::atomic<uint64_t> max_ = 0;
+    };
+}
+
+#endif
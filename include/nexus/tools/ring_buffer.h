@@ -0,0 +1,83 @@
+#ifndef PROJECT_NEXUS_TOOLS_RING_BUFFER_H
+#define PROJECT_NEXUS_TOOLS_RING_BUFFER_H
+
+#include "nexus/tools/byte_view.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <cstring>
+
+namespace Project::nexus::tools {
+
+    /// Lock-free single-producer single-consumer byte ring buffer.
+    /// Every written byte is mirrored into a second copy of the storage,
+    /// so the readable bytes are always contiguous and can be viewed without copying.
+    class RingBuffer {
+    public:
+        explicit RingBuffer(size_t capacity) : capacity_(capacity), storage(new uint8_t[capacity * 2]) {}
+
+        RingBuffer(const RingBuffer&) = delete;
+        RingBuffer& operator=(const RingBuffer&) = delete;
+
+        size_t capacity() const { return capacity_; }
+        size_t size() const { return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire); }
+        size_t available() const { return capacity_ - size(); }
+        bool empty() const { return size() == 0; }
+        bool full() const { return size() == capacity_; }
+
+        /// Producer: get the contiguous free space to write into.
+        /// @param length Output, number of bytes that can be written at the returned pointer.
+        /// @return Pointer to the free space. Written bytes are published by `commit()`.
+        uint8_t* reserve(size_t& length) {
+            const size_t h = head.load(std::memory_order_relaxed);
+            const size_t pos = h % capacity_;
+            length = std::min(capacity_ - (h - tail.load(std::memory_order_acquire)), capacity_ - pos);
+            return storage.get() + pos;
+        }
+
+        /// Producer: publish bytes written into the space returned by `reserve()`.
+        void commit(size_t length) {
+            const size_t h = head.load(std::memory_order_relaxed);
+            const size_t pos = h % capacity_;
+            ::memcpy(storage.get() + pos + capacity_, storage.get() + pos, length);
+            head.store(h + length, std::memory_order_release);
+        }
+
+        /// Producer: write as many bytes as fit.
+        /// @return Number of bytes written.
+        size_t write(byte_view buffer) {
+            size_t written = 0;
+            while (written < buffer.len()) {
+                size_t length;
+                auto ptr = reserve(length);
+                if (length == 0)
+                    break;
+
+                length = std::min(length, buffer.len() - written);
+                ::memcpy(ptr, buffer.data() + written, length);
+                commit(length);
+                written += length;
+            }
+            return written;
+        }
+
+        /// Consumer: view all readable bytes.
+        byte_view view() const {
+            const size_t t = tail.load(std::memory_order_relaxed);
+            return {storage.get() + t % capacity_, head.load(std::memory_order_acquire) - t};
+        }
+
+        /// Consumer: drop the first n readable bytes.
+        void consume(size_t n) {
+            tail.store(tail.load(std::memory_order_relaxed) + std::min(n, size()), std::memory_order_release);
+        }
+
+    private:
+        size_t capacity_;
+        std::unique_ptr<uint8_t[]> storage;
+        std::atomic<size_t> head = 0;
+        std::atomic<size_t> tail = 0;
+    };
+}
+
+#endif
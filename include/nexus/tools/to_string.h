@@ -56,7 +56,7 @@ namespace Project::nexus::tools {
 
     template <typename T>
     std::string to_string(const std::function<T()>& fn) {
-        return to_string(fn());
+        return fn ? to_string(fn()) : "null";
     }
 
     template <typename K, typename V>
@@ -15,7 +15,7 @@ void pybind11::bindModbusAPI(module_& m) {
     .value("DATA_FRAME", nexus::modbus::Error::DATA_FRAME)
     .export_values();
 
-    m.def("ModbusCRC", nexus::modbus::api::crc, arg("buffer"));
+    m.def("ModbusCRC", static_cast<uint16_t(*)(nexus::byte_view)>(nexus::modbus::api::crc), arg("buffer"));
 
     class_<nexus::modbus::api::Codec, nexus::abstract::Codec, std::shared_ptr<nexus::modbus::api::Codec>>(m, "ModbusCodec")
     .def(init<>());
@@ -7,10 +7,31 @@ namespace pybind11 {
 }
 
 void pybind11::bindModbusTCPClient(module_& m) {
+    enum_<nexus::modbus::tcp::Protocol>(m, "ModbusTCPProtocol")
+    .value("RTU", nexus::modbus::tcp::Protocol::RTU)
+    .value("MBAP", nexus::modbus::tcp::Protocol::MBAP);
+
     class_<nexus::modbus::tcp::Client, nexus::modbus::api::Client, std::shared_ptr<nexus::modbus::tcp::Client>>(m, "ModbusTCPClient")
-    .def(init<std::string, int, std::chrono::milliseconds>(), 
+    .def(init<std::string, int, std::chrono::milliseconds, nexus::modbus::tcp::Protocol>(), 
         arg("host"), 
         arg("port"),
-        arg("timeout") = std::chrono::milliseconds(1000)
+        arg("timeout") = std::chrono::milliseconds(1000),
+        arg("protocol") = nexus::modbus::tcp::Protocol::RTU
+    )
+    .def("protocol", &nexus::modbus::tcp::Client::protocol)
+    .def("pipeline", 
+        [] (nexus::modbus::tcp::Client& self, const std::vector<std::vector<uint8_t>>& requests, size_t window) {
+            gil_scoped_release gil_release;
+            var reqs = std::vector<nexus::byte_view>();
+            for (val& req in requests)
+                reqs.push_back(nexus::byte_view{req.data(), req.size()});
+
+            var res = std::vector<std::vector<uint8_t>>();
+            for (val& r in self.pipeline(reqs, window))
+                res.push_back(r.to_vector());
+            return res;
+        },
+        arg("requests"),
+        arg("window") = 16
     );
-}
\ No newline at end of file
+}
@@ -1,5 +1,8 @@
 #include "../pybind.h"
 #include "nexus/serial/software.h"
+#include "nexus/serial/reactor.h"
+#include "nexus/serial/hotplug.h"
+#include "nexus/serial/replay.h"
 #include <future>
 #include <etl/keywords.h>
 
@@ -10,18 +13,84 @@ namespace pybind11 {
 }
 
 void pybind11::bindSerialHardware(module_& m) {
+    class_<nexus::serial::Reactor, std::shared_ptr<nexus::serial::Reactor>>(m, "SerialReactor", "Shared epoll loop for many serial hardware ports")
+    .def(init<size_t>(),
+        arg("n_threads")=1
+    )
+    .def("__len__", &nexus::serial::Reactor::len)
+    .def("wakeups", &nexus::serial::Reactor::wakeups);
+
+    class_<nexus::serial::Hotplug, std::shared_ptr<nexus::serial::Hotplug>>(m, "SerialHotplug", "Reconnect manager watching the tty devices with inotify")
+    .def(init<std::string, std::chrono::milliseconds, std::chrono::milliseconds>(),
+        arg("dir")="/dev",
+        arg("min_backoff")=100ms,
+        arg("max_backoff")=5s
+    )
+    .def("ports", &nexus::serial::Hotplug::ports)
+    .def("__len__", &nexus::serial::Hotplug::len)
+    .def("json", &nexus::serial::Hotplug::json);
+
+    class_<nexus::serial::Arbiter, std::shared_ptr<nexus::serial::Arbiter>>(m, "SerialArbiter", "Priority scheduler of the request/response transactions on a half-duplex line")
+    .def(init<std::chrono::microseconds>(),
+        arg("gap")
+    )
+    .def("queued", &nexus::serial::Arbiter::queued)
+    .def("json", &nexus::serial::Arbiter::json);
+
+    class_<nexus::serial::Capture, std::shared_ptr<nexus::serial::Capture>>(m, "SerialCapture", "Memory mapped recording of the traffic of serial hardware ports")
+    .def(init<std::string, size_t>(),
+        arg("path"),
+        arg("capacity")=size_t(1) << 20
+    )
+    .def("isOpen", &nexus::serial::Capture::isOpen)
+    .def("json", &nexus::serial::Capture::json);
+
+    enum_<nexus::serial::Dispatcher::Overflow>(m, "SerialDispatcherOverflow")
+    .value("DROP_OLDEST", nexus::serial::Dispatcher::DROP_OLDEST)
+    .value("BLOCK", nexus::serial::Dispatcher::BLOCK)
+    .value("DROP_NEWEST", nexus::serial::Dispatcher::DROP_NEWEST);
+
+    class_<nexus::serial::Dispatcher, std::shared_ptr<nexus::serial::Dispatcher>>(m, "SerialDispatcher", "Bounded worker pool for serial frame callbacks")
+    .def(init<size_t, size_t, nexus::serial::Dispatcher::Overflow>(),
+        arg("n_workers")=1,
+        arg("capacity")=64,
+        arg("overflow")=nexus::serial::Dispatcher::DROP_OLDEST
+    )
+    .def("depth", &nexus::serial::Dispatcher::depth)
+    .def("json", &nexus::serial::Dispatcher::json);
+
+    class_<nexus::serial::Hardware::Message>(m, "SerialMessage", "Decoded frame queued by a serial hardware port")
+    .def_readonly("seq", &nexus::serial::Hardware::Message::seq)
+    .def_readonly("first_byte", &nexus::serial::Hardware::Message::firstByte)
+    .def_readonly("timestamp", &nexus::serial::Hardware::Message::timestamp)
+    .def_readonly("data", &nexus::serial::Hardware::Message::data);
+
     class_<nexus::serial::Hardware, nexus::abstract::Serial, std::shared_ptr<nexus::serial::Hardware>>(m, "SerialHardware", "Serial Hardware Communication")
-    .def(init<std::string, speed_t, std::chrono::milliseconds, std::shared_ptr<nexus::abstract::Codec>>(),
+    .def(init<std::string, speed_t, std::chrono::milliseconds, std::shared_ptr<nexus::abstract::Codec>, size_t>(),
         arg("port"), 
         arg("speed"),
         arg("timeout"),
-        arg("codec")
+        arg("codec"),
+        arg("rx_buffer_size")=256
     )
     .def("sendCodec",
         &nexus::serial::Hardware::sendCodec,
         arg("codec"),
         arg("buffer")
     )
+    .def("sendAsync",
+        [] (nexus::serial::Hardware& self, std::shared_ptr<nexus::abstract::Codec> codec, nexus::byte_view buffer, nexus::serial::Hardware::SendCallback callback) {
+            gil_scoped_release gil_release;
+            return self.sendAsync(codec, buffer, std::move(callback));
+        },
+        arg("codec"),
+        arg("buffer"),
+        arg("callback")=nullptr
+    )
+    .def("setTxQueueCapacity",
+        &nexus::serial::Hardware::setTxQueueCapacity,
+        arg("capacity")
+    )
     .def("receiveCodec",
         [] (nexus::serial::Hardware& self, std::shared_ptr<nexus::abstract::Codec> codec, std::function<bool(nexus::byte_view)> filter) {
             gil_scoped_release gil_release;
@@ -30,6 +99,24 @@ void pybind11::bindSerialHardware(module_& m) {
         arg("codec"),
         arg("filter")
     )
+    .def("receiveMessages",
+        [] (nexus::serial::Hardware& self, std::shared_ptr<nexus::abstract::Codec> codec, std::function<bool(nexus::byte_view)> filter, size_t max, uint64_t after) {
+            gil_scoped_release gil_release;
+            return self.receiveMessages(codec, std::move(filter), max, after);
+        },
+        arg("codec"),
+        arg("filter"),
+        arg("max")=SIZE_MAX,
+        arg("after")=0
+    )
+    .def("sequence",
+        &nexus::serial::Hardware::sequence,
+        arg("codec")
+    )
+    .def("setMessageQueueCapacity",
+        &nexus::serial::Hardware::setMessageQueueCapacity,
+        arg("capacity")
+    )
     .def("addCodec",
         &nexus::serial::Hardware::addCodec,
         arg("codec")
@@ -46,10 +133,78 @@ void pybind11::bindSerialHardware(module_& m) {
         &nexus::serial::Hardware::removeCallback,
         arg("callback")
     )
+    .def("attach",
+        [] (nexus::serial::Hardware& self, std::shared_ptr<nexus::serial::Reactor> reactor) {
+            gil_scoped_release gil_release;
+            self.attach(std::move(reactor));
+        },
+        arg("reactor")
+    )
+    .def("detach",
+        [] (nexus::serial::Hardware& self) {
+            gil_scoped_release gil_release;
+            self.detach();
+        }
+    )
+    .def("setHotplug",
+        [] (nexus::serial::Hardware& self, std::shared_ptr<nexus::serial::Hotplug> hotplug) {
+            gil_scoped_release gil_release;
+            self.setHotplug(std::move(hotplug));
+        },
+        arg("hotplug")
+    )
+    .def("setDispatcher",
+        &nexus::serial::Hardware::setDispatcher,
+        arg("dispatcher")
+    )
+    .def("getDispatcher", &nexus::serial::Hardware::getDispatcher)
+    .def("setArbiter",
+        &nexus::serial::Hardware::setArbiter,
+        arg("arbiter")
+    )
+    .def("getArbiter", &nexus::serial::Hardware::getArbiter)
+    .def("setCapture",
+        &nexus::serial::Hardware::setCapture,
+        arg("capture")
+    )
+    .def("getCapture", &nexus::serial::Hardware::getCapture)
+    .def("setSilenceFraming",
+        &nexus::serial::Hardware::setSilenceFraming,
+        arg("enable"),
+        arg("gap")=std::chrono::microseconds(0)
+    )
+    .def_static("t35", &nexus::serial::Hardware::t35, arg("speed"))
+    .def_static("wireTime", &nexus::serial::Hardware::wireTime, arg("speed"), arg("bytes"))
+    .def("setBaudRate",
+        [] (nexus::serial::Hardware& self, int baud) {
+            gil_scoped_release gil_release;
+            self.setBaudRate(baud);
+        },
+        arg("baud")
+    )
+    .def("baudRate", &nexus::serial::Hardware::baudRate)
     .def_readwrite("port", &nexus::serial::Hardware::port)
     .def_readwrite("speed", &nexus::serial::Hardware::speed)
     .def_readwrite("timeout", &nexus::serial::Hardware::timeout);
 
+    class_<nexus::serial::Replay, nexus::serial::Hardware, std::shared_ptr<nexus::serial::Replay>>(m, "SerialReplay", "Serial port playing back a capture")
+    .def(init<std::string, std::shared_ptr<nexus::abstract::Codec>, bool, std::chrono::milliseconds, size_t>(),
+        arg("path"),
+        arg("codec")=nullptr,
+        arg("realtime")=true,
+        arg("timeout")=100ms,
+        arg("rx_buffer_size")=256
+    )
+    .def("wait",
+        [] (nexus::serial::Replay& self, std::chrono::milliseconds timeout) {
+            gil_scoped_release gil_release;
+            return self.wait(timeout);
+        },
+        arg("timeout")
+    )
+    .def("chunks", &nexus::serial::Replay::chunks)
+    .def("bytes", &nexus::serial::Replay::bytes);
+
     class_<nexus::serial::Hardware::Interface, std::shared_ptr<nexus::serial::Hardware::Interface>>(m, "SerialHardwareInterface", "Serial Hardware Interface")
     .def(init<std::shared_ptr<nexus::serial::Hardware>>(),
         arg("hardware_serial")
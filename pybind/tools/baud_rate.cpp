@@ -1,4 +1,6 @@
 #include "../pybind.h"
+#include "nexus/tools/baud_rate.h"
+#include <etl/keywords.h>
 
 namespace pybind11 { 
     void bindBaudRate(module_& m); 
@@ -13,16 +15,9 @@ void pybind11::bindBaudRate(module_& m) {
     m.attr("B4800") = B4800;
     m.attr("B2400") = B2400;
 
+    // rates without a termios constant, e.g. 250000, are passed on as they are and set with termios2
     m.def("BaudRate", [] (int value) {
-        switch (value) {
-            case 115200: return B115200;
-            case 57600:  return B57600;
-            case 38400:  return B38400;
-            case 19200:  return B19200;
-            case 9600:   return B9600;
-            case 4800:   return B4800;
-            case 2400:   return B2400;
-            default:     return B115200;
-        }
+        auto constant = nexus::tools::speed_constant(value);
+        return constant != B0 ? constant : speed_t(value);
     });
 }
@@ -33,6 +33,12 @@ fun abstract::Codec::post(std::string_view method_name, std::string_view json_re
     return tools::json_response_status_fail_unknown_method();
 }
 
+fun abstract::Codec::encodeInto(tools::FrameBuffer& frame) const -> void {
+    val res = encode(frame.view());
+    if (res.data() != frame.data() or res.len() != frame.len())
+        frame.assign(res, frame.headroom());
+}
+
 abstract::c_wrapper::Codec::~Codec() { 
     delete restful; 
 }
@@ -0,0 +1,21 @@
+#include "nexus/loopback/client.h"
+#include <etl/keywords.h>
+
+using namespace nexus;
+
+fun loopback::Client::request(byte_view buffer) -> byte_view {
+    if (end->send(buffer) < 0)
+        return {};
+
+    return end->receive();
+}
+
+extern "C" {
+    typedef void* nexus_loopback_client_t;
+    typedef void* nexus_serial_t;
+
+    nexus_loopback_client_t nexus_loopback_client_new(nexus_serial_t end) {
+        val serial = dynamic_cast<loopback::Serial*>(static_cast<abstract::Serial*>(end));
+        return static_cast<abstract::Client*>(new loopback::Client(std::shared_ptr<loopback::Serial>(serial)));
+    }
+}
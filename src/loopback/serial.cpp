@@ -0,0 +1,237 @@
+#include "nexus/loopback/serial.h"
+#include "nexus/tools/ring_buffer.h"
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <etl/keywords.h>
+
+using namespace nexus;
+
+/// How long a waiting end polls the ring buffer before it sleeps.
+/// A peer in the same process usually answers well within it, unless it needs the very cpu the spinning takes.
+static const auto spinTime = std::thread::hardware_concurrency() > 1 ? std::chrono::microseconds(50) : std::chrono::microseconds(0);
+
+fun static relax() -> void {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+struct loopback::Serial::Line {
+    /// Bytes going one way, written by one end and read by the other.
+    struct Direction {
+        explicit Direction(size_t capacity) : ring(capacity) {}
+
+        tools::RingBuffer ring;
+        tools::FrameBuffer frame; ///< encoded in place before it goes into the ring buffer
+        std::mutex txMutex; ///< the ring buffer takes one producer at a time
+        std::mutex rxMutex; ///< and one consumer at a time
+
+        std::mutex mtx;
+        std::condition_variable cv;
+        std::atomic<int> sleepers = 0;
+
+        /// Wait for the condition, spinning first, sleeping only when the peer takes long.
+        template <typename Ready>
+        bool await(Ready ready, std::chrono::steady_clock::time_point deadline) {
+            val spinDeadline = std::min(deadline, std::chrono::steady_clock::now() + spinTime);
+            for (var i = 0u;; ++i) {
+                if (ready())
+                    return true;
+                if (i % 64 == 0 and std::chrono::steady_clock::now() >= spinDeadline)
+                    break;
+                relax();
+            }
+
+            ++sleepers;
+            std::unique_lock<std::mutex> lock(mtx);
+            val res = cv.wait_until(lock, deadline, ready);
+            --sleepers;
+            return res;
+        }
+
+        /// Wake the sleeping peer, if any. No syscall otherwise.
+        void wake() {
+            // the ring buffer update is visible before the sleepers are counted, or the peer sees it before it sleeps
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (sleepers.load() > 0) {
+                std::lock_guard<std::mutex> lock(mtx);
+                cv.notify_all();
+            }
+        }
+
+        void wakeAll() {
+            std::lock_guard<std::mutex> lock(mtx);
+            cv.notify_all();
+        }
+    };
+
+    Line(std::shared_ptr<abstract::Codec> codec, size_t capacity, std::chrono::milliseconds timeout)
+        : codec(std::move(codec)), timeout(timeout), ab(capacity), ba(capacity) {}
+
+    Direction& tx(int side) { return side == 0 ? ab : ba; }
+    Direction& rx(int side) { return side == 0 ? ba : ab; }
+
+    std::shared_ptr<abstract::Codec> codec;
+    std::chrono::milliseconds timeout;
+    std::atomic<bool> connected = true;
+
+    Direction ab; ///< from end a to end b
+    Direction ba; ///< from end b to end a
+};
+
+fun loopback::Serial::pair(std::shared_ptr<abstract::Codec> codec, size_t capacity, std::chrono::milliseconds timeout) -> std::pair<std::shared_ptr<Serial>, std::shared_ptr<Serial>> {
+    val line = std::make_shared<Line>(std::move(codec), capacity, timeout);
+    return {std::make_shared<Serial>(line, 0), std::make_shared<Serial>(line, 1)};
+}
+
+loopback::Serial::Serial(std::shared_ptr<Line> line, int side) : line(std::move(line)), side(side) {}
+
+loopback::Serial::~Serial() {}
+
+fun loopback::Serial::json() const -> std::string {
+    return "{"
+        "\"isConnected\": " + std::string(isConnected() ? "true" : "false") + ", "
+        "\"sent\": " + std::to_string(sent_) + ", "
+        "\"received\": " + std::to_string(received_) + ", "
+        "\"bytesDiscarded\": " + std::to_string(bytesDiscarded) +
+    "}";
+}
+
+fun loopback::Serial::reconnect() -> void {
+    line->connected = true;
+}
+
+fun loopback::Serial::disconnect() -> void {
+    line->connected = false;
+    line->ab.wakeAll();
+    line->ba.wakeAll();
+}
+
+fun loopback::Serial::isConnected() const -> bool {
+    return line->connected;
+}
+
+fun loopback::Serial::send(byte_view buffer) -> int {
+    if (not line->connected)
+        return -1;
+
+    val deadline = std::chrono::steady_clock::now() + line->timeout;
+    var& tx = line->tx(side);
+    std::lock_guard<std::mutex> lock(tx.txMutex);
+
+    // a view, copies of an owning buffer share its bytes through a heap allocation
+    var encoded = byte_view{buffer.data(), buffer.len()};
+    if (line->codec) {
+        tx.frame.assign(buffer, line->codec->headroom(), line->codec->tailroom());
+        line->codec->encodeInto(tx.frame);
+        encoded = tx.frame.view();
+    }
+
+    for (var written = size_t(0); written < encoded.len();) {
+        written += tx.ring.write(byte_view{encoded.data() + written, encoded.len() - written});
+        tx.wake();
+
+        if (written < encoded.len() and not tx.await([&] { return not line->connected or not tx.ring.full(); }, deadline))
+            return -1;
+        if (not line->connected)
+            return -1;
+    }
+
+    ++sent_;
+    return encoded.len();
+}
+
+fun loopback::Serial::receive(std::function<bool(byte_view)> filter) -> byte_view {
+    return receiveFrame(filter, nullptr, std::chrono::steady_clock::time_point::max());
+}
+
+fun loopback::Serial::receive(const std::function<bool(byte_view)>& filter, tools::FrameBuffer& res, std::chrono::steady_clock::time_point until) -> bool {
+    return not receiveFrame(filter, &res, until).empty();
+}
+
+fun loopback::Serial::receiveFrame(const std::function<bool(byte_view)>& filter, tools::FrameBuffer* into, std::chrono::steady_clock::time_point until) -> byte_view {
+    using Framing = abstract::Codec::Framing;
+
+    val deadline = std::min(until, std::chrono::steady_clock::now() + line->timeout);
+    var& rx = line->rx(side);
+    val& codec = line->codec;
+
+    std::lock_guard<std::mutex> lock(rx.rxMutex);
+    for (var seen = size_t(0); line->connected;) {
+        val view = rx.ring.view();
+        if (view.len() <= seen) {
+            // nothing new to frame
+            if (not rx.await([&] { return not line->connected or rx.ring.size() > seen; }, deadline))
+                return {};
+            continue;
+        }
+
+        // decoded in the ring buffer, a view until it is consumed
+        var frame = byte_view{};
+        var consumed = size_t(0);
+        if (not codec) {
+            frame = view;
+            consumed = view.len();
+        } else {
+            val res = codec->frame(view);
+            if (res.status == Framing::COMPLETE) {
+                frame = codec->decodeView(byte_view{view.data(), res.length});
+                consumed = frame.empty() ? 1 : res.length;
+            }
+            elif (res.status == Framing::DISCARD) {
+                consumed = std::min(std::max(res.length, size_t(1)), view.len());
+            }
+            elif (res.status == Framing::UNSUPPORTED) {
+                // the bytes sent so far are the frame, a partial frame waits for the rest
+                frame = codec->decodeView(view);
+                if (not frame.empty() or view.len() == rx.ring.capacity())
+                    consumed = view.len();
+            }
+            if (frame.empty())
+                bytesDiscarded += consumed;
+        }
+
+        if (consumed == 0) {
+            seen = view.len();
+            continue;
+        }
+
+        // the ring buffer bytes are overwritten once consumed, only the accepted frame is copied out
+        val accepted = not frame.empty() and filter(frame);
+        var res = byte_view{};
+        if (accepted and into) {
+            into->assign(frame);
+            res = into->view();
+        }
+        elif (accepted) {
+            res = frame.copy();
+        }
+
+        rx.ring.consume(consumed);
+        rx.wake();
+        seen = 0;
+
+        if (frame.empty())
+            continue;
+
+        ++received_;
+        if (accepted)
+            return res;
+    }
+    return {};
+}
+
+extern "C" {
+    typedef void* nexus_serial_t;
+    typedef void* nexus_codec_t;
+
+    void nexus_loopback_serial_pair(nexus_codec_t codec, size_t capacity, int timeout, nexus_serial_t* a, nexus_serial_t* b) {
+        val line = std::make_shared<loopback::Serial::Line>(
+            std::shared_ptr<abstract::Codec>(static_cast<abstract::Codec*>(codec)), capacity, std::chrono::milliseconds(timeout));
+        *a = static_cast<abstract::Serial*>(new loopback::Serial(line, 0));
+        *b = static_cast<abstract::Serial*>(new loopback::Serial(line, 1));
+    }
+}
@@ -1,31 +1,94 @@
 #include "nexus/modbus/api.h"
+#include <algorithm>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
 #include <etl/keywords.h>
 
 using namespace nexus;
 
 fun modbus::api::Codec::encode(byte_view buffer) const -> byte_view {
     val crc = modbus::api::crc(buffer);
-    std::vector<uint8_t> res = buffer;
-    res.resize(res.size() + 2);
-    res[res.size() - 2] = (crc >> 0) & 0xFF;
-    res[res.size() - 1] = (crc >> 8) & 0xFF;
+    var res = std::vector<uint8_t>();
+    res.reserve(buffer.len() + 2);
+    res.insert(res.end(), buffer.begin(), buffer.end());
+    res.push_back((crc >> 0) & 0xFF);
+    res.push_back((crc >> 8) & 0xFF);
     return res;
 }
 
-fun modbus::api::Codec::decode(byte_view buffer) const -> byte_view {
+fun modbus::api::Codec::encodeInto(tools::FrameBuffer& frame) const -> void {
+    val crc = modbus::api::crc(frame.view());
+    var tail = frame.put(2);
+    tail[0] = (crc >> 0) & 0xFF;
+    tail[1] = (crc >> 8) & 0xFF;
+}
+
+fun modbus::api::Codec::decodeView(byte_view buffer) const -> byte_view {
     if (buffer.len() < 4)
         return {};
 
     val crc = modbus::api::crc(byte_view{buffer.data(), buffer.len() - 2});
     if (crc != (buffer[-2] | buffer[-1] << 8))
         return {};
-    
-    std::vector<uint8_t> res = buffer;
-    res.resize(res.size() - 2);
-    return res;
+
+    return byte_view{buffer.data(), buffer.len() - 2};
+}
+
+fun modbus::api::Codec::decode(byte_view buffer) const -> byte_view {
+    if (decodeView(buffer).empty())
+        return {};
+
+    // a view without the crc, sharing the bytes if the buffer owns them
+    return buffer.slice(0, buffer.len() - 2);
+}
+
+fun modbus::api::Codec::frame(byte_view buffer) const -> Framing {
+    if (buffer.len() < 2)
+        return {Framing::NEED_MORE, 2 - buffer.len()};
+
+    FrameFinder::Layout candidates[2] = {};
+    val n = FrameFinder::layouts(buffer[1], candidates);
+    if (n == 0)
+        return {};
+
+    // the shortest candidate with a matching crc wins
+    var missing = size_t(0);
+    var complete = size_t(0);
+    for (val i in etl::range(n)) {
+        val [header, offset, fixed] = candidates[i];
+        var length = size_t(fixed);
+        if (header > 0) {
+            if (buffer.len() < header) {
+                missing = missing == 0 ? header - buffer.len() : etl::min(missing, header - buffer.len());
+                continue;
+            }
+            length += buffer[offset];
+        }
+
+        if (buffer.len() < length) {
+            missing = missing == 0 ? length - buffer.len() : etl::min(missing, length - buffer.len());
+            continue;
+        }
+
+        val crc = modbus::api::crc(byte_view{buffer.data(), length - 2});
+        if (crc == (buffer[length - 2] | buffer[length - 1] << 8))
+            complete = complete == 0 ? length : etl::min(complete, length);
+    }
+
+    if (complete > 0)
+        return {Framing::COMPLETE, complete};
+
+    // none of the candidates matches, so this is not a frame start
+    if (missing == 0)
+        return {Framing::DISCARD, 1};
+
+    return {Framing::NEED_MORE, missing};
 }
 
-static const uint16_t crcTable[] = {
+static constexpr uint16_t crcTable[256] = {
         0X0000, 0XC0C1, 0XC181, 0X0140, 0XC301, 0X03C0, 0X0280, 0XC241,
         0XC601, 0X06C0, 0X0780, 0XC741, 0X0500, 0XC5C1, 0XC481, 0X0440,
         0XCC01, 0X0CC0, 0X0D80, 0XCD41, 0X0F00, 0XCFC1, 0XCE81, 0X0E40,
@@ -60,14 +123,275 @@ static const uint16_t crcTable[] = {
         0X8201, 0X42C0, 0X4380, 0X8341, 0X4100, 0X81C1, 0X8081, 0X4040
 };
 
-fun modbus::api::crc(byte_view buffer) -> uint16_t {
-    uint16_t res = 0xFFFF;
-    for (val byte in buffer) {
-        uint8_t temp = byte ^ res;
-        res >>= 8;
-        res ^= crcTable[temp];
+/// tables[k][b] is the crc of byte b followed by k zero bytes, from a zero crc. tables[0] is crcTable
+struct SlicingTables {
+    uint16_t tables[16][256];
+};
+
+static constexpr auto slicing = [] {
+    var res = SlicingTables{};
+    for (var b = 0; b < 256; ++b) {
+        res.tables[0][b] = crcTable[b];
+        for (var k = 1; k < 16; ++k) {
+            val prev = res.tables[k - 1][b];
+            res.tables[k][b] = (prev >> 8) ^ crcTable[prev & 0xFF];
+        }
     }
     return res;
+}();
+
+fun static crcTableKernel(const uint8_t* data, size_t len, uint16_t crc) -> uint16_t {
+    for (; len > 0; ++data, --len)
+        crc = (crc >> 8) ^ crcTable[uint8_t(*data ^ crc)];
+    return crc;
+}
+
+/// Each byte of a block goes through its own table independently, the crc only mixes into the first two
+template <size_t N>
+fun static crcSlicingStep(const uint8_t* data, uint16_t crc) -> uint16_t {
+    val& t = slicing.tables;
+    var res = uint16_t(t[N - 1][data[0] ^ (crc & 0xFF)] ^ t[N - 2][data[1] ^ (crc >> 8)]);
+    for (var i = size_t(2); i < N; ++i)
+        res ^= t[N - 1 - i][data[i]];
+    return res;
+}
+
+fun static crcSlicingKernel(const uint8_t* data, size_t len, uint16_t crc) -> uint16_t {
+    for (; len >= 16; data += 16, len -= 16)
+        crc = crcSlicingStep<16>(data, crc);
+    if (len >= 8) {
+        crc = crcSlicingStep<8>(data, crc);
+        data += 8;
+        len -= 8;
+    }
+    return crcTableKernel(data, len, crc);
+}
+
+#if defined(__x86_64__)
+/// The reflected crc of P(x) = x^16 + x^15 + x^2 + 1 is the low 16 bits of the reflected crc of P(x) x^16,
+/// which folds like the 32-bit crcs, constants as in Intel's "Fast CRC Computation Using PCLMULQDQ Instruction"
+namespace clmul {
+    constexpr uint64_t poly = 0x180050000;
+
+    constexpr fun reflect(uint64_t value, int bits) -> uint64_t {
+        var res = uint64_t(0);
+        for (var i = 0; i < bits; ++i)
+            if (value >> i & 1)
+                res |= uint64_t(1) << (bits - 1 - i);
+        return res;
+    }
+
+    /// Reflected x^n mod P, shifted for the product of reflected operands
+    constexpr fun fold(unsigned n) -> uint64_t {
+        var res = uint64_t(1);
+        for (var i = 0u; i < n; ++i) {
+            res <<= 1;
+            if (res >> 32)
+                res ^= poly;
+        }
+        return reflect(res, 32) << 1;
+    }
+
+    /// Reflected x^64 / P for the Barrett reduction
+    constexpr fun mu() -> uint64_t {
+        var rem = uint64_t(0), res = uint64_t(0);
+        for (var i = 64; i >= 0; --i) {
+            rem = (rem << 1) | (i == 64);
+            if (rem >> 32 & 1) {
+                rem ^= poly;
+                res |= uint64_t(1) << i;
+            }
+        }
+        return reflect(res, 33);
+    }
+
+    constexpr uint64_t k1 = fold(4 * 128 + 32), k2 = fold(4 * 128 - 32);
+    constexpr uint64_t k3 = fold(128 + 32), k4 = fold(128 - 32);
+    constexpr uint64_t k5 = fold(64);
+    constexpr uint64_t p = reflect(poly, 33), u = mu();
+}
+
+__attribute__((target("pclmul,sse4.1")))
+static inline __m128i crcFold(__m128i x, __m128i k, __m128i next) {
+    return _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x, k, 0x00), _mm_clmulepi64_si128(x, k, 0x11)), next);
+}
+
+__attribute__((target("pclmul,sse4.1")))
+static uint16_t crcClmulKernel(const uint8_t* data, size_t len, uint16_t crc) {
+    if (len < 64)
+        return crcSlicingKernel(data, len, crc);
+
+    val k1k2 = _mm_set_epi64x(clmul::k2, clmul::k1);
+    val k3k4 = _mm_set_epi64x(clmul::k4, clmul::k3);
+    val k5 = _mm_set_epi64x(0, clmul::k5);
+    val pu = _mm_set_epi64x(clmul::u, clmul::p);
+    val mask = _mm_setr_epi32(~0, 0, ~0, 0);
+    val load = [] (const uint8_t* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); };
+
+    // four independent folds 512 bits apart keep the multiplier busy
+    var x1 = _mm_xor_si128(load(data), _mm_cvtsi32_si128(crc));
+    var x2 = load(data + 16), x3 = load(data + 32), x4 = load(data + 48);
+    for (data += 64, len -= 64; len >= 64; data += 64, len -= 64) {
+        x1 = crcFold(x1, k1k2, load(data));
+        x2 = crcFold(x2, k1k2, load(data + 16));
+        x3 = crcFold(x3, k1k2, load(data + 32));
+        x4 = crcFold(x4, k1k2, load(data + 48));
+    }
+
+    x1 = crcFold(x1, k3k4, x2);
+    x1 = crcFold(x1, k3k4, x3);
+    x1 = crcFold(x1, k3k4, x4);
+    for (; len >= 16; data += 16, len -= 16)
+        x1 = crcFold(x1, k3k4, load(data));
+
+    // 128 bits to 64
+    x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), _mm_clmulepi64_si128(x1, k3k4, 0x10));
+    x1 = _mm_xor_si128(_mm_srli_si128(x1, 4), _mm_clmulepi64_si128(_mm_and_si128(x1, mask), k5, 0x00));
+
+    // Barrett reduction to 32 bits, the modbus crc in the low 16
+    var x = _mm_clmulepi64_si128(_mm_and_si128(x1, mask), pu, 0x10);
+    x = _mm_clmulepi64_si128(_mm_and_si128(x, mask), pu, 0x00);
+    crc = uint16_t(_mm_extract_epi32(_mm_xor_si128(x1, x), 1));
+
+    return crcSlicingKernel(data, len, crc);
+}
+#endif
+
+fun static supported(modbus::api::CrcKernel kernel) -> bool {
+    if (kernel != modbus::api::CrcKernel::CLMUL)
+        return true;
+#if defined(__x86_64__)
+    static val res = [] {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("pclmul") and __builtin_cpu_supports("sse4.1");
+    }();
+    return res;
+#else
+    return false;
+#endif
+}
+
+fun static crcRun(modbus::api::CrcKernel kernel, byte_view buffer) -> uint16_t {
+    switch (kernel) {
+#if defined(__x86_64__)
+        case modbus::api::CrcKernel::CLMUL:
+            return crcClmulKernel(buffer.data(), buffer.len(), 0xFFFF);
+#endif
+        case modbus::api::CrcKernel::TABLE:
+            return crcTableKernel(buffer.data(), buffer.len(), 0xFFFF);
+        default:
+            return crcSlicingKernel(buffer.data(), buffer.len(), 0xFFFF);
+    }
+}
+
+fun modbus::api::crcKernel() -> CrcKernel {
+    static val res = supported(CrcKernel::CLMUL) ? CrcKernel::CLMUL : CrcKernel::SLICING;
+    return res;
+}
+
+fun modbus::api::crc(byte_view buffer) -> uint16_t {
+    return crcRun(crcKernel(), buffer);
+}
+
+fun modbus::api::crc(byte_view buffer, CrcKernel kernel) -> uint16_t {
+    return crcRun(supported(kernel) ? kernel : crcKernel(), buffer);
+}
+
+fun modbus::api::Codec::finder() const -> std::unique_ptr<Finder> {
+    return std::make_unique<FrameFinder>();
+}
+
+fun modbus::api::FrameFinder::layouts(uint8_t fc, Layout (&res)[2]) -> uint8_t {
+    uint8_t n = 0;
+    if (fc & 0x80) {
+        res[n++] = {0, 0, 5}; // exception response
+    } 
+    elif (fc >= READ_COILS and fc <= READ_INPUT_REGISTERS) {
+        res[n++] = {0, 0, 8}; // request
+        res[n++] = {3, 2, 5}; // response: address, fc, byte count, data, crc
+    } 
+    elif (fc == WRITE_SINGLE_COIL or fc == WRITE_SINGLE_REGISTER or fc == DIAGNOSTIC) {
+        res[n++] = {0, 0, 8}; // request and echoed response
+    } 
+    elif (fc == READ_EXCEPTION_STATUS) {
+        res[n++] = {0, 0, 4}; // request
+        res[n++] = {0, 0, 5}; // response: address, fc, status, crc
+    } 
+    elif (fc == WRITE_MULTIPLE_COILS or fc == WRITE_MULTIPLE_REGISTERS) {
+        res[n++] = {0, 0, 8}; // response
+        res[n++] = {7, 6, 9}; // request: address, fc, register, count, byte count, data, crc
+    }
+    return n;
+}
+
+fun modbus::api::FrameFinder::find(byte_view pending) -> Found {
+    // found before, still pending until consumed
+    if (found.length > 0) {
+        found.message = byte_view{pending.data() + found.begin, found.length - 2};
+        return found;
+    }
+
+    val data = pending.data();
+    for (; scanned < pending.len() and found.length == 0; ++scanned) {
+        val byte = data[scanned];
+        candidates.push_back({scanned, 0xFFFF, UNRESOLVED, {}});
+
+        for (var &candidate in candidates) {
+            candidate.crc = (candidate.crc >> 8) ^ crcTable[uint8_t(byte ^ candidate.crc)];
+            val length = scanned + 1 - candidate.start;
+            if (length == 2)
+                candidate.n = layouts(byte, candidate.layouts);
+
+            // the crc over a frame including its crc is 0, the earliest start ending here wins
+            if (length < 4 or candidate.crc != 0 or found.length > 0)
+                continue;
+
+            var fits = candidate.n == 0;
+            for (val i in etl::range(candidate.n)) {
+                val [header, offset, fixed] = candidate.layouts[i];
+                if (length == size_t(fixed) + (header > 0 ? data[candidate.start + offset] : 0))
+                    fits = true;
+            }
+            if (fits)
+                found = {candidate.start, length, byte_view{data + candidate.start, length - 2}};
+        }
+
+        // drop the candidates that can't end anymore: past the maximum length, or past every length their header allows
+        val next = scanned + 1;
+        candidates.erase(std::remove_if(candidates.begin(), candidates.end(), [this, data, next] (const Candidate& candidate) {
+            val length = next - candidate.start;
+            if (length >= maxLength)
+                return true;
+            if (candidate.n == UNRESOLVED or candidate.n == 0)
+                return false;
+
+            for (val i in etl::range(candidate.n)) {
+                val [header, offset, fixed] = candidate.layouts[i];
+                if (header > 0 and length < header)
+                    return false;
+                if (length < size_t(fixed) + (header > 0 ? data[candidate.start + offset] : 0))
+                    return false;
+            }
+            return true;
+        }), candidates.end());
+    }
+
+    return found;
+}
+
+fun modbus::api::FrameFinder::consume(size_t n) -> void {
+    candidates.erase(std::remove_if(candidates.begin(), candidates.end(), [n] (const Candidate& candidate) {
+        return candidate.start < n;
+    }), candidates.end());
+
+    for (var &candidate in candidates)
+        candidate.start -= n;
+
+    scanned = scanned > n ? scanned - n : 0;
+    if (found.length > 0 and found.begin >= n)
+        found.begin -= n;
+    else
+        found = {};
 }
 
 extern "C" {
@@ -1,5 +1,6 @@
 #include "nexus/modbus/api_client.h"
 #include "nexus/tools/json.h"
+#include <algorithm>
 #include <etl/keywords.h>
 
 using namespace nexus;
@@ -159,51 +160,54 @@ fun modbus::api::Client::post(std::string_view method_name, std::string_view jso
     return abstract::Client::post(method_name, json_request);
 }
 
-fun modbus::api::Client::ReadCoils(uint16_t register_address, uint16_t n_register) -> std::vector<bool> {    
-    uint8_t req[6] = {};
+/// Server address, function code and two 16 bit fields: the request of the reads and of the single writes
+fun static request_header(uint8_t* req, int server_address, modbus::FunctionCode function_code, uint16_t a, uint16_t b) -> void {
     req[0] = server_address;
-    req[1] = READ_COILS;
-    req[2] = (register_address >> 8) & 0xFF;
-    req[3] = (register_address >> 0) & 0xFF;
-    req[4] = (n_register >> 8) & 0xFF;
-    req[5] = (n_register >> 0) & 0xFF;
-
-    val res = request(req);
-    val return_ = [this] (std::vector<bool> res, Error err) { error_ = err; return res; };
+    req[1] = function_code;
+    req[2] = (a >> 8) & 0xFF;
+    req[3] = (a >> 0) & 0xFF;
+    req[4] = (b >> 8) & 0xFF;
+    req[5] = (b >> 0) & 0xFF;
+}
 
-    try {
-        bool byte_count_size_is_2 = false;
-        size_t byte_count = res[2];
+fun static write_multiple_coils_request(int server_address, uint16_t register_address, uint16_t n_register, const std::vector<bool>& values) -> std::vector<uint8_t> {
+    int byte_count = values.size() / 8 + 1;
+    var req = std::vector<uint8_t>(6);
+    req.reserve(7 + byte_count);
+    request_header(req.data(), server_address, modbus::WRITE_MULTIPLE_COILS, register_address, n_register);
+    req.push_back(byte_count);
 
-        if (byte_count != res.size() - 3) {
-            byte_count = (res[2] << 8) | res[3];
-            if (byte_count == res.size() - 4) {
-                byte_count_size_is_2 = true;
-            } else {
-                return return_({}, Error::DATA_FRAME);
-            }
+    uint8_t byte = 0;
+    int cnt = 0;
+    for (val bit in values) {
+        byte |= bit << cnt++;
+        if (cnt == 8) {
+            req.push_back(byte);
+            cnt = 0;
         }
-
-        const int index_begin = byte_count_size_is_2 ? 4 : 3;
-        return return_(std::vector<bool>(res.begin() + index_begin, res.end()), Error::NONE);
     }
-    catch (const std::out_of_range&) {
-        return return_({}, Error::TIMEOUT);
+    if (cnt > 0 && cnt < 8) {
+        req.push_back(byte);
     }
+    return req;
 }
 
-fun modbus::api::Client::ReadDiscreteInputs(uint16_t register_address, uint16_t n_register) -> std::vector<bool> {
-    uint8_t req[6] = {};
-    req[0] = server_address;
-    req[1] = READ_DISCRETE_INPUTS;
-    req[2] = (register_address >> 8) & 0xFF;
-    req[3] = (register_address >> 0) & 0xFF;
-    req[4] = (n_register >> 8) & 0xFF;
-    req[5] = (n_register >> 0) & 0xFF;
-    
-    val res = request(req);
-    val return_ = [this] (std::vector<bool> res, Error err) { error_ = err; return res; };
+fun static write_multiple_registers_request(int server_address, uint16_t register_address, uint16_t n_register, const std::vector<uint16_t>& values) -> std::vector<uint8_t> {
+    int byte_count = values.size() * 2;
+    var req = std::vector<uint8_t>(6);
+    req.reserve(7 + byte_count);
+    request_header(req.data(), server_address, modbus::WRITE_MULTIPLE_REGISTERS, register_address, n_register);
+    req.push_back(byte_count);
 
+    for (val reg in values) {
+        req.push_back((reg >> 8) & 0xFF);
+        req.push_back((reg >> 0) & 0xFF);
+    }
+    return req;
+}
+
+/// Coils or discrete inputs of a response, the byte count takes one or two bytes
+fun static parse_bits(byte_view res) -> modbus::api::Response<std::vector<bool>> {
     try {
         bool byte_count_size_is_2 = false;
         size_t byte_count = res[2];
@@ -213,146 +217,166 @@ fun modbus::api::Client::ReadDiscreteInputs(uint16_t register_address, uint16_t
             if (byte_count == res.size() - 4) {
                 byte_count_size_is_2 = true;
             } else {
-                return return_({}, Error::DATA_FRAME);
+                return {{}, modbus::Error::DATA_FRAME};
             }
         }
 
         const int index_begin = byte_count_size_is_2 ? 4 : 3;
-        return return_(std::vector<bool>(res.begin() + index_begin, res.end()), Error::NONE);
+        return {std::vector<bool>(res.begin() + index_begin, res.end()), modbus::Error::NONE};
     }
     catch (const std::out_of_range&) {
-        return return_({}, Error::TIMEOUT);
+        return {{}, modbus::Error::TIMEOUT};
     }
 }
 
-fun modbus::api::Client::ReadHoldingRegisters(uint16_t register_address, uint16_t n_register) -> std::vector<uint16_t> {
-    uint8_t req[6] = {};
-    req[0] = server_address;
-    req[1] = READ_HOLDING_REGISTERS;
-    req[2] = (register_address >> 8) & 0xFF;
-    req[3] = (register_address >> 0) & 0xFF;
-    req[4] = (n_register >> 8) & 0xFF;
-    req[5] = (n_register >> 0) & 0xFF;
-    
-    val res = request(req);
-    val return_ = [this] (std::vector<uint16_t> res, Error err) { error_ = err; return res; };
+/// Registers of a response into res, at most n_register of them
+fun static parse_registers(byte_view response, uint16_t n_register, uint16_t* res) -> modbus::api::Response<size_t> {
+    val buffer = response.data();
+    val len = response.len();
 
-    try {
-        bool byte_count_size_is_2 = false;
-        size_t byte_count = res[2];
+    if (len < 3)
+        return {0, modbus::Error::TIMEOUT};
 
-        if (byte_count != res.size() - 3) {
-            byte_count = (res[2] << 8) | res[3];
-            if (byte_count == res.size() - 4) {
-                byte_count_size_is_2 = true;
-            } else {
-                return return_({}, Error::DATA_FRAME);
-            }
-        }
+    var byte_count = size_t(buffer[2]);
+    var index_begin = size_t(3);
+    if (byte_count != len - 3) {
+        byte_count = len < 4 ? 0 : size_t(buffer[2] << 8 | buffer[3]);
+        index_begin = 4;
+        if (len < 4 or byte_count != len - 4)
+            return {0, modbus::Error::DATA_FRAME};
+    }
 
-        const int length = byte_count / 2;
-        const int index_begin = byte_count_size_is_2 ? 4 : 3;
+    val length = std::min(byte_count / 2, size_t(n_register));
+    for (val i in etl::range(length))
+        res[i] = buffer[index_begin + i * 2] << 8 | buffer[index_begin + i * 2 + 1];
 
-        std::vector<uint16_t> ret;
-        ret.reserve(length);
-        for (int i = 0; i < length; ++i)
-            ret.push_back(res[index_begin + i * 2] << 8 | res[index_begin + i * 2 + 1]);
+    return {length, modbus::Error::NONE};
+}
+
+/// The echo of a single coil write
+fun static parse_single_coil(const uint8_t* req, byte_view res) -> modbus::api::Response<bool> {
+    try {
+        if (res.size() < 4 or not std::equal(res.begin(), res.begin() + 4, req))
+            return {{}, modbus::Error::DATA_FRAME};
+        
+        if (res[4] == 0xFF) 
+            return {true, modbus::Error::NONE};
         
-        return return_(std::move(ret), Error::NONE);
+        if (res[4] == 0x00) 
+            return {false, modbus::Error::NONE};
+
+        return {{}, modbus::Error::DATA_FRAME};
+    } catch (const std::out_of_range&) {
+        return {{}, modbus::Error::TIMEOUT};
     }
-    catch (const std::out_of_range&) {
-        return return_({}, Error::TIMEOUT);
+}
+
+/// The echo of a single register write
+fun static parse_single_register(const uint8_t* req, byte_view res) -> modbus::api::Response<uint16_t> {
+    try {
+        if (res.size() < 4 or not std::equal(res.begin(), res.begin() + 4, req))
+            return {{}, modbus::Error::DATA_FRAME};
+        
+        return {uint16_t(res[4] << 8 | res[5]), modbus::Error::NONE};
+    } catch (const std::out_of_range&) {
+        return {{}, modbus::Error::TIMEOUT};
     }
 }
 
-fun modbus::api::Client::ReadInputRegisters(uint16_t register_address, uint16_t n_register) -> std::vector<uint16_t> {
-    uint8_t req[6] = {};
-    req[0] = server_address;
-    req[1] = READ_INPUT_REGISTERS;
-    req[2] = (register_address >> 8) & 0xFF;
-    req[3] = (register_address >> 0) & 0xFF;
-    req[4] = (n_register >> 8) & 0xFF;
-    req[5] = (n_register >> 0) & 0xFF;
+/// The echo of the first 6 bytes of a multiple write, the value is whether it succeeded
+fun static parse_write_multiple(const uint8_t* req, byte_view res) -> modbus::api::Response<bool> {
+    if (res.size() < 6)
+        return {false, modbus::Error::TIMEOUT};
     
-    val res = request(req);
-    val return_ = [this] (std::vector<uint16_t> res, Error err) { error_ = err; return res; };
+    if (not std::equal(res.begin(), res.begin() + 6, req))
+        return {false, modbus::Error::DATA_FRAME};
+    
+    return {true, modbus::Error::NONE};
+}
 
+fun static parse_exception_status(byte_view res) -> modbus::api::Response<uint8_t> {
     try {
-        bool byte_count_size_is_2 = false;
-        size_t byte_count = res[2];
+        return {res[3], modbus::Error::NONE};
+    } catch (const std::out_of_range&) {
+        return {0, modbus::Error::TIMEOUT};
+    }
+}
 
-        if (byte_count != res.size() - 3) {
-            byte_count = (res[2] << 8) | res[3];
-            if (byte_count == res.size() - 4) {
-                byte_count_size_is_2 = true;
-            } else {
-                return return_({}, Error::DATA_FRAME);
-            }
-        }
+fun static parse_diagnostic(byte_view res) -> modbus::api::Response<std::vector<uint8_t>> {
+    if (res.size() < 2)
+        return {{}, modbus::Error::TIMEOUT};
 
-        const int length = byte_count / 2;
-        const int index_begin = byte_count_size_is_2 ? 4 : 3;
+    return {{res.begin() + 2, res.end()}, modbus::Error::NONE};
+}
 
-        std::vector<uint16_t> ret;
-        ret.reserve(length);
-        for (int i = 0; i < length; ++i)
-            ret.push_back(res[index_begin + i * 2] << 8 | res[index_begin + i * 2 + 1]);
-        
-        return return_(std::move(ret), Error::NONE);
-    }
-    catch (const std::out_of_range&) {
-        return return_({}, Error::TIMEOUT);
-    }
+fun modbus::api::Client::ReadCoils(uint16_t register_address, uint16_t n_register) -> std::vector<bool> {    
+    uint8_t req[6] = {};
+    request_header(req, server_address, READ_COILS, register_address, n_register);
+
+    std::lock_guard<std::mutex> lock(transactMutex);
+    var res = parse_bits(transact(req));
+    error_ = res.error;
+    return std::move(res.value);
 }
 
-fun modbus::api::Client::WriteSingleCoil(uint16_t register_address, bool value) -> bool {
+fun modbus::api::Client::ReadDiscreteInputs(uint16_t register_address, uint16_t n_register) -> std::vector<bool> {
     uint8_t req[6] = {};
-    req[0] = server_address;
-    req[1] = WRITE_SINGLE_COIL;
-    req[2] = (register_address >> 8) & 0xFF;
-    req[3] = (register_address >> 0) & 0xFF;
-    req[4] = value ? 0xFF : 0x00;
-    req[5] = 0x00;
+    request_header(req, server_address, READ_DISCRETE_INPUTS, register_address, n_register);
     
-    val res = request(req);
-    val return_ = [this] (bool res, Error err) { error_ = err; return std::move(res); };
+    std::lock_guard<std::mutex> lock(transactMutex);
+    var res = parse_bits(transact(req));
+    error_ = res.error;
+    return std::move(res.value);
+}
 
-    try {
-        if (res.size() < 4 or not std::equal(res.begin(), res.begin() + 4, req))
-            return return_({}, Error::DATA_FRAME);
-        
-        if (res[4] == 0xFF) 
-            return return_(true, Error::NONE);
-        
-        if (res[4] == 0x00) 
-            return return_(false, Error::NONE);
+fun modbus::api::Client::ReadHoldingRegisters(uint16_t register_address, uint16_t n_register) -> std::vector<uint16_t> {
+    var res = std::vector<uint16_t>(n_register);
+    res.resize(ReadHoldingRegisters(register_address, n_register, res.data()));
+    return res;
+}
 
-        return return_({}, Error::DATA_FRAME);
-    } catch (const std::out_of_range&) {
-        return return_({}, Error::TIMEOUT);
-    }
+fun modbus::api::Client::ReadInputRegisters(uint16_t register_address, uint16_t n_register) -> std::vector<uint16_t> {
+    var res = std::vector<uint16_t>(n_register);
+    res.resize(ReadInputRegisters(register_address, n_register, res.data()));
+    return res;
 }
 
-fun modbus::api::Client::WriteSingleRegister(uint16_t register_address, uint16_t value) -> uint16_t {
+fun modbus::api::Client::ReadHoldingRegisters(uint16_t register_address, uint16_t n_register, uint16_t* res) -> size_t {
+    return read_registers(READ_HOLDING_REGISTERS, register_address, n_register, res);
+}
+
+fun modbus::api::Client::ReadInputRegisters(uint16_t register_address, uint16_t n_register, uint16_t* res) -> size_t {
+    return read_registers(READ_INPUT_REGISTERS, register_address, n_register, res);
+}
+
+fun modbus::api::Client::read_registers(FunctionCode function_code, uint16_t register_address, uint16_t n_register, uint16_t* res) -> size_t {
     uint8_t req[6] = {};
-    req[0] = server_address;
-    req[1] = WRITE_SINGLE_REGISTER;
-    req[2] = (register_address >> 8) & 0xFF;
-    req[3] = (register_address >> 0) & 0xFF;
-    req[4] = (value >> 8) & 0xFF;
-    req[5] = (value >> 0) & 0xFF;
+    request_header(req, server_address, function_code, register_address, n_register);
 
-    val res = request(req);
-    val return_ = [this] (uint16_t res, Error err) { error_ = err; return std::move(res); };
+    std::lock_guard<std::mutex> lock(transactMutex);
+    val response = parse_registers(transact(req), n_register, res);
+    error_ = response.error;
+    return response.value;
+}
 
-    try {
-        if (res.size() < 4 or not std::equal(res.begin(), res.begin() + 4, req))
-            return return_({}, Error::DATA_FRAME);
-        
-        return return_(res[4] << 8 | res[5], Error::NONE);
-    } catch (const std::out_of_range&) {
-        return return_({}, Error::TIMEOUT);
-    }
+fun modbus::api::Client::WriteSingleCoil(uint16_t register_address, bool value) -> bool {
+    uint8_t req[6] = {};
+    request_header(req, server_address, WRITE_SINGLE_COIL, register_address, value ? 0xFF00 : 0x0000);
+    
+    std::lock_guard<std::mutex> lock(transactMutex);
+    val res = parse_single_coil(req, transact(req));
+    error_ = res.error;
+    return res.value;
+}
+
+fun modbus::api::Client::WriteSingleRegister(uint16_t register_address, uint16_t value) -> uint16_t {
+    uint8_t req[6] = {};
+    request_header(req, server_address, WRITE_SINGLE_REGISTER, register_address, value);
+
+    std::lock_guard<std::mutex> lock(transactMutex);
+    val res = parse_single_register(req, transact(req));
+    error_ = res.error;
+    return res.value;
 }
 
 fun modbus::api::Client::ReadExceptionStatus() -> uint8_t { 
@@ -360,14 +384,10 @@ fun modbus::api::Client::ReadExceptionStatus() -> uint8_t {
     req[0] = server_address;
     req[1] = READ_EXCEPTION_STATUS;
 
-    val res = request(req);
-    val return_ = [this] (uint8_t res, Error err) { error_ = err; return std::move(res); };
-
-    try {
-        return return_(res[3], Error::NONE);
-    } catch (const std::out_of_range&) {
-        return return_({}, Error::TIMEOUT);
-    }
+    std::lock_guard<std::mutex> lock(transactMutex);
+    val res = parse_exception_status(transact(req));
+    error_ = res.error;
+    return res.value;
 }
 
 fun modbus::api::Client::Diagnostic(uint8_t sub_function) -> std::vector<uint8_t> {
@@ -376,79 +396,323 @@ fun modbus::api::Client::Diagnostic(uint8_t sub_function) -> std::vector<uint8_t
     req[1] = DIAGNOSTIC;
     req[2] = sub_function;
 
-    val res = request(req);
-    val return_ = [this] (std::vector<uint8_t> res, Error err) { error_ = err; return res; };
-
-    if (res.size() < 2)
-        return return_({}, Error::TIMEOUT);
-    
-    return return_({res.begin() + 2, res.end()}, Error::NONE);
+    std::lock_guard<std::mutex> lock(transactMutex);
+    var res = parse_diagnostic(transact(req));
+    error_ = res.error;
+    return std::move(res.value);
 }
 
 fun modbus::api::Client::WriteMultipleCoils(uint16_t register_address, uint16_t n_register, const std::vector<bool>& values) -> void {
-    int byte_count = values.size() / 8 + 1;
-    var req = std::vector<uint8_t>();
-    req.reserve(7 + byte_count);
-    req.push_back(server_address);
-    req.push_back(WRITE_MULTIPLE_COILS);
-    req.push_back((register_address >> 8) & 0xFF);
-    req.push_back((register_address >> 0) & 0xFF);
-    req.push_back((n_register >> 8) & 0xFF);
-    req.push_back((n_register >> 0) & 0xFF);
-    req.push_back(byte_count);
+    val req = write_multiple_coils_request(server_address, register_address, n_register, values);
+    std::lock_guard<std::mutex> lock(transactMutex);
+    error_ = parse_write_multiple(req.data(), transact(req)).error;
+}
 
-    uint8_t byte = 0;
-    int cnt = 0;
-    for (val bit in values) {
-        byte |= bit << cnt++;
-        if (cnt == 8) {
-            req.push_back(byte);
-            cnt = 0;
-        }
+fun modbus::api::Client::WriteMultipleRegisters(uint16_t register_address, uint16_t n_register, const std::vector<uint16_t>& values) -> void {
+    val req = write_multiple_registers_request(server_address, register_address, n_register, values);
+    std::lock_guard<std::mutex> lock(transactMutex);
+    error_ = parse_write_multiple(req.data(), transact(req)).error;
+}
+
+fun modbus::api::Client::Read(const ReadPlan& plan) -> ReadPlan::Result {
+    var res = ReadPlan::Result();
+    val bits = [] (std::vector<bool> values) { return std::vector<uint16_t>(values.begin(), values.end()); };
+
+    for (val& t in plan.transactions()) {
+        val address = t.register_address;
+        val n = t.n_register;
+        var values = 
+            t.function_code == READ_COILS ? bits(ReadCoils(address, n)) :
+            t.function_code == READ_DISCRETE_INPUTS ? bits(ReadDiscreteInputs(address, n)) :
+            t.function_code == READ_HOLDING_REGISTERS ? ReadHoldingRegisters(address, n) :
+            ReadInputRegisters(address, n);
+        res.set(t, std::move(values), error_);
     }
-    if (cnt > 0 && cnt < 8) {
-        req.push_back(byte);
+
+    error_ = res.error();
+    return res;
+}
+
+/// Future of a callback form, completed with TIMEOUT if the call isn't queued
+template <typename T, typename Call>
+fun static future_of(Call call) -> std::future<modbus::api::Response<T>> {
+    var promise = std::make_shared<std::promise<modbus::api::Response<T>>>();
+    var res = promise->get_future();
+    if (not call([promise] (modbus::api::Response<T> response) { promise->set_value(std::move(response)); }))
+        promise->set_value({T{}, modbus::Error::TIMEOUT});
+
+    return res;
+}
+
+fun modbus::api::Client::ReadCoilsAsync(uint16_t register_address, uint16_t n_register, Deadline deadline, Callback<std::vector<bool>> callback) -> bool {
+    var req = std::vector<uint8_t>(6);
+    request_header(req.data(), server_address, READ_COILS, register_address, n_register);
+    return transactAsync(std::move(req), deadline, [callback = std::move(callback)] (byte_view res) { callback(parse_bits(res)); });
+}
+
+fun modbus::api::Client::ReadDiscreteInputsAsync(uint16_t register_address, uint16_t n_register, Deadline deadline, Callback<std::vector<bool>> callback) -> bool {
+    var req = std::vector<uint8_t>(6);
+    request_header(req.data(), server_address, READ_DISCRETE_INPUTS, register_address, n_register);
+    return transactAsync(std::move(req), deadline, [callback = std::move(callback)] (byte_view res) { callback(parse_bits(res)); });
+}
+
+fun modbus::api::Client::ReadHoldingRegistersAsync(uint16_t register_address, uint16_t n_register, Deadline deadline, Callback<std::vector<uint16_t>> callback) -> bool {
+    var req = std::vector<uint8_t>(6);
+    request_header(req.data(), server_address, READ_HOLDING_REGISTERS, register_address, n_register);
+    return transactAsync(std::move(req), deadline, [n_register, callback = std::move(callback)] (byte_view res) {
+        var values = std::vector<uint16_t>(n_register);
+        val response = parse_registers(res, n_register, values.data());
+        values.resize(response.value);
+        callback({std::move(values), response.error});
+    });
+}
+
+fun modbus::api::Client::ReadInputRegistersAsync(uint16_t register_address, uint16_t n_register, Deadline deadline, Callback<std::vector<uint16_t>> callback) -> bool {
+    var req = std::vector<uint8_t>(6);
+    request_header(req.data(), server_address, READ_INPUT_REGISTERS, register_address, n_register);
+    return transactAsync(std::move(req), deadline, [n_register, callback = std::move(callback)] (byte_view res) {
+        var values = std::vector<uint16_t>(n_register);
+        val response = parse_registers(res, n_register, values.data());
+        values.resize(response.value);
+        callback({std::move(values), response.error});
+    });
+}
+
+fun modbus::api::Client::WriteSingleCoilAsync(uint16_t register_address, bool value, Deadline deadline, Callback<bool> callback) -> bool {
+    var req = std::vector<uint8_t>(6);
+    request_header(req.data(), server_address, WRITE_SINGLE_COIL, register_address, value ? 0xFF00 : 0x0000);
+    return transactAsync(req, deadline, [req, callback = std::move(callback)] (byte_view res) { callback(parse_single_coil(req.data(), res)); });
+}
+
+fun modbus::api::Client::WriteSingleRegisterAsync(uint16_t register_address, uint16_t value, Deadline deadline, Callback<uint16_t> callback) -> bool {
+    var req = std::vector<uint8_t>(6);
+    request_header(req.data(), server_address, WRITE_SINGLE_REGISTER, register_address, value);
+    return transactAsync(req, deadline, [req, callback = std::move(callback)] (byte_view res) { callback(parse_single_register(req.data(), res)); });
+}
+
+fun modbus::api::Client::WriteMultipleCoilsAsync(uint16_t register_address, uint16_t n_register, const std::vector<bool>& values, Deadline deadline, Callback<bool> callback) -> bool {
+    var req = write_multiple_coils_request(server_address, register_address, n_register, values);
+    var header = std::vector<uint8_t>(req.begin(), req.begin() + 6);
+    return transactAsync(std::move(req), deadline, [header = std::move(header), callback = std::move(callback)] (byte_view res) {
+        callback(parse_write_multiple(header.data(), res));
+    });
+}
+
+fun modbus::api::Client::WriteMultipleRegistersAsync(uint16_t register_address, uint16_t n_register, const std::vector<uint16_t>& values, Deadline deadline, Callback<bool> callback) -> bool {
+    var req = write_multiple_registers_request(server_address, register_address, n_register, values);
+    var header = std::vector<uint8_t>(req.begin(), req.begin() + 6);
+    return transactAsync(std::move(req), deadline, [header = std::move(header), callback = std::move(callback)] (byte_view res) {
+        callback(parse_write_multiple(header.data(), res));
+    });
+}
+
+fun modbus::api::Client::ReadExceptionStatusAsync(Deadline deadline, Callback<uint8_t> callback) -> bool {
+    var req = std::vector<uint8_t>({uint8_t(server_address), READ_EXCEPTION_STATUS});
+    return transactAsync(std::move(req), deadline, [callback = std::move(callback)] (byte_view res) { callback(parse_exception_status(res)); });
+}
+
+fun modbus::api::Client::DiagnosticAsync(uint8_t sub_function, Deadline deadline, Callback<std::vector<uint8_t>> callback) -> bool {
+    var req = std::vector<uint8_t>({uint8_t(server_address), DIAGNOSTIC, sub_function});
+    return transactAsync(std::move(req), deadline, [callback = std::move(callback)] (byte_view res) { callback(parse_diagnostic(res)); });
+}
+
+/// Responses of the transactions of a plan read asynchronously, the callback gets the result with the last one
+struct PlanReads {
+    std::vector<modbus::api::ReadPlan::Transaction> transactions;
+    modbus::api::Client::Callback<modbus::api::ReadPlan::Result> callback;
+    std::mutex mtx;
+    std::vector<modbus::api::Response<std::vector<uint16_t>>> responses;
+    size_t remaining;
+
+    void complete(size_t i, modbus::api::Response<std::vector<uint16_t>> response) {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            responses[i] = std::move(response);
+            if (--remaining > 0)
+                return;
+        }
+
+        var res = modbus::api::ReadPlan::Result();
+        for (val k in etl::range(transactions.size()))
+            res.set(transactions[k], std::move(responses[k].value), responses[k].error);
+
+        val error = res.error();
+        callback({std::move(res), error});
+    }
+};
+
+fun modbus::api::Client::ReadAsync(const ReadPlan& plan, Deadline deadline, Callback<ReadPlan::Result> callback) -> bool {
+    val& transactions = plan.transactions();
+    if (transactions.empty()) {
+        callback({ReadPlan::Result(), Error::NONE});
+        return true;
+    }
+
+    var reads = std::make_shared<PlanReads>();
+    reads->transactions = transactions;
+    reads->callback = std::move(callback);
+    reads->responses.resize(transactions.size());
+    reads->remaining = transactions.size();
+
+    // all of them are queued at once, with MBAP they are in flight together
+    for (val i in etl::range(transactions.size())) {
+        val& t = transactions[i];
+        val registers = [reads, i] (Response<std::vector<uint16_t>> res) { reads->complete(i, std::move(res)); };
+        val bits = [reads, i] (Response<std::vector<bool>> res) {
+            reads->complete(i, {std::vector<uint16_t>(res.value.begin(), res.value.end()), res.error});
+        };
+        val queued = 
+            t.function_code == READ_COILS ? ReadCoilsAsync(t.register_address, t.n_register, deadline, bits) :
+            t.function_code == READ_DISCRETE_INPUTS ? ReadDiscreteInputsAsync(t.register_address, t.n_register, deadline, bits) :
+            t.function_code == READ_HOLDING_REGISTERS ? ReadHoldingRegistersAsync(t.register_address, t.n_register, deadline, registers) :
+            ReadInputRegistersAsync(t.register_address, t.n_register, deadline, registers);
+
+        // the first one decides, a later one that isn't queued times out in the result
+        if (not queued and i == 0)
+            return false;
+        if (not queued)
+            reads->complete(i, {{}, Error::TIMEOUT});
+    }
+    return true;
+}
+
+fun modbus::api::Client::ReadCoilsAsync(uint16_t register_address, uint16_t n_register, Deadline deadline) -> std::future<Response<std::vector<bool>>> {
+    return future_of<std::vector<bool>>([&] (Callback<std::vector<bool>> callback) {
+        return ReadCoilsAsync(register_address, n_register, deadline, std::move(callback));
+    });
+}
+
+fun modbus::api::Client::ReadDiscreteInputsAsync(uint16_t register_address, uint16_t n_register, Deadline deadline) -> std::future<Response<std::vector<bool>>> {
+    return future_of<std::vector<bool>>([&] (Callback<std::vector<bool>> callback) {
+        return ReadDiscreteInputsAsync(register_address, n_register, deadline, std::move(callback));
+    });
+}
+
+fun modbus::api::Client::ReadHoldingRegistersAsync(uint16_t register_address, uint16_t n_register, Deadline deadline) -> std::future<Response<std::vector<uint16_t>>> {
+    return future_of<std::vector<uint16_t>>([&] (Callback<std::vector<uint16_t>> callback) {
+        return ReadHoldingRegistersAsync(register_address, n_register, deadline, std::move(callback));
+    });
+}
+
+fun modbus::api::Client::ReadInputRegistersAsync(uint16_t register_address, uint16_t n_register, Deadline deadline) -> std::future<Response<std::vector<uint16_t>>> {
+    return future_of<std::vector<uint16_t>>([&] (Callback<std::vector<uint16_t>> callback) {
+        return ReadInputRegistersAsync(register_address, n_register, deadline, std::move(callback));
+    });
+}
+
+fun modbus::api::Client::WriteSingleCoilAsync(uint16_t register_address, bool value, Deadline deadline) -> std::future<Response<bool>> {
+    return future_of<bool>([&] (Callback<bool> callback) {
+        return WriteSingleCoilAsync(register_address, value, deadline, std::move(callback));
+    });
+}
+
+fun modbus::api::Client::WriteSingleRegisterAsync(uint16_t register_address, uint16_t value, Deadline deadline) -> std::future<Response<uint16_t>> {
+    return future_of<uint16_t>([&] (Callback<uint16_t> callback) {
+        return WriteSingleRegisterAsync(register_address, value, deadline, std::move(callback));
+    });
+}
+
+fun modbus::api::Client::WriteMultipleCoilsAsync(uint16_t register_address, uint16_t n_register, const std::vector<bool>& values, Deadline deadline) -> std::future<Response<bool>> {
+    return future_of<bool>([&] (Callback<bool> callback) {
+        return WriteMultipleCoilsAsync(register_address, n_register, values, deadline, std::move(callback));
+    });
+}
+
+fun modbus::api::Client::WriteMultipleRegistersAsync(uint16_t register_address, uint16_t n_register, const std::vector<uint16_t>& values, Deadline deadline) -> std::future<Response<bool>> {
+    return future_of<bool>([&] (Callback<bool> callback) {
+        return WriteMultipleRegistersAsync(register_address, n_register, values, deadline, std::move(callback));
+    });
+}
+
+fun modbus::api::Client::ReadExceptionStatusAsync(Deadline deadline) -> std::future<Response<uint8_t>> {
+    return future_of<uint8_t>([&] (Callback<uint8_t> callback) {
+        return ReadExceptionStatusAsync(deadline, std::move(callback));
+    });
+}
+
+fun modbus::api::Client::DiagnosticAsync(uint8_t sub_function, Deadline deadline) -> std::future<Response<std::vector<uint8_t>>> {
+    return future_of<std::vector<uint8_t>>([&] (Callback<std::vector<uint8_t>> callback) {
+        return DiagnosticAsync(sub_function, deadline, std::move(callback));
+    });
+}
+
+fun modbus::api::Client::ReadAsync(const ReadPlan& plan, Deadline deadline) -> std::future<Response<ReadPlan::Result>> {
+    return future_of<ReadPlan::Result>([&] (Callback<ReadPlan::Result> callback) {
+        return ReadAsync(plan, deadline, std::move(callback));
+    });
+}
+
+/// Completes an asynchronous transaction when its task goes, also when a dispatcher drops it unrun
+struct AsyncCompletion {
+    std::function<void(byte_view)> done;
+    std::function<void()> finish;
+
+    ~AsyncCompletion() {
+        if (done)
+            done({});
+        finish();
     }
-    
-    val res = request(req);
-    val return_ = [this] (Error err) { error_ = err; };
+};
 
-    if (res.size() < 6)
-        return return_(Error::TIMEOUT);
-    
-    if (not std::equal(res.begin(), res.begin() + 6, req.begin()))
-        return return_(Error::DATA_FRAME);
-    
-    return return_(Error::NONE);
+fun modbus::api::Client::transactAsync(std::vector<uint8_t> request, Deadline deadline, std::function<void(byte_view)> done) -> bool {
+    // the priority of the caller's scope goes along to the worker
+    return dispatchAsync([this, request = std::move(request), deadline, priority = serial::Arbiter::Scope::priority()] {
+        val scope = serial::Arbiter::Scope(priority);
+        std::lock_guard<std::mutex> lock(transactMutex);
+
+        // past its deadline in the queue, the request isn't sent
+        if (asyncStopped or std::chrono::steady_clock::now() >= deadline)
+            return byte_view();
+
+        // the response is copied out of the frame buffers, the callback may make a blocking call of this client
+        var res = transactUntil(request, deadline).copy();
+        return std::chrono::steady_clock::now() > deadline ? byte_view() : res;
+    }, std::move(done));
 }
 
-fun modbus::api::Client::WriteMultipleRegisters(uint16_t register_address, uint16_t n_register, const std::vector<uint16_t>& values) -> void {
-    int byte_count = values.size() * 2;
-    var req = std::vector<uint8_t>();
-    req.reserve(7 + byte_count);
-    req.push_back(server_address);
-    req.push_back(WRITE_MULTIPLE_REGISTERS);
-    req.push_back((register_address >> 8) & 0xFF);
-    req.push_back((register_address >> 0) & 0xFF);
-    req.push_back((n_register >> 8) & 0xFF);
-    req.push_back((n_register >> 0) & 0xFF);
-    req.push_back(byte_count);
+fun modbus::api::Client::dispatchAsync(std::function<byte_view()> work, std::function<void(byte_view)> done) -> bool {
+    var dispatcher = std::shared_ptr<serial::Dispatcher>();
+    {
+        std::lock_guard<std::mutex> lock(asyncMutex);
+        if (asyncStopped)
+            return false;
 
-    for (val reg in values) {
-        req.push_back((reg >> 8) & 0xFF);
-        req.push_back((reg >> 0) & 0xFF);
+        if (not dispatcher_)
+            dispatcher_ = defaultDispatcher();
+
+        dispatcher = dispatcher_;
+        ++asyncPending;
     }
-    
-    val res = request(req);
-    val return_ = [this] (Error err) { error_ = err; };
 
-    if (res.size() < 6)
-        return return_(Error::TIMEOUT);
-    
-    if (not std::equal(res.begin(), res.begin() + 6, req.begin()))
-        return return_(Error::DATA_FRAME);
-    
-    return return_(Error::NONE);
+    var completion = std::make_shared<AsyncCompletion>();
+    completion->done = std::move(done);
+    completion->finish = [this] {
+        std::lock_guard<std::mutex> lock(asyncMutex);
+        if (--asyncPending == 0)
+            asyncIdle.notify_all();
+    };
+
+    val queued = dispatcher->dispatch([completion, work = std::move(work)] {
+        val res = work();
+        std::exchange(completion->done, nullptr)(res);
+    });
+
+    // refused, the callback isn't called, finish runs when the last reference goes
+    if (not queued)
+        completion->done = nullptr;
+
+    return queued;
+}
+
+fun modbus::api::Client::defaultDispatcher() -> std::shared_ptr<serial::Dispatcher> {
+    // a full queue refuses the transaction instead of blocking
+    return std::make_shared<serial::Dispatcher>(1, 256, serial::Dispatcher::DROP_NEWEST);
+}
+
+fun modbus::api::Client::stopAsync() -> void {
+    std::unique_lock<std::mutex> lock(asyncMutex);
+    asyncStopped = true;
+    asyncIdle.wait(lock, [this] { return asyncPending == 0; });
 }
 
 extern "C" {
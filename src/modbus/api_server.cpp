@@ -94,7 +94,9 @@ fun modbus::api::Server::DiagnosticGetter(uint8_t sub_function, std::function<st
     return *this;
 }
 
-fun modbus::api::Server::process_callback(nexus::byte_view buffer) const -> std::vector<uint8_t> {
+fun modbus::api::Server::process_callback(nexus::byte_view request) const -> std::vector<uint8_t> {
+    // the callbacks only read the request, a view spares sharing the bytes of an owning one
+    val buffer = nexus::byte_view{request.data(), request.len()};
     if (buffer.len() < 2)
         return {};
     
@@ -0,0 +1,36 @@
+#include "nexus/modbus/loopback/client.h"
+#include <etl/keywords.h>
+
+using namespace nexus;
+
+fun modbus::loopback::Client::request(byte_view buffer) -> byte_view {
+    // the caller may keep the response, it gets its own copy
+    std::lock_guard<std::mutex> lock(transactMutex);
+    return transact(buffer).copy();
+}
+
+fun modbus::loopback::Client::transact(byte_view buffer) -> byte_view {
+    return transactUntil(buffer, Deadline::max());
+}
+
+fun modbus::loopback::Client::transactUntil(byte_view buffer, Deadline until) -> byte_view {
+    // a late response to an earlier request is not the answer
+    val fc = buffer.len() > 1 ? buffer[1] : 0;
+    if (cli.getSerial()->send(buffer) < 0)
+        return {};
+
+    val filter = [this, fc] (byte_view res) {
+        return res.len() >= 2 and res[0] == server_address and (res[1] & 0x7F) == fc;
+    };
+    return cli.getSerial()->receive(filter, rx, until) ? rx.view() : byte_view{};
+}
+
+extern "C" {
+    typedef void* nexus_modbus_loopback_client_t;
+    typedef void* nexus_serial_t;
+
+    nexus_modbus_loopback_client_t nexus_modbus_loopback_client_new(int server_address, nexus_serial_t end) {
+        val serial = dynamic_cast<nexus::loopback::Serial*>(static_cast<abstract::Serial*>(end));
+        return new modbus::loopback::Client(server_address, std::shared_ptr<nexus::loopback::Serial>(serial));
+    }
+}
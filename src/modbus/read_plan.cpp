@@ -0,0 +1,114 @@
+#include "nexus/modbus/read_plan.h"
+#include <algorithm>
+#include <etl/keywords.h>
+
+using namespace nexus;
+
+/// Protocol limit of a read request
+fun static max_registers(modbus::FunctionCode function_code) -> size_t {
+    return function_code == modbus::READ_COILS or function_code == modbus::READ_DISCRETE_INPUTS ? 2000 : 125;
+}
+
+fun modbus::api::ReadPlan::add(FunctionCode function_code, uint16_t register_address, uint16_t n_register) -> ReadPlan& {
+    if (n_register > 0) {
+        ranges.push_back({function_code, register_address, n_register});
+        plan();
+    }
+    return *this;
+}
+
+fun modbus::api::ReadPlan::plan() -> void {
+    var sorted = ranges;
+    std::sort(sorted.begin(), sorted.end(), [] (const Transaction& a, const Transaction& b) {
+        return a.function_code != b.function_code ? a.function_code < b.function_code : a.register_address < b.register_address;
+    });
+
+    // union of the ranges of each table, end exclusive
+    struct Needed { FunctionCode function_code; size_t begin; size_t end; };
+    var needed = std::vector<Needed>();
+    for (val& range in sorted) {
+        val begin = size_t(range.register_address);
+        val end = std::min(begin + range.n_register, size_t(0x10000));
+        if (not needed.empty() and needed.back().function_code == range.function_code and begin <= needed.back().end)
+            needed.back().end = std::max(needed.back().end, end);
+        else
+            needed.push_back({range.function_code, begin, end});
+    }
+
+    // a transaction starts at the first register not read yet and takes the next ranges while their gap is small enough
+    // and they fit, a range longer than the limit is split. Starting each at the first unread register is the fewest transactions
+    transactions_.clear();
+    var i = size_t(0);
+    var pos = needed.empty() ? size_t(0) : needed[0].begin;
+    while (i < needed.size()) {
+        val function_code = needed[i].function_code;
+        val begin = pos;
+        val limit = begin + max_registers(function_code);
+        var end = begin;
+
+        while (i < needed.size() and needed[i].function_code == function_code) {
+            val next = std::max(needed[i].begin, pos);
+            if (end > begin and next - end > gap)
+                break;
+            if (needed[i].end <= limit) {
+                end = needed[i].end;
+                if (++i < needed.size())
+                    pos = needed[i].begin;
+                continue;
+            }
+            if (next < limit)
+                pos = end = limit;
+            break;
+        }
+
+        transactions_.push_back({function_code, uint16_t(begin), uint16_t(end - begin)});
+    }
+}
+
+fun modbus::api::ReadPlan::Result::set(const Transaction& transaction, std::vector<uint16_t> values, Error err) -> void {
+    if (err != Error::NONE or values.size() < transaction.n_register)
+        values.clear();
+    if (error_ == Error::NONE)
+        error_ = err == Error::NONE and values.empty() ? Error::DATA_FRAME : err;
+    reads.push_back({transaction, std::move(values)});
+}
+
+fun modbus::api::ReadPlan::Result::values(FunctionCode function_code, uint16_t register_address, uint16_t n_register) const -> std::vector<uint16_t> {
+    var res = std::vector<uint16_t>();
+    res.reserve(n_register);
+
+    // a range is in one read unless it was split at the protocol limit
+    for (var address = size_t(register_address); address < size_t(register_address) + n_register;) {
+        val it = std::find_if(reads.begin(), reads.end(), [function_code, address] (const Read& read) {
+            val& t = read.transaction;
+            return t.function_code == function_code and t.register_address <= address and address < size_t(t.register_address) + t.n_register;
+        });
+        if (it == reads.end() or it->values.empty())
+            return {};
+
+        val& t = it->transaction;
+        val end = std::min(size_t(register_address) + n_register, size_t(t.register_address) + t.n_register);
+        res.insert(res.end(), it->values.begin() + (address - t.register_address), it->values.begin() + (end - t.register_address));
+        address = end;
+    }
+
+    return res;
+}
+
+fun modbus::api::ReadPlan::Result::Coils(uint16_t register_address, uint16_t n_register) const -> std::vector<bool> {
+    val res = values(READ_COILS, register_address, n_register);
+    return {res.begin(), res.end()};
+}
+
+fun modbus::api::ReadPlan::Result::DiscreteInputs(uint16_t register_address, uint16_t n_register) const -> std::vector<bool> {
+    val res = values(READ_DISCRETE_INPUTS, register_address, n_register);
+    return {res.begin(), res.end()};
+}
+
+fun modbus::api::ReadPlan::Result::HoldingRegisters(uint16_t register_address, uint16_t n_register) const -> std::vector<uint16_t> {
+    return values(READ_HOLDING_REGISTERS, register_address, n_register);
+}
+
+fun modbus::api::ReadPlan::Result::InputRegisters(uint16_t register_address, uint16_t n_register) const -> std::vector<uint16_t> {
+    return values(READ_INPUT_REGISTERS, register_address, n_register);
+}
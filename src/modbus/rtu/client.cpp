@@ -1,4 +1,5 @@
 #include "nexus/modbus/rtu/client.h"
+#include "nexus/tools/json.h"
 #include <etl/keywords.h>
 
 using namespace nexus;
@@ -6,19 +7,53 @@ using namespace nexus;
 modbus::rtu::Client::Client(Args args) 
     : api::Client(args.server_address)
     , serial::Hardware::Interface(std::make_shared<serial::Hardware>(args.port, args.speed, args.timeout, std::make_shared<api::Codec>())) 
-{}
+{
+    ser_->setArbiter(std::make_shared<serial::Arbiter>(serial::Hardware::t35(args.speed)));
+}
 
 modbus::rtu::Client::Client(int server_address, std::shared_ptr<serial::Hardware> ser) 
     : modbus::api::Client(server_address)
     , serial::Hardware::Interface(ser, std::make_shared<api::Codec>())
-{}
+{
+    // the clients of the line share its arbiter
+    if (not ser_->getArbiter())
+        ser_->setArbiter(std::make_shared<serial::Arbiter>(serial::Hardware::t35(ser_->speed)));
+}
+
+fun modbus::rtu::Client::json() const -> std::string {
+    val arbiter = ser_->getArbiter();
+    return tools::json_concat(api::Client::json(), "{"
+        "\"arbiter\": " + (arbiter ? arbiter->json() : "null") +
+    "}");
+}
 
 fun modbus::rtu::Client::request(byte_view buffer) -> byte_view {
+    return transactUntil(buffer, Deadline::max());
+}
+
+fun modbus::rtu::Client::transactUntil(byte_view buffer, Deadline until) -> byte_view {
+    // the line is ours until the response is in or timed out, an expired transaction leaves the queue
+    val arbiter = ser_->getArbiter();
+    val slot = arbiter ? arbiter->acquire(serial::Arbiter::Scope::priority(), until) : serial::Arbiter::Slot();
+    if ((arbiter and not slot) or std::chrono::steady_clock::now() >= until)
+        return {};
+
+    // frames queued before the request can't be its response
+    val after = ser_->sequence(codec_);
+    val fc = buffer.len() > 1 ? buffer[1] : 0;
+
     ser_->sendCodec(codec_, buffer);
-    return ser_->receiveCodec(codec_, [this] (byte_view received_buffer) { return received_buffer[0] == server_address; });
+    var res = ser_->receiveMessages(codec_, [this, fc] (byte_view received_buffer) { 
+        return received_buffer.len() >= 2 and received_buffer[0] == server_address and (received_buffer[1] & 0x7F) == fc; 
+    }, 1, after, until);
+
+    return res.empty() ? byte_view{} : std::move(res[0].data);
 }
 
-modbus::rtu::Client::~Client() {}
+modbus::rtu::Client::~Client() {
+    // queued transactions must not reach the line once it goes
+    stopAsync();
+}
 
 extern "C" {
     typedef void* nexus_modbus_rtu_client_t;
@@ -53,7 +53,33 @@ bool modbus::rtu::Server::listen(std::shared_ptr<serial::Hardware> ser) {
     is_running = true;
     while (is_running and iface.getSerialHardware()->isConnected()) {
         std::unique_lock<std::mutex> lock(mtx);
-        cv.wait_for(lock, ser->timeout, [this] { return not is_running; });
+        cv.wait_for(lock, ser->timeout.load(), [this] { return not is_running; });
+    }
+
+    auto res = not is_running;
+    is_running = false;
+    return res;
+}
+
+bool modbus::rtu::Server::serve(std::shared_ptr<abstract::Serial> ser) {
+    if (is_running) 
+        return false;
+
+    is_running = true;
+    while (is_running and ser->isConnected()) {
+        auto req = ser->receive();
+        if (req.empty())
+            continue;
+
+        // a view, a copy of the received frame would share its bytes through a heap allocation
+        var res = process_callback(byte_view{req.data(), req.len()});
+        if (res.empty())
+            continue;
+
+        if (logger_)
+            logger_(req, res);
+
+        ser->send(res);
     }
 
     auto res = not is_running;
@@ -0,0 +1,33 @@
+#include "nexus/modbus/rtu/simulator.h"
+#include "nexus/tools/json.h"
+#include <etl/keywords.h>
+
+using namespace nexus;
+
+modbus::rtu::Simulator::Simulator(int server_address) 
+    : api::Server(server_address)
+    , serial::Simulator(std::make_shared<api::Codec>(), [this] (byte_view request) { return process_callback(request); }, false) 
+{
+    // the responder calls into this object, the device thread runs only while it's whole
+    start();
+}
+
+modbus::rtu::Simulator::~Simulator() {
+    stop();
+}
+
+fun modbus::rtu::Simulator::json() const -> std::string {
+    return tools::json_concat(api::Server::json(), serial::Simulator::json());
+}
+
+extern "C" {
+    typedef void* nexus_modbus_rtu_simulator_t;
+
+    nexus_modbus_rtu_simulator_t nexus_modbus_rtu_simulator_new(int server_address) {
+        return new modbus::rtu::Simulator(server_address);
+    }
+
+    const char* nexus_modbus_rtu_simulator_port(nexus_modbus_rtu_simulator_t sim) {
+        return static_cast<modbus::rtu::Simulator*>(sim)->port().c_str();
+    }
+}
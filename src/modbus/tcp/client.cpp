@@ -1,12 +1,290 @@
 #include "nexus/modbus/tcp/client.h"
+#include <algorithm>
+#include <cstring>
+#include <optional>
 #include <etl/keywords.h>
 
 using namespace nexus;
 
+/// Transaction id, protocol id 0, length of the unit id and pdu that follow
+static constexpr size_t MBAP_HEADER = 6;
+
+fun static mbap_header(uint8_t* header, uint16_t transaction, size_t length) -> void {
+    header[0] = (transaction >> 8) & 0xFF;
+    header[1] = (transaction >> 0) & 0xFF;
+    header[2] = 0;
+    header[3] = 0;
+    header[4] = (length >> 8) & 0xFF;
+    header[5] = (length >> 0) & 0xFF;
+}
+
+modbus::tcp::Client::~Client() {
+    stopAsync();
+    {
+        std::lock_guard<std::mutex> lock(inFlightMutex);
+        closing = true;
+    }
+    inFlightAdded.notify_all();
+    if (reader.joinable())
+        reader.join();
+
+    // the transactions still in flight won't be answered any more
+    for (var& [id, t] in inFlight)
+        t.done({});
+}
+
 fun modbus::tcp::Client::request(byte_view buffer) -> byte_view {
-    val codec = api::Codec();
-    var res = cli.request(codec.encode(buffer));
-    return codec.decode(res);
+    // the caller may keep the response, it gets its own copy
+    std::lock_guard<std::mutex> lock(transactMutex);
+    return transact(buffer).copy();
+}
+
+fun modbus::tcp::Client::transact(byte_view buffer) -> byte_view {
+    return transactUntil(buffer, Deadline::max());
+}
+
+fun modbus::tcp::Client::transactUntil(byte_view buffer, Deadline until) -> byte_view {
+    val now = std::chrono::steady_clock::now();
+    if (protocol_ == Protocol::RTU) {
+        val left = std::min(timeout, std::chrono::duration_cast<std::chrono::milliseconds>(until - now));
+        if (left.count() <= 0)
+            return {};
+
+        tx.assign(buffer, codec.headroom(), codec.tailroom());
+        codec.encodeInto(tx);
+        rx.reset();
+        if (not cli.send(tx.view()) or not cli.receive(rx, left))
+            return {};
+
+        return codec.decodeView(rx.view());
+    }
+
+    val deadline = std::min(until, now + timeout);
+    std::unique_lock<std::mutex> lock(txMutex);
+    if (reader.joinable()) {
+        lock.unlock();
+        var res = submit(buffer, deadline);
+        return res.wait_until(deadline) == std::future_status::ready ? res.get() : byte_view{};
+    }
+
+    // the unit id and pdu go as they are, behind the header
+    val id = ++transaction;
+    tx.assign(buffer, MBAP_HEADER);
+    mbap_header(tx.push(MBAP_HEADER), id, buffer.len());
+    if (not cli.send(tx.view()))
+        return {};
+
+    // late responses to earlier, timed out transactions are dropped
+    while (true) {
+        val [res_id, res] = receiveMbap(deadline);
+        if (res.empty() or res_id == id)
+            return res;
+    }
+}
+
+fun modbus::tcp::Client::pipeline(const std::vector<byte_view>& requests, size_t window) -> std::vector<byte_view> {
+    var res = std::vector<byte_view>(requests.size());
+    if (protocol_ == Protocol::RTU) {
+        for (val i in etl::range(requests.size()))
+            res[i] = request(requests[i]);
+        return res;
+    }
+
+    window = std::max(window, size_t(1));
+    std::unique_lock<std::mutex> lock(txMutex);
+    if (reader.joinable()) {
+        lock.unlock();
+        var futures = std::vector<std::future<byte_view>>();
+        futures.reserve(window);
+
+        var n_received = size_t(0);
+        for (var begin = size_t(0); begin < requests.size(); begin += window) {
+            val end = std::min(begin + window, requests.size());
+            val deadline = std::chrono::steady_clock::now() + timeout;
+            for (val i in etl::range(begin, end))
+                futures.push_back(submit(requests[i], deadline));
+            for (val i in etl::range(begin, end)) {
+                var& future = futures[i - begin];
+                res[i] = future.wait_until(deadline) == std::future_status::ready ? future.get() : byte_view{};
+                n_received += not res[i].empty();
+            }
+            futures.clear();
+        }
+
+        error_ = n_received == requests.size() ? Error::NONE : Error::TIMEOUT;
+        return res;
+    }
+
+    var in_flight = std::vector<std::pair<uint16_t, size_t>>(); ///< transaction id and request index
+    in_flight.reserve(window);
+
+    var next = size_t(0);
+    var deadline = std::chrono::steady_clock::now() + timeout;
+    while (next < requests.size() or not in_flight.empty()) {
+        // refill the window, the new requests go in one send
+        if (next < requests.size() and in_flight.size() < window) {
+            tx.reset();
+            for (; next < requests.size() and in_flight.size() < window; ++next) {
+                val& req = requests[next];
+                val id = ++transaction;
+                var adu = tx.put(MBAP_HEADER + req.len());
+                mbap_header(adu, id, req.len());
+                ::memcpy(adu + MBAP_HEADER, req.data(), req.len());
+                in_flight.push_back({id, next});
+            }
+            if (not cli.send(tx.view()))
+                break;
+        }
+
+        val [id, adu] = receiveMbap(deadline);
+        if (adu.empty())
+            break;
+
+        val it = std::find_if(in_flight.begin(), in_flight.end(), [id = id] (const std::pair<uint16_t, size_t>& t) { return t.first == id; });
+        if (it == in_flight.end())
+            continue;
+
+        res[it->second] = adu.copy();
+        in_flight.erase(it);
+        deadline = std::chrono::steady_clock::now() + timeout;
+    }
+
+    error_ = next == requests.size() and in_flight.empty() ? Error::NONE : Error::TIMEOUT;
+    return res;
+}
+
+fun modbus::tcp::Client::transactAsync(std::vector<uint8_t> request, Deadline deadline, std::function<void(byte_view)> done) -> bool {
+    if (protocol_ == Protocol::RTU)
+        return api::Client::transactAsync(std::move(request), deadline, std::move(done));
+
+    // the callback goes on to the dispatcher, a blocking call in it still has the reader to answer
+    // only if the dispatcher refuses it, e.g. while the client goes, it runs on the reader
+    return sendMbap(std::move(request), deadline, [this, done = std::move(done)] (byte_view res) {
+        if (not dispatchAsync([res = res.copy()] { return res; }, done))
+            done(res);
+    });
+}
+
+fun modbus::tcp::Client::sendMbap(std::vector<uint8_t> request, Deadline deadline, std::function<void(byte_view)> done) -> bool {
+    std::lock_guard<std::mutex> lock(txMutex);
+    val id = ++transaction;
+    {
+        // registered before it is sent, the response may be in before the send returns
+        std::lock_guard<std::mutex> lock(inFlightMutex);
+        if (closing or inFlight.count(id) > 0)
+            return false;
+        inFlight[id] = {deadline, std::move(done)};
+    }
+    inFlightAdded.notify_one();
+
+    if (not reader.joinable())
+        reader = std::thread(&Client::readerWork, this);
+
+    tx.assign(byte_view{request.data(), request.size()}, MBAP_HEADER);
+    mbap_header(tx.push(MBAP_HEADER), id, request.size());
+    if (cli.send(tx.view()))
+        return true;
+
+    // not sent, unless the reader has completed it in the meantime the callback isn't called
+    std::lock_guard<std::mutex> lock_in_flight(inFlightMutex);
+    return inFlight.erase(id) == 0;
+}
+
+fun modbus::tcp::Client::submit(byte_view buffer, Deadline deadline) -> std::future<byte_view> {
+    var promise = std::make_shared<std::promise<byte_view>>();
+    var res = promise->get_future();
+    val done = [promise] (byte_view response) { promise->set_value(response.copy()); };
+    if (not sendMbap(std::vector<uint8_t>(buffer.begin(), buffer.end()), deadline, done))
+        promise->set_value({});
+
+    return res;
+}
+
+fun modbus::tcp::Client::readerWork() -> void {
+    // a receive is cut short now and then, for an earlier deadline of a new transaction and for closing
+    constexpr auto slice = std::chrono::milliseconds(10);
+
+    while (true) {
+        var deadline = Deadline::max();
+        {
+            std::unique_lock<std::mutex> lock(inFlightMutex);
+            inFlightAdded.wait(lock, [this] { return closing or not inFlight.empty(); });
+            if (closing)
+                return;
+
+            for (val& [id, t] in inFlight)
+                deadline = std::min(deadline, t.deadline);
+        }
+
+        val [id, res] = receiveMbap(std::min(deadline, std::chrono::steady_clock::now() + slice));
+        if (not res.empty()) {
+            complete(id, res);
+            continue;
+        }
+
+        // a broken connection fails everything in flight, a timeout the overdue ones
+        val broken = cli.error() != nexus::tcp::Client::NONE and cli.error() != nexus::tcp::Client::RECV_TIMEOUT;
+        val now = std::chrono::steady_clock::now();
+        while (true) {
+            var overdue = std::optional<uint16_t>();
+            {
+                std::lock_guard<std::mutex> lock(inFlightMutex);
+                val it = std::find_if(inFlight.begin(), inFlight.end(), [broken, now] (const std::pair<const uint16_t, InFlight>& t) {
+                    return broken or t.second.deadline <= now;
+                });
+                if (it != inFlight.end())
+                    overdue = it->first;
+            }
+            if (not overdue)
+                break;
+            complete(*overdue, {});
+        }
+    }
+}
+
+fun modbus::tcp::Client::complete(uint16_t id, byte_view res) -> void {
+    var done = std::function<void(byte_view)>();
+    {
+        std::lock_guard<std::mutex> lock(inFlightMutex);
+        val it = inFlight.find(id);
+        if (it == inFlight.end())
+            return;
+
+        done = std::move(it->second.done);
+        inFlight.erase(it);
+    }
+    done(res);
+}
+
+fun modbus::tcp::Client::receiveMbap(std::chrono::steady_clock::time_point deadline) -> std::pair<uint16_t, byte_view> {
+    rx.pull(received);
+    received = 0;
+
+    while (true) {
+        if (rx.len() >= MBAP_HEADER) {
+            val header = rx.data();
+            val length = size_t(header[4] << 8 | header[5]);
+            if (header[2] != 0 or header[3] != 0 or length < 2) {
+                // not a response of this protocol, the stream can't be followed any further
+                rx.reset();
+                continue;
+            }
+            if (rx.len() >= MBAP_HEADER + length) {
+                received = MBAP_HEADER + length;
+                return {uint16_t(header[0] << 8 | header[1]), byte_view{header + MBAP_HEADER, length}};
+            }
+        }
+
+        // keep the pending bytes at the front, the tailroom takes the next ones
+        if (rx.empty())
+            rx.reset();
+        elif (rx.headroom() > rx.len())
+            rx.assign(rx.view());
+
+        val remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+        if (remaining.count() <= 0 or not cli.receive(rx, remaining))
+            return {};
+    }
 }
 
 extern "C" {
@@ -15,4 +293,8 @@ extern "C" {
     nexus_modbus_tcp_client_t nexus_modbus_tcp_client_new(const char* host, int port) {
         return new modbus::tcp::Client(host, port);
     }
-}
\ No newline at end of file
+
+    nexus_modbus_tcp_client_t nexus_modbus_tcp_client_new_mbap(const char* host, int port, int unit_id, int timeout) {
+        return new modbus::tcp::Client({host, port, std::chrono::milliseconds(timeout), modbus::tcp::Protocol::MBAP, unit_id});
+    }
+}
@@ -1,17 +1,55 @@
 #include "nexus/modbus/tcp/server.h"
+#include <cstring>
 #include <etl/keywords.h>
 
 using namespace nexus;
 
+/// Transaction id, protocol id 0, length of the unit id and pdu that follow
+static constexpr size_t MBAP_HEADER = 6;
+
 modbus::tcp::Server::Server() : modbus::api::Server(0xFF) {
     this->addCallback([this] (byte_view buffer) -> std::vector<uint8_t> {
+        // RTU over TCP: the server address and a valid crc
         val codec = modbus::api::Codec();
-        val res = codec.decode(buffer);
-        var ret = process_callback(res);
-        return codec.encode(ret);
+        if (buffer.len() > 0 and buffer[0] == server_address) {
+            val req = codec.decodeView(buffer);
+            if (not req.empty()) {
+                var ret = process_callback(req);
+                return codec.encode(ret);
+            }
+        }
+
+        // Modbus TCP: MBAP frames, several of them if the client pipelines its requests
+        return process_mbap(buffer);
     });
 }
 
+fun modbus::tcp::Server::process_mbap(byte_view buffer) const -> std::vector<uint8_t> {
+    var res = std::vector<uint8_t>();
+    uint8_t req[256];
+
+    for (var offset = size_t(0); offset + MBAP_HEADER + 2 <= buffer.len();) {
+        val adu = buffer.data() + offset;
+        val length = size_t(adu[4] << 8 | adu[5]);
+        if (adu[2] != 0 or adu[3] != 0 or length < 2 or length > sizeof(req) or offset + MBAP_HEADER + length > buffer.len())
+            break;
+
+        // any unit id is served, the response echoes it
+        req[0] = server_address;
+        ::memcpy(req + 1, adu + MBAP_HEADER + 1, length - 1);
+        val pdu = process_callback(byte_view{req, length});
+
+        if (not pdu.empty()) {
+            uint8_t header[MBAP_HEADER + 1] = {adu[0], adu[1], 0, 0, uint8_t(pdu.size() >> 8), uint8_t(pdu.size()), adu[MBAP_HEADER]};
+            res.insert(res.end(), header, header + sizeof(header));
+            res.insert(res.end(), pdu.begin() + 1, pdu.end());
+        }
+        offset += MBAP_HEADER + length;
+    }
+
+    return res;
+}
+
 extern "C" {
     typedef void* nexus_modbus_tcp_server_t;
 
@@ -0,0 +1,131 @@
+#include "nexus/serial/arbiter.h"
+#include "nexus/tools/to_string.h"
+#include <algorithm>
+#include <memory>
+#include <etl/keywords.h>
+
+using namespace nexus;
+
+static thread_local int scopedPriority = serial::Arbiter::NORMAL;
+
+serial::Arbiter::Scope::Scope(int priority) : previous(scopedPriority) {
+    scopedPriority = priority;
+}
+
+serial::Arbiter::Scope::~Scope() {
+    scopedPriority = previous;
+}
+
+fun serial::Arbiter::Scope::priority() -> int {
+    return scopedPriority;
+}
+
+fun serial::Arbiter::Slot::operator=(Slot&& other) noexcept -> Slot& {
+    if (this != &other) {
+        if (arbiter)
+            arbiter->release();
+        arbiter = std::exchange(other.arbiter, nullptr);
+    }
+    return *this;
+}
+
+serial::Arbiter::Slot::~Slot() {
+    if (arbiter)
+        arbiter->release();
+}
+
+serial::Arbiter::Arbiter(std::chrono::microseconds gap) : gap(std::max(gap, std::chrono::microseconds(0))) {}
+
+fun serial::Arbiter::acquire() -> Slot {
+    return acquire(scopedPriority);
+}
+
+fun serial::Arbiter::acquire(int priority) -> Slot {
+    return acquire(priority, std::chrono::steady_clock::time_point::max());
+}
+
+fun serial::Arbiter::acquire(int priority, std::chrono::steady_clock::time_point until) -> Slot {
+    std::unique_lock<std::mutex> lock(mtx);
+    val start = std::chrono::steady_clock::now();
+    val ticket = std::make_pair(-priority, ++tickets);
+    waiting.insert(ticket);
+
+    val forever = until == std::chrono::steady_clock::time_point::max();
+    while (true) {
+        if (not forever and std::chrono::steady_clock::now() >= until) {
+            // the next one in line may be waiting behind this ticket
+            waiting.erase(ticket);
+            lock.unlock();
+            cv.notify_all();
+            return Slot();
+        }
+
+        if (busy or *waiting.begin() != ticket) {
+            if (forever)
+                cv.wait(lock);
+            else
+                cv.wait_until(lock, until);
+            continue;
+        }
+
+        // the line must stay silent for the gap, a higher priority transaction may show up meanwhile
+        val ready = lastRelease + gap;
+        if (std::chrono::steady_clock::now() >= ready)
+            break;
+        cv.wait_until(lock, std::min(ready, until));
+    }
+
+    waiting.erase(waiting.begin());
+    busy = true;
+    busySince = std::chrono::steady_clock::now();
+    ++transactions;
+    queueWait.record(busySince - start);
+    return Slot(this);
+}
+
+fun serial::Arbiter::release() -> void {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        busy = false;
+        lastRelease = std::chrono::steady_clock::now();
+        busyTotal += std::chrono::duration_cast<std::chrono::microseconds>(lastRelease - busySince);
+    }
+    cv.notify_all();
+}
+
+fun serial::Arbiter::queued() const -> size_t {
+    std::lock_guard<std::mutex> lock(mtx);
+    return waiting.size();
+}
+
+fun serial::Arbiter::json() const -> std::string {
+    std::lock_guard<std::mutex> lock(mtx);
+    val now = std::chrono::steady_clock::now();
+    var busyUs = busyTotal;
+    if (busy)
+        busyUs += std::chrono::duration_cast<std::chrono::microseconds>(now - busySince);
+
+    val elapsed = std::chrono::duration_cast<std::chrono::microseconds>(now - created);
+    val utilization = elapsed.count() > 0 ? double(busyUs.count()) / elapsed.count() : 0.0;
+
+    return "{"
+        "\"gapUs\": " + std::to_string(gap.count()) + ", "
+        "\"transactions\": " + std::to_string(transactions) + ", "
+        "\"queued\": " + std::to_string(waiting.size()) + ", "
+        "\"busyUs\": " + std::to_string(busyUs.count()) + ", "
+        "\"utilization\": " + tools::to_string(utilization, 3) + ", "
+        "\"queueWaitUs\": " + queueWait.json() +
+    "}";
+}
+
+extern "C" {
+    typedef void* nexus_serial_arbiter_t;
+
+    nexus_serial_arbiter_t nexus_serial_arbiter_new(int gap_us) {
+        return new std::shared_ptr<serial::Arbiter>(std::make_shared<serial::Arbiter>(std::chrono::microseconds(gap_us)));
+    }
+
+    void nexus_serial_arbiter_delete(nexus_serial_arbiter_t arbiter) {
+        delete static_cast<std::shared_ptr<serial::Arbiter>*>(arbiter);
+    }
+}
@@ -0,0 +1,172 @@
+#include "nexus/serial/capture.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <etl/keywords.h>
+
+using namespace nexus;
+
+static constexpr char magic[8] = {'N', 'X', 'C', 'A', 'P', 0x01, 0, 0};
+static constexpr size_t headerSize = sizeof(magic) + sizeof(uint64_t);
+static constexpr size_t chunkHeaderSize = sizeof(int64_t) + sizeof(uint32_t) + sizeof(uint8_t);
+
+serial::Capture::Capture(std::string path, size_t capacity)
+    : path(std::move(path))
+    , capacity(std::max(capacity, headerSize + chunkHeaderSize))
+{
+    fd = ::open(this->path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0)
+        return;
+
+    if (::ftruncate(fd, this->capacity) != 0)
+        return;
+
+    val ptr = ::mmap(nullptr, this->capacity, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (ptr == MAP_FAILED)
+        return;
+
+    map = static_cast<uint8_t*>(ptr);
+    used = headerSize;
+    std::memcpy(map, magic, sizeof(magic));
+    std::memcpy(map + sizeof(magic), &used, sizeof(uint64_t));
+}
+
+serial::Capture::~Capture() {
+    if (map) {
+        ::munmap(map, capacity);
+        std::ignore = ::ftruncate(fd, used);
+    }
+    if (fd >= 0)
+        ::close(fd);
+}
+
+fun serial::Capture::grow(size_t size) -> bool {
+    var next = capacity;
+    while (next < size)
+        next *= 2;
+
+    if (::ftruncate(fd, next) != 0)
+        return false;
+
+    val ptr = ::mremap(map, capacity, next, MREMAP_MAYMOVE);
+    if (ptr == MAP_FAILED)
+        return false;
+
+    map = static_cast<uint8_t*>(ptr);
+    capacity = next;
+    return true;
+}
+
+fun serial::Capture::append(Direction direction, const uint8_t* data, size_t length) -> void {
+    if (length == 0)
+        return;
+
+    val time = int64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+    val size = uint32_t(length);
+
+    std::lock_guard<std::mutex> lock(mtx);
+    if (not map or (used + chunkHeaderSize + length > capacity and not grow(used + chunkHeaderSize + length)))
+        return;
+
+    var ptr = map + used;
+    std::memcpy(ptr, &time, sizeof(time));
+    std::memcpy(ptr + sizeof(time), &size, sizeof(size));
+    ptr[sizeof(time) + sizeof(size)] = direction;
+    std::memcpy(ptr + chunkHeaderSize, data, length);
+
+    // the chunk is complete before it is counted in the header
+    used += chunkHeaderSize + length;
+    std::memcpy(map + sizeof(magic), &used, sizeof(uint64_t));
+
+    ++chunks_;
+    bytes_ += length;
+}
+
+fun serial::Capture::json() const -> std::string {
+    var size = size_t(0);
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        size = used;
+    }
+    return "{"
+        "\"path\": \"" + path + "\", "
+        "\"chunks\": " + std::to_string(chunks_) + ", "
+        "\"bytes\": " + std::to_string(bytes_) + ", "
+        "\"size\": " + std::to_string(size) +
+    "}";
+}
+
+serial::Capture::Reader::Reader(const std::string& path) {
+    val fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return;
+
+    struct stat st = {};
+    if (::fstat(fd, &st) != 0 or size_t(st.st_size) < headerSize) {
+        ::close(fd);
+        return;
+    }
+
+    val ptr = ::mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (ptr == MAP_FAILED)
+        return;
+
+    map = static_cast<const uint8_t*>(ptr);
+    size = st.st_size;
+
+    uint64_t recorded = 0;
+    std::memcpy(&recorded, map + sizeof(magic), sizeof(recorded));
+    if (std::memcmp(map, magic, sizeof(magic)) != 0 or recorded < headerSize or recorded > size) {
+        ::munmap(const_cast<uint8_t*>(map), size);
+        map = nullptr;
+        return;
+    }
+
+    end = recorded;
+    offset = headerSize;
+}
+
+serial::Capture::Reader::~Reader() {
+    if (map)
+        ::munmap(const_cast<uint8_t*>(map), size);
+}
+
+fun serial::Capture::Reader::next(Chunk& chunk) -> bool {
+    if (not map or offset + chunkHeaderSize > end)
+        return false;
+
+    int64_t time = 0;
+    uint32_t length = 0;
+    std::memcpy(&time, map + offset, sizeof(time));
+    std::memcpy(&length, map + offset + sizeof(time), sizeof(length));
+    if (offset + chunkHeaderSize + length > end)
+        return false;
+
+    chunk.time = std::chrono::nanoseconds(time);
+    chunk.direction = Direction(map[offset + sizeof(time) + sizeof(length)]);
+    chunk.data = map + offset + chunkHeaderSize;
+    chunk.length = length;
+    offset += chunkHeaderSize + length;
+    return true;
+}
+
+fun serial::Capture::Reader::rewind() -> void {
+    offset = headerSize;
+}
+
+extern "C" {
+    typedef void* nexus_serial_capture_t;
+
+    nexus_serial_capture_t nexus_serial_capture_new(const char* path) {
+        return new std::shared_ptr<serial::Capture>(std::make_shared<serial::Capture>(path));
+    }
+
+    void nexus_serial_capture_delete(nexus_serial_capture_t capture) {
+        delete static_cast<std::shared_ptr<serial::Capture>*>(capture);
+    }
+}
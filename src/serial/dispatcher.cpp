@@ -0,0 +1,145 @@
+#include "nexus/serial/dispatcher.h"
+#include <algorithm>
+#include <memory>
+#include <etl/keywords.h>
+
+using namespace nexus;
+
+serial::Dispatcher::Dispatcher(size_t n_workers, size_t capacity, Overflow overflow) 
+    : capacity(std::max(capacity, size_t(1)))
+    , overflow(overflow) 
+    , queue(this->capacity)
+{
+    for (size_t i = 0; i < std::max(n_workers, size_t(1)); ++i)
+        workers.emplace_back(&Dispatcher::work, this);
+}
+
+serial::Dispatcher::~Dispatcher() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        isRunning = false;
+    }
+    cvPop.notify_all();
+    cvPush.notify_all();
+
+    for (var &worker in workers)
+        worker.join();
+}
+
+fun serial::Dispatcher::dispatch(Task task) -> bool {
+    return push({std::move(task), nullptr, {}, {}});
+}
+
+fun serial::Dispatcher::dispatch(std::shared_ptr<const FrameTask> task, byte_view frame) -> bool {
+    return push({{}, std::move(task), std::move(frame), {}});
+}
+
+fun serial::Dispatcher::push(Item item) -> bool {
+    // destroyed after the lock, a task may complete something when it's dropped
+    var evicted = Item();
+    std::unique_lock<std::mutex> lock(mtx);
+    if (count >= capacity) {
+        if (overflow == DROP_NEWEST) {
+            ++dropped;
+            return false;
+        }
+        elif (overflow == DROP_OLDEST) {
+            evicted = std::move(queue[head]);
+            queue[head] = {};
+            head = (head + 1) % capacity;
+            --count;
+            ++dropped;
+        }
+        elif (onWorker()) {
+            // waiting for its own queue to drain would never end
+            ++dropped;
+            return false;
+        }
+        else {
+            cvPush.wait(lock, [this] { return not isRunning or count < capacity; });
+            if (not isRunning) {
+                ++dropped;
+                return false;
+            }
+        }
+    }
+
+    item.enqueued = std::chrono::steady_clock::now();
+    queue[(head + count) % capacity] = std::move(item);
+    ++count;
+    maxDepth = std::max(maxDepth, count);
+    lock.unlock();
+
+    cvPop.notify_one();
+    return true;
+}
+
+fun serial::Dispatcher::depth() const -> size_t {
+    std::lock_guard<std::mutex> lock(mtx);
+    return count;
+}
+
+fun serial::Dispatcher::json() const -> std::string {
+    std::lock_guard<std::mutex> lock(mtx);
+    return "{"
+        "\"workers\": " + std::to_string(workers.size()) + ", "
+        "\"capacity\": " + std::to_string(capacity) + ", "
+        "\"depth\": " + std::to_string(count) + ", "
+        "\"maxDepth\": " + std::to_string(maxDepth) + ", "
+        "\"dispatched\": " + std::to_string(dispatched) + ", "
+        "\"dropped\": " + std::to_string(dropped) + ", "
+        "\"failed\": " + std::to_string(failed) + ", "
+        "\"latencyAvgUs\": " + std::to_string(dispatched == 0 ? 0 : latencyTotal.count() / dispatched) + ", "
+        "\"latencyMaxUs\": " + std::to_string(latencyMax.count()) +
+    "}";
+}
+
+fun serial::Dispatcher::work() -> void {
+    while (true) {
+        std::unique_lock<std::mutex> lock(mtx);
+        cvPop.wait(lock, [this] { return not isRunning or count > 0; });
+
+        // the remaining tasks are still run when stopping
+        if (count == 0)
+            return;
+
+        var item = std::move(queue[head]);
+        head = (head + 1) % capacity;
+        --count;
+
+        val latency = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - item.enqueued);
+        latencyTotal += latency;
+        latencyMax = std::max(latencyMax, latency);
+        ++dispatched;
+        lock.unlock();
+
+        cvPush.notify_one();
+        try {
+            if (item.frameTask)
+                (*item.frameTask)(std::move(item.frame));
+            else
+                item.task();
+        } catch (...) {
+            // the worker goes on with the next task
+            std::lock_guard<std::mutex> lock_failed(mtx);
+            ++failed;
+        }
+    }
+}
+
+fun serial::Dispatcher::onWorker() const -> bool {
+    val self = std::this_thread::get_id();
+    return std::any_of(workers.begin(), workers.end(), [self] (const std::thread& worker) { return worker.get_id() == self; });
+}
+
+extern "C" {
+    typedef void* nexus_serial_dispatcher_t;
+
+    nexus_serial_dispatcher_t nexus_serial_dispatcher_new(size_t n_workers, size_t capacity, int overflow) {
+        return new std::shared_ptr<serial::Dispatcher>(std::make_shared<serial::Dispatcher>(n_workers, capacity, serial::Dispatcher::Overflow(overflow)));
+    }
+
+    void nexus_serial_dispatcher_delete(nexus_serial_dispatcher_t dispatcher) {
+        delete static_cast<std::shared_ptr<serial::Dispatcher>*>(dispatcher);
+    }
+}
@@ -1,10 +1,15 @@
 #include "nexus/serial/hardware.h"
+#include "nexus/serial/reactor.h"
+#include "nexus/serial/hotplug.h"
 #include "nexus/tools/detect_virtual_comm.h"
 #include "nexus/tools/json.h"
-#include <future>
 #include <algorithm>
 #include <fcntl.h>   /* File Control Definitions */
 #include <unistd.h>  /* UNIX Standard Definitions */
+#include <sys/ioctl.h>
+#include <sys/uio.h>
+#include <climits>
+#include <poll.h>
 #include <etl/keywords.h>
 
 using namespace nexus;
@@ -18,94 +23,176 @@ fun serial::Hardware::Codec::decode(byte_view buffer) const -> byte_view {
     return buffer.len() == 0 or buffer.back() != '\n' ? null : buffer;
 }
 
-serial::Hardware::Interface::Interface(std::shared_ptr<Hardware> ser) : ser_(ser), codec_(ser->messageHandlers.begin()->get()->codec) {}
+fun serial::Hardware::Codec::frame(byte_view buffer) const -> Framing {
+    val it = std::find(buffer.begin(), buffer.end(), '\n');
+    if (it == buffer.end())
+        return {Framing::NEED_MORE, 1};
+
+    return {Framing::COMPLETE, size_t(it - buffer.begin()) + 1};
+}
+
+serial::Hardware::Interface::Interface(std::shared_ptr<Hardware> ser) : ser_(ser), codec_(ser->loadHandlers()->front()->codec) {}
 
 serial::Hardware::Interface::Interface(std::shared_ptr<Hardware> ser, std::shared_ptr<abstract::Codec> codec) 
-    : ser_(ser), codec_(codec) 
+    : ser_(ser), codec_(codec), addedCodec_(true)
 {
     ser_->addCodec(codec);
 }
 
 serial::Hardware::Interface::~Interface() {
-    std::lock_guard<std::mutex> lockCodec(ser_->codecMutex);
-    var handler = std::find_if(ser_->messageHandlers.begin(), ser_->messageHandlers.end(), [this](val &item) {
-        return item->codec == this->codec_;
-    });
-
-    if (handler == ser_->messageHandlers.end())
+    if (not ser_)
         return;
-    
-    for (var callback in callbacks_)
-        handler->get()->callbacks.erase(callback);
+
+    val handler = ser_->findMessageHandler(codec_.get());
+    if (handler) {
+        std::lock_guard<std::mutex> lockCallback(handler->callbackMutex);
+        for (var callback in callbacks_)
+            handler->callbacks.erase(callback);
+        handler->publishCallbacks();
+    }
+
+    if (addedCodec_)
+        ser_->removeCodec(codec_.get());
 }
 
 fun serial::Hardware::Interface::addCallback(std::function<void(byte_view)> callback) -> CallbackId {
-    std::lock_guard<std::mutex> lockCodec(ser_->codecMutex);
-    var handler = std::find_if(ser_->messageHandlers.begin(), ser_->messageHandlers.end(), [this](val &item) {
-        return item->codec == this->codec_;
-    });
-
-    handler->get()->callbacks.push_back(std::move(callback));
-    var it = std::prev(handler->get()->callbacks.end());
+    val handler = ser_->findMessageHandler(codec_.get());
+    std::lock_guard<std::mutex> lockCallback(handler->callbackMutex);
+    handler->callbacks.push_back(std::make_shared<const Callback>(std::move(callback)));
+    handler->publishCallbacks();
+    var it = std::prev(handler->callbacks.end());
     callbacks_.push_back(it);
     return it;
 }
 
 fun serial::Hardware::Interface::removeCallback(CallbackId callback) -> void {
-    std::lock_guard<std::mutex> lockCodec(ser_->codecMutex);
-    var handler = std::find_if(ser_->messageHandlers.begin(), ser_->messageHandlers.end(), [this](val &item) {
-        return item->codec == this->codec_;
-    });
-
-    handler->get()->callbacks.erase(callback);
+    val handler = ser_->findMessageHandler(codec_.get());
+    std::lock_guard<std::mutex> lockCallback(handler->callbackMutex);
+    handler->callbacks.erase(callback);
+    handler->publishCallbacks();
     callbacks_.remove(callback);
 }
 
-serial::Hardware::Hardware(std::string port, speed_t speed, std::chrono::milliseconds timeout, std::shared_ptr<abstract::Codec> codec)
+serial::Hardware::Hardware(std::string port, speed_t speed, std::chrono::milliseconds timeout, std::shared_ptr<abstract::Codec> codec, size_t rxBufferSize)
+    : Hardware(-1, std::move(port), speed, timeout, std::move(codec), rxBufferSize)
+{
+    reconnect();
+}
+
+serial::Hardware::Hardware(int dev, std::string port, speed_t speed, std::chrono::milliseconds timeout, std::shared_ptr<abstract::Codec> codec, size_t rxBufferSize)
     : port(std::move(port))
     , speed(speed)
     , timeout(timeout)
+    , rxBuffer(rxBufferSize)
+    , dispatcher(std::make_shared<Dispatcher>())
+    , framePool(std::make_shared<tools::FramePool>(rxBufferSize))
 {
     if (not codec)
         codec = std::make_shared<Hardware::Codec>();
 
-    messageHandlers.push_back(makeMessageHandler(codec));
-    reconnect();
+    storeHandlers({makeMessageHandler(codec)});
+    fd = dev;
     worker = std::thread(&Hardware::work, this);
 }
 
 serial::Hardware::~Hardware() {
+    if (val manager = std::atomic_exchange(&hotplug, std::shared_ptr<Hotplug>()))
+        manager->remove(this);
+
+    if (isAttached)
+        reactor->remove(this);
+
+    // the queued frames are still written
+    {
+        std::lock_guard<std::mutex> lock(txQueueMutex);
+        txRunning = false;
+    }
+    txPop.notify_all();
+    txPush.notify_all();
+    if (txWorker.joinable())
+        txWorker.join();
+
     disconnect();
     isRunning = false;
-    worker.join();
+    {
+        std::lock_guard<std::mutex> lock(idleMutex);
+    }
+    idleCv.notify_all();
+    if (worker.joinable())
+        worker.join();
+
+    // run the pending callbacks while the port is still alive
+    std::atomic_store(&dispatcher, std::shared_ptr<Dispatcher>());
 }
 
-fun serial::Hardware::reconnect() -> void {
-    std::scoped_lock lockTx(txMutex);
-    std::scoped_lock lockRx(rxMutex);
+fun serial::Hardware::json() const -> std::string {
+    val bus = getArbiter();
+    val sink = getCapture();
+    return tools::json_concat(abstract::Serial::json(), "{"
+        "\"baudRate\": " + std::to_string(baudRate()) + ", "
+        "\"rxBufferSize\": " + std::to_string(rxBuffer.capacity()) + ", "
+        "\"bytesReceived\": " + std::to_string(bytesReceived) + ", "
+        "\"framesDecoded\": " + std::to_string(framesDecoded) + ", "
+        "\"bytesDiscarded\": " + std::to_string(bytesDiscarded) + ", "
+        "\"overflows\": " + std::to_string(overflows) + ", "
+        "\"messagesDropped\": " + std::to_string(messagesDropped) + ", "
+        "\"silenceUs\": " + std::to_string(silenceUs) + ", "
+        "\"dispatcher\": " + getDispatcher()->json() + ", "
+        "\"framePool\": " + framePool->json() + ", "
+        "\"tx\": " + txJson() + ", "
+        "\"responseLatencyUs\": " + responseLatency.json() + ", "
+        "\"interByteGapUs\": " + interByteGap.json() + ", "
+        "\"arbiter\": " + (bus ? bus->json() : "null") + ", "
+        "\"capture\": " + (sink ? sink->json() : "null") +
+    "}");
+}
 
-    if (isConnected())
+fun serial::Hardware::reconnect() -> void {
+    // with a hotplug manager the port is reopened on the manager's thread, the caller never waits for the device
+    if (val manager = std::atomic_load(&hotplug)) {
         disconnect();
+        manager->wake(this);
+        return;
+    }
+
+    connect();
+}
+
+fun serial::Hardware::connect() -> bool {
+    std::lock_guard<std::mutex> lock(connectMutex);
+    disconnect();
 
-    var ports = std::vector<std::string>();
     if (this->port == null or this->port == std::string("auto")) {
-        ports = tools::detectVirtualComm();
-        if (not ports.empty())
-            this->port = ports[0];
+        val manager = std::atomic_load(&hotplug);
+        val ports = manager ? manager->ports() : tools::detectVirtualComm();
+        if (ports.empty())
+            return false;
+
+        this->port = ports[0];
     }
 
-    fd = open(this->port.c_str(), O_RDWR | O_NOCTTY | O_SYNC);
-    if (fd < 0)
-        return;
+    // the device is opened and configured before it is published, the tx and rx locks are never held meanwhile
+    val dev = open(this->port.c_str(), O_RDWR | O_NOCTTY | O_SYNC);
+    if (dev < 0)
+        return false;
 
     struct termios tty = {};
-    if (tcgetattr(fd, &tty) != 0) {
-        disconnect();
-        return;
+    if (tcgetattr(dev, &tty) != 0) {
+        close(dev);
+        return false;
     }
 
-    cfsetospeed(&tty, this->speed);
-    cfsetispeed(&tty, this->speed);
+    val baud = tools::baud_rate(this->speed);
+    val constant = tools::speed_constant(baud);
+    if (baud <= 0) {
+        close(dev);
+        return false;
+    }
+
+    if (constant != B0) {
+        cfsetospeed(&tty, constant);
+        cfsetispeed(&tty, constant);
+    }
 
     tty.c_cflag |= (CLOCAL | CREAD);    /* ignore modem controls */
     tty.c_cflag &= ~CSIZE;
@@ -119,26 +206,68 @@ fun serial::Hardware::reconnect() -> void {
     tty.c_lflag = 0; // no signaling chars, no echo, no canonical processing
     tty.c_oflag = ~OPOST; // no remapping
 
-    int vtime = this->timeout.count() / 100;
-    vtime = etl::clamp(vtime, 0, 10);
-
-    tty.c_cc[VTIME] = (cc_t) (vtime); 
+    // reads never block, the worker polls with the timeout instead of VTIME's tenths of a second
+    tty.c_cc[VTIME] = 0;
     tty.c_cc[VMIN]  = 0; 
 
-    if (tcsetattr(fd, TCSANOW, &tty) != 0) {
-        disconnect();
-        return;
+    if (tcsetattr(dev, TCSANOW, &tty) != 0) {
+        close(dev);
+        return false;
+    }
+
+    // no termios constant for the rate, e.g. 250000 or 12 Mbaud
+    if (constant == B0 and not tools::set_custom_baud_rate(dev, baud)) {
+        close(dev);
+        return false;
     }
 
     // clear rx buffer
-    tcflush(fd, TCIOFLUSH);
+    tcflush(dev, TCIOFLUSH);
+    adopt(dev);
+    return true;
+}
+
+fun serial::Hardware::adopt(int dev) -> void {
+    fd = dev;
+
+    // wake the worker thread, or hand the new fd to the reactor
+    {
+        std::lock_guard<std::mutex> lockIdle(idleMutex);
+    }
+    idleCv.notify_all();
+    if (isAttached)
+        reactor->add(this);
 }
 
 fun serial::Hardware::disconnect() -> void {
-    if (isConnected()) {
-        close(fd);
-        fd = -1;
+    {
+        std::lock_guard<std::mutex> lock(rxMutex);
+        if (not disconnectRx())
+            return;
+    }
+
+    // the manager reconnects under its own locks, it's woken without the port's
+    if (val manager = std::atomic_load(&hotplug))
+        manager->wake(this);
+}
+
+fun serial::Hardware::disconnectRx() -> bool {
+    // the number may be handed out again once it is closed, no reader or writer may still hold it
+    {
+        std::lock_guard<std::mutex> lock(txMutex);
+        val dev = fd.exchange(-1);
+        if (dev < 0)
+            return false;
+
+        close(dev);
+    }
+
+    // receivers waiting for a frame give up now
+    for (val &handler in *loadHandlers()) {
+        std::lock_guard<std::mutex> lock(handler->mtx);
+        handler->cv.notify_all();
     }
+    return true;
 }
 
 fun serial::Hardware::isConnected() const -> bool {
@@ -146,149 +275,784 @@ fun serial::Hardware::isConnected() const -> bool {
 }
 
 fun serial::Hardware::send(byte_view buffer) -> int {
-    return sendCodec(messageHandlers.begin()->get()->codec, buffer);
+    return sendCodec(loadHandlers()->front()->codec, buffer);
 }
 
 fun serial::Hardware::receive() -> byte_view {
-    return receiveCodec(messageHandlers.begin()->get()->codec, lambda (var) { return true; });
+    return receiveCodec(loadHandlers()->front()->codec, lambda (var) { return true; });
 }
 
 fun serial::Hardware::receive(std::function<bool(byte_view)> filter) -> byte_view {
-    return receiveCodec(messageHandlers.begin()->get()->codec, std::move(filter));
+    return receiveCodec(loadHandlers()->front()->codec, std::move(filter));
 }
 
 fun serial::Hardware::sendCodec(std::shared_ptr<abstract::Codec> codec, byte_view buffer) -> int {
     if (not isConnected()) 
         return -1;
 
-    std::scoped_lock lock(txMutex);
-    val buf = codec->encode(buffer);
-    val res = write(fd, buf.data(), buf.size());
+    var res = ssize_t(-1);
+    {
+        std::scoped_lock lock(txMutex);
+        txFrame.assign(buffer, codec->headroom(), codec->tailroom());
+        codec->encodeInto(txFrame);
+        val buf = txFrame.view();
+        res = write(fd, buf.data(), buf.size());
+        if (res >= 0)
+            sent(res);
+
+        if (val sink = res > 0 ? getCapture() : nullptr)
+            sink->append(Capture::TX, buf.data(), res);
+    }
+
+    // closing takes the tx lock too
     if (res < 0)
         disconnect();
 
     return (int) res;
 }
 
-fun serial::Hardware::receiveCodec(std::shared_ptr<abstract::Codec> codec, std::function<bool(byte_view)> filter) -> byte_view {
+fun serial::Hardware::sendAsync(std::shared_ptr<abstract::Codec> codec, byte_view buffer, SendCallback callback) -> bool {
     if (not isConnected()) 
-        return null;
+        return false;
+
+    // encoded on the caller's thread, the queued frame must own its bytes
+    var buf = codec->encode(buffer);
+    if (not buf.is_owning())
+        buf = buf.copy();
+
+    std::unique_lock<std::mutex> lock(txQueueMutex);
+    if (not txWorker.joinable()) {
+        txRunning = true;
+        txWorker = std::thread(&Hardware::txWork, this);
+    }
+
+    txPush.wait(lock, [this] { return not txRunning or txQueue.size() < txQueueCapacity; });
+    if (not txRunning)
+        return false;
+
+    txQueue.push_back({std::move(buf), std::chrono::steady_clock::now(), std::move(callback)});
+    lock.unlock();
+
+    txPop.notify_one();
+    return true;
+}
+
+fun serial::Hardware::sendAsync(std::shared_ptr<abstract::Codec> codec, byte_view buffer) -> std::future<int> {
+    var promise = std::make_shared<std::promise<int>>();
+    var res = promise->get_future();
+    if (not sendAsync(std::move(codec), std::move(buffer), [promise] (int n) { promise->set_value(n); }))
+        promise->set_value(-1);
+
+    return res;
+}
+
+fun serial::Hardware::setTxQueueCapacity(size_t capacity) -> void {
+    {
+        std::lock_guard<std::mutex> lock(txQueueMutex);
+        txQueueCapacity = std::max(capacity, size_t(1));
+    }
+    txPush.notify_all();
+}
+
+fun serial::Hardware::txWork() -> void {
+    var batch = std::vector<TxFrame>();
+    var iov = std::vector<struct iovec>();
+    var results = std::vector<int>();
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(txQueueMutex);
+            txPop.wait(lock, [this] { return not txRunning or not txQueue.empty(); });
+
+            // the remaining frames are still written when stopping
+            if (txQueue.empty())
+                return;
+
+            // everything queued so far goes out in one writev
+            val now = std::chrono::steady_clock::now();
+            while (not txQueue.empty() and batch.size() < size_t(IOV_MAX)) {
+                val delay = std::chrono::duration_cast<std::chrono::microseconds>(now - txQueue.front().enqueued);
+                txDelayTotal += delay;
+                txDelayMax = std::max(txDelayMax, delay);
+                batch.push_back(std::move(txQueue.front()));
+                txQueue.pop_front();
+            }
+        }
+        txPush.notify_all();
+
+        txWrite(batch, iov, results);
+        for (val i in etl::range(batch.size())) if (batch[i].callback)
+            batch[i].callback(results[i]);
+
+        batch.clear();
+    }
+}
+
+fun serial::Hardware::txWrite(const std::vector<TxFrame>& batch, std::vector<struct iovec>& iov, std::vector<int>& results) -> void {
+    iov.clear();
+    for (val &frame in batch)
+        iov.push_back({const_cast<uint8_t*>(frame.data.data()), frame.data.len()});
+
+    // frames before `done` are fully written, a partial write resumes within the frame at `done`
+    var done = size_t(0);
+    var writes = size_t(0);
+    var written = size_t(0);
+    var failed = false;
+    val start = std::chrono::steady_clock::now();
+    {
+        std::lock_guard<std::mutex> lock(txMutex);
+        while (done < iov.size() and isConnected()) {
+            val n = ::writev(fd, iov.data() + done, int(iov.size() - done));
+            if (n < 0 and errno == EINTR)
+                continue;
+
+            if (n < 0) {
+                failed = true;
+                break;
+            }
+
+            ++writes;
+            written += n;
+            val sink = getCapture();
+            for (var left = size_t(n); left > 0;) {
+                val len = etl::min(left, iov[done].iov_len);
+                if (sink)
+                    sink->append(Capture::TX, static_cast<const uint8_t*>(iov[done].iov_base), len);
+                iov[done].iov_base = static_cast<uint8_t*>(iov[done].iov_base) + len;
+                iov[done].iov_len -= len;
+                left -= len;
+                if (iov[done].iov_len == 0)
+                    ++done;
+            }
+            while (done < iov.size() and iov[done].iov_len == 0)
+                ++done;
+        }
+        if (writes > 0)
+            sent(written);
+    }
+    if (failed)
+        disconnect();
+    val wire = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+    results.clear();
+    var bytes = size_t(0);
+    for (val i in etl::range(batch.size())) {
+        results.push_back(i < done ? int(batch[i].data.len()) : -1);
+        bytes += i < done ? batch[i].data.len() : 0;
+    }
+
+    std::lock_guard<std::mutex> lock(txQueueMutex);
+    txFrames += done;
+    txWrites += writes;
+    txBytes += bytes;
+    txWireTotal += wire;
+    txWireMax = std::max(txWireMax, wire);
+}
+
+fun serial::Hardware::txJson() const -> std::string {
+    std::lock_guard<std::mutex> lock(txQueueMutex);
+    return "{"
+        "\"depth\": " + std::to_string(txQueue.size()) + ", "
+        "\"frames\": " + std::to_string(txFrames) + ", "
+        "\"writes\": " + std::to_string(txWrites) + ", "
+        "\"bytes\": " + std::to_string(txBytes) + ", "
+        "\"queueDelayAvgUs\": " + std::to_string(txFrames == 0 ? 0 : txDelayTotal.count() / txFrames) + ", "
+        "\"queueDelayMaxUs\": " + std::to_string(txDelayMax.count()) + ", "
+        "\"wireAvgUs\": " + std::to_string(txWrites == 0 ? 0 : txWireTotal.count() / txWrites) + ", "
+        "\"wireMaxUs\": " + std::to_string(txWireMax.count()) +
+    "}";
+}
+
+fun serial::Hardware::receiveCodec(std::shared_ptr<abstract::Codec> codec, std::function<bool(byte_view)> filter) -> byte_view {
+    var res = receiveMessages(std::move(codec), std::move(filter), 1);
+    return res.empty() ? null : std::move(res[0].data);
+}
+
+fun serial::Hardware::receiveMessages(std::shared_ptr<abstract::Codec> codec, std::function<bool(byte_view)> filter, size_t max, uint64_t after, std::chrono::steady_clock::time_point until) -> std::vector<Message> {
+    var res = std::vector<Message>();
+    if (not isConnected() or max == 0) 
+        return res;
     
-    var handler = std::find_if(messageHandlers.begin(), messageHandlers.end(), [&codec](val &item) {
-        return item->codec == codec;
-    });
+    val handler = findMessageHandler(codec.get());
+    if (not handler)
+        return res;
+    
+    val take = [&] {
+        handler->messages.take(res, max, [&] (const Message& message) { return message.seq > after and filter(message.data); });
+        return not res.empty();
+    };
+
+    // the request may still be on the wire at a low baud rate, the device can't answer before it is out
+    val drained = std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(txDrained.load()));
+    val deadline = std::min(until, std::max(drained, std::chrono::steady_clock::now()) + timeout.load());
+
+    std::unique_lock<std::mutex> lock(handler->mtx);
+    handler->cv.wait_until(lock, deadline, [this, &take] { return not isRunning or take() or not isConnected(); });
+    if (not isRunning)
+        res.clear();
+
+    return res;
+}
+
+fun serial::Hardware::sequence(std::shared_ptr<abstract::Codec> codec) const -> uint64_t {
+    val handler = findMessageHandler(codec.get());
+    if (not handler)
+        return 0;
 
-    if (handler == messageHandlers.end())
-        return null;
+    std::lock_guard<std::mutex> lock(handler->mtx);
+    return handler->seq;
+}
+
+fun serial::Hardware::setMessageQueueCapacity(size_t capacity) -> void {
+    messageQueueCapacity = std::max(capacity, size_t(1));
+}
+
+fun serial::Hardware::findMessageHandler(CodecId codec) const -> std::shared_ptr<MessageHandler> {
+    val handlers = loadHandlers();
+    for (val &handler in *handlers) if (handler->codec.get() == codec)
+        return handler;
     
-    std::unique_lock<std::mutex> lock(handler->get()->mtx);
-    return handler->get()->cv.wait_for(lock, timeout, [this, handler, fn=std::move(filter)] {
-        return not isRunning or (not handler->get()->message.empty() and fn(handler->get()->message));
-    }) and isRunning ? std::move(handler->get()->message) : null;
+    return nullptr;
+}
+
+fun serial::Hardware::storeHandlers(HandlerTable table) -> void {
+    std::atomic_store(&messageHandlers, std::make_shared<const HandlerTable>(std::move(table)));
+    handlersVersion.fetch_add(1, std::memory_order_release);
+}
+
+fun serial::Hardware::rxTable() -> const HandlerTable& {
+    val version = handlersVersion.load(std::memory_order_acquire);
+    if (not rxHandlers or version != rxHandlersVersion) {
+        rxHandlers = loadHandlers();
+        rxHandlersVersion = version;
+    }
+    return *rxHandlers;
 }
 
 fun serial::Hardware::addCodec(std::shared_ptr<abstract::Codec> codec) -> CodecId {
     std::lock_guard<std::mutex> lock(codecMutex);
-    var handler = std::find_if(messageHandlers.begin(), messageHandlers.end(), [&codec](val &item) {
-        return item->codec == codec;
-    });
+    val handlers = loadHandlers();
+    for (val &handler in *handlers) if (handler->codec == codec) {
+        ++handler->registrations;
+        return codec.get();
+    }
 
-    if (handler == messageHandlers.end())
-        messageHandlers.push_back(makeMessageHandler(codec));
-    
+    var table = *handlers;
+    table.push_back(makeMessageHandler(codec));
+    storeHandlers(std::move(table));
     return codec.get();
 }
 
 fun serial::Hardware::removeCodec(CodecId codec) -> void {
     std::lock_guard<std::mutex> lock(codecMutex);
-    auto it = std::find_if(messageHandlers.begin(), messageHandlers.end(), [codec](val &item) { 
+    val handlers = loadHandlers();
+    val it = std::find_if(handlers->begin(), handlers->end(), [codec](val &item) { 
         return item->codec.get() == codec; 
     });
 
-    if (it != messageHandlers.end() and it != messageHandlers.begin())
-        messageHandlers.erase(it);
+    if (it == handlers->end() or it == handlers->begin() or --it->get()->registrations > 0)
+        return;
+    
+    var table = HandlerTable();
+    table.reserve(handlers->size() - 1);
+    for (val &handler in *handlers) if (handler != *it)
+        table.push_back(handler);
+    
+    storeHandlers(std::move(table));
 }
 
 fun serial::Hardware::addCallback(std::function<void(byte_view)> callback) -> CallbackId {
-    std::lock_guard<std::mutex> lock(codecMutex);
-    var &callbackList = messageHandlers.begin()->get()->callbacks;
-    callbackList.push_back(std::move(callback));
+    val handler = loadHandlers()->front();
+    std::lock_guard<std::mutex> lockCallback(handler->callbackMutex);
+    var &callbackList = handler->callbacks;
+    callbackList.push_back(std::make_shared<const Callback>(std::move(callback)));
+    handler->publishCallbacks();
     return std::prev(callbackList.end());
 }
 
 void serial::Hardware::removeCallback(CallbackId callback) {
-    std::lock_guard<std::mutex> lock(codecMutex);
-    messageHandlers.begin()->get()->callbacks.erase(callback);
+    val handler = loadHandlers()->front();
+    std::lock_guard<std::mutex> lockCallback(handler->callbackMutex);
+    handler->callbacks.erase(callback);
+    handler->publishCallbacks();
+}
+
+fun serial::Hardware::setDispatcher(std::shared_ptr<Dispatcher> dispatcher) -> void {
+    if (dispatcher)
+        std::atomic_store(&this->dispatcher, std::move(dispatcher));
+}
+
+fun serial::Hardware::getDispatcher() const -> std::shared_ptr<Dispatcher> {
+    return std::atomic_load(&dispatcher);
+}
+
+fun serial::Hardware::setArbiter(std::shared_ptr<Arbiter> arbiter) -> void {
+    std::atomic_store(&this->arbiter, std::move(arbiter));
+}
+
+fun serial::Hardware::getArbiter() const -> std::shared_ptr<Arbiter> {
+    return std::atomic_load(&arbiter);
+}
+
+fun serial::Hardware::setCapture(std::shared_ptr<Capture> capture) -> void {
+    std::atomic_store(&this->capture, std::move(capture));
+}
+
+fun serial::Hardware::getCapture() const -> std::shared_ptr<Capture> {
+    return std::atomic_load(&capture);
+}
+
+fun serial::Hardware::attach(std::shared_ptr<Reactor> reactor) -> void {
+    if (not reactor)
+        return detach();
+
+    detach();
+
+    // stop the worker thread, the reactor takes over from here
+    this->reactor = std::move(reactor);
+    isAttached = true;
+    {
+        std::lock_guard<std::mutex> lock(idleMutex);
+    }
+    idleCv.notify_all();
+    if (worker.joinable())
+        worker.join();
+
+    this->reactor->add(this);
+}
+
+fun serial::Hardware::detach() -> void {
+    if (not isAttached)
+        return;
+
+    reactor->remove(this);
+    reactor.reset();
+    isAttached = false;
+    worker = std::thread(&Hardware::work, this);
+}
+
+fun serial::Hardware::setHotplug(std::shared_ptr<Hotplug> hotplug) -> void {
+    if (val manager = std::atomic_exchange(&this->hotplug, hotplug))
+        manager->remove(this);
+
+    if (hotplug)
+        hotplug->add(this);
+}
+
+fun serial::Hardware::setSilenceFraming(bool enable, std::chrono::microseconds gap) -> void {
+    silenceUs = not enable ? 0 : gap.count() > 0 ? gap.count() : t35(speed).count();
+}
+
+fun serial::Hardware::t35(speed_t speed) -> std::chrono::microseconds {
+    val baud = tools::baud_rate(speed);
+    if (baud <= 0 or baud > 19200)
+        return 1750us;
+
+    return std::chrono::microseconds(35 * 11 * 100'000 / baud);
+}
+
+fun serial::Hardware::wireTime(speed_t speed, size_t bytes) -> std::chrono::nanoseconds {
+    val baud = tools::baud_rate(speed);
+    if (baud <= 0)
+        return {};
+
+    return std::chrono::nanoseconds(int64_t(bytes) * 10 * 1'000'000'000 / baud);
+}
+
+fun serial::Hardware::setBaudRate(int baud) -> void {
+    {
+        std::lock_guard<std::mutex> lock(connectMutex);
+        speed = speed_t(baud);
+    }
+    if (isConnected())
+        reconnect();
+}
+
+fun serial::Hardware::setPort(std::string port) -> void {
+    std::lock_guard<std::mutex> lock(connectMutex);
+    this->port = std::move(port);
+}
+
+fun serial::Hardware::getPort() const -> std::string {
+    std::lock_guard<std::mutex> lock(connectMutex);
+    return port;
 }
 
 fun serial::Hardware::work() -> void {
-    size_t rxIndex = 0;
-    val launch_callback = [this] (const CallbackList& callbackList, byte_view receivedMessage) {
-        if (callbackList.empty())
-            return;
+    while (isRunning and not isAttached) {
+        // no virtual calls here, a subclass may still be under construction
+        if (fd < 0) {
+            std::unique_lock<std::mutex> lock(idleMutex);
+            idleCv.wait_for(lock, timeout.load(), [this] { return not isRunning or isAttached or fd >= 0; });
+            continue;
+        }
+
+        if (not waitReadable())
+            continue;
+
+        std::unique_lock<std::mutex> lock(rxMutex);
+        val n = process();
+        lock.unlock();
+
+        // disconnected, not dispatched either: the subclass may already be destroyed
+        if (n < 0)
+            Hardware::disconnect();
+    }
+}
+
+fun serial::Hardware::waitReadable() -> bool {
+    val deadline = silenceDeadline();
+    val now = std::chrono::steady_clock::now();
+    val wait = deadline == std::chrono::steady_clock::time_point::max() 
+        ? std::chrono::nanoseconds(timeout.load()) 
+        : std::max(std::chrono::nanoseconds(deadline - now), std::chrono::nanoseconds(0));
+
+    // wait for data, or for the line to go silent long enough to end the frame
+    struct pollfd pfd = {fd, POLLIN, 0};
+    struct timespec ts = {time_t(wait.count() / 1'000'000'000), long(wait.count() % 1'000'000'000)};
+    val res = ::ppoll(&pfd, 1, &ts, nullptr);
+    if (res > 0)
+        return true;
+
+    if (res == 0) {
+        std::lock_guard<std::mutex> lock(rxMutex);
+        if (std::chrono::steady_clock::now() >= silenceDeadline())
+            closeFrame();
+    }
+    return false;
+}
+
+fun serial::Hardware::silenceDeadline() const -> std::chrono::steady_clock::time_point {
+    val gap = silenceUs.load();
+    if (gap == 0 or rxBuffer.empty())
+        return std::chrono::steady_clock::time_point::max();
+
+    return lastRx + std::chrono::microseconds(gap);
+}
+
+fun serial::Hardware::process() -> ssize_t {
+    val silence = silenceUs > 0;
+
+    // the bytes received before a long enough silence are a frame of their own
+    if (silence and std::chrono::steady_clock::now() >= silenceDeadline())
+        closeFrame();
+
+    val n = tryRead();
+    if (n <= 0)
+        return n;
+
+    // a gap is measured between reads while a frame is still pending
+    val now = std::chrono::steady_clock::now();
+    if (rxBuffer.size() > size_t(n))
+        interByteGap.record(now - lastRx);
+
+    bytesReceived += n;
+    lastRx = now;
+    rxChunks[rxChunkCount++ % rxChunks.size()] = {rxConsumed + rxBuffer.size(), now};
+    if (not silence)
+        decodeFrames();
+
+    return n;
+}
+
+fun serial::Hardware::decodeFrames() -> void {
+    while (true) {
+        val [begin, end] = tryDecode();
+        if (end == 0) {
+            if (begin > 0)
+                consume(begin);
+            bytesDiscarded += begin;
+            break;
+        }
+
+        consume(end);
+        bytesDiscarded += begin;
+        ++framesDecoded;
+    }
+}
+
+fun serial::Hardware::closeFrame() -> void {
+    val length = rxBuffer.size();
+    if (length == 0)
+        return;
+
+    // one decode attempt per codec on the whole frame
+    var decoded = false;
+    {
+        val buffer = rxBuffer.view();
+        for (val &handler in rxTable()) {
+            var receivedMessage = handler->codec->decode(buffer);
+            if (receivedMessage.empty())
+                continue;
+
+            deliver(handler, receivedMessage, 0);
+            decoded = true;
+        }
+    }
+
+    if (decoded) {
+        consume(length);
+        ++framesDecoded;
+        return;
+    }
+
+    // mis-framed, e.g. frames that were read at once: search the bytes as a stream,
+    // whatever is left can't be continued after the silence
+    decodeFrames();
+    bytesDiscarded += rxBuffer.size();
+    consume(rxBuffer.size());
+}
+
+fun serial::Hardware::tryRead() -> ssize_t {
+    // closed while the reader waited, nothing to read until the next connect wakes it
+    val dev = fd.load();
+    if (dev < 0)
+        return 0;
+
+    // buffer is full without any complete frame, drop the oldest bytes to make room for the pending ones
+    if (rxBuffer.full()) {
+        int pending = 0;
+        ::ioctl(dev, FIONREAD, &pending);
+
+        val n = etl::clamp(size_t(pending), size_t(1), rxBuffer.size());
+        consume(n);
+        bytesDiscarded += n;
+        ++overflows;
+    }
+
+    size_t length;
+    val ptr = rxBuffer.reserve(length);
+    val n = read(dev, ptr, length);
+    if (n > 0)
+        rxBuffer.commit(n);
+
+    if (val sink = n > 0 ? getCapture() : nullptr)
+        sink->append(Capture::RX, ptr, n);
+    
+    return n;
+}
+
+fun serial::Hardware::deliver(const std::shared_ptr<MessageHandler>& handler, byte_view receivedMessage, size_t begin) -> void {
+    // one copy into a pooled block, shared from here on
+    val frame = framePool->share(std::move(receivedMessage));
+
+    val run_callbacks = not std::atomic_load(&handler->callbackSnapshot)->empty();
+
+    // the callbacks run on the dispatcher, the aliasing pointer keeps the handler alive until they are done
+    if (run_callbacks)
+        getDispatcher()->dispatch(std::shared_ptr<const Dispatcher::FrameTask>(handler, &handler->runCallbacks), frame);
+
+    // response latency is recorded before the frame is visible to the receivers
+    frameComplete();
+    std::lock_guard<std::mutex> lock(handler->mtx);
+    if (not handler->messages.push({++handler->seq, arrival(begin), lastRx, frame}, messageQueueCapacity))
+        ++messagesDropped;
+
+    handler->cv.notify_all();
+}
+
+fun serial::Hardware::MessageQueue::push(Message message, size_t capacity) -> bool {
+    // a new capacity keeps the newest frames
+    if (slots.size() != capacity) {
+        var resized = std::vector<Message>(capacity);
+        val n = std::min(count, capacity);
+        for (val i in etl::range(n))
+            resized[i] = std::move(slots[(head + count - n + i) % slots.size()]);
         
-        std::ignore = std::async(std::launch::async, [this, &callbackList, receivedMessage] {
-            for (var &callback in callbackList)
-                callback(receivedMessage.copy());
-        });
+        slots = std::move(resized);
+        head = 0;
+        count = n;
+    }
+
+    var res = true;
+    if (count == slots.size()) {
+        head = (head + 1) % slots.size();
+        --count;
+        res = false;
+    }
+
+    slots[(head + count) % slots.size()] = std::move(message);
+    ++count;
+    return res;
+}
+
+fun serial::Hardware::MessageQueue::take(std::vector<Message>& res, size_t max, const std::function<bool(const Message&)>& match) -> void {
+    var kept = size_t(0);
+    for (val i in etl::range(count)) {
+        var &message = slots[(head + i) % slots.size()];
+        if (res.size() < max and match(message)) {
+            res.push_back(std::move(message));
+        } else {
+            if (kept != i)
+                slots[(head + kept) % slots.size()] = std::move(message);
+            ++kept;
+        }
+    }
+    count = kept;
+}
+
+fun serial::Hardware::tryDecode() -> std::pair<size_t, size_t> {
+    using Framing = abstract::Codec::Framing;
+    val &handlers = rxTable();
+    val buffer = rxBuffer.view();
+
+    // advance the incremental framing of a codec from its frame start until it has a complete frame,
+    // needs more bytes, or turns out to be unsupported
+    val advance = [this, &buffer] (MessageHandler& handler) {
+        while (handler.framing == Framing::NEED_MORE and handler.end <= buffer.len()) {
+            val res = handler.codec->frame(byte_view{buffer.data() + handler.start, buffer.len() - handler.start});
+            if (res.status == Framing::COMPLETE) {
+                var receivedMessage = handler.codec->decode(byte_view{buffer.data() + handler.start, res.length});
+                if (receivedMessage.empty()) {
+                    handler.start += 1;
+                    continue;
+                }
+                handler.framing = Framing::COMPLETE;
+                handler.end = handler.start + res.length;
+                handler.frame = framePool->share(std::move(receivedMessage)); // rxBuffer may move on before delivery
+            }
+            elif (res.status == Framing::NEED_MORE) {
+                handler.end = buffer.len() + std::max(res.length, size_t(1));
+            }
+            elif (res.status == Framing::DISCARD) {
+                handler.start += std::min(std::max(res.length, size_t(1)), buffer.len() - handler.start);
+                handler.end = handler.start == buffer.len() ? buffer.len() + 1 : 0;
+            }
+            else {
+                handler.framing = Framing::UNSUPPORTED;
+            }
+        }
     };
-            
-    val try_decode = [&, this] {
-        for (val i in etl::range(rxIndex + 1)) {
-            val len = rxIndex + 1 - i;
-            var processed = false;
-
-            codecMutex.lock();
-            for (var &handler in messageHandlers) {
-                var receivedMessage = handler->codec->decode(byte_view{rxBuffer + i, len});
-                if (receivedMessage.empty())
+
+    // codecs with incremental framing jump straight to their next complete frame
+    var framedEnd = buffer.len() + 1;
+    var discard = buffer.len(); ///< leading bytes that none of the codecs is interested in
+    var unframed = false;
+    for (var &handler in handlers) {
+        advance(*handler);
+        if (handler->framing == Framing::UNSUPPORTED)
+            unframed = true;
+        else
+            discard = std::min(discard, handler->start);
+
+        if (handler->framing == Framing::COMPLETE)
+            framedEnd = std::min(framedEnd, handler->end);
+    }
+
+    // the other codecs search the earliest frame ending before that, resuming from their own scan cursor,
+    // so windows that have already been rejected are never decoded again
+    var begin = framedEnd;
+    var end = framedEnd;
+    if (unframed) {
+        // codecs with a finder carry their search state from one read to the next
+        for (var &handler in handlers) if (handler->framing == Framing::UNSUPPORTED and handler->finder) {
+            val found = handler->finder->find(buffer);
+            if (found.length > 0)
+                end = std::min(end, found.begin + found.length);
+        }
+
+        var scanned = buffer.len();
+        for (val &handler in handlers) if (handler->framing == Framing::UNSUPPORTED and not handler->finder)
+            scanned = std::min(scanned, handler->cursor);
+
+        for (val e in etl::range(scanned + 1, std::min(buffer.len(), end) + 1)) {
+            for (var &handler in handlers) {
+                if (handler->framing != Framing::UNSUPPORTED or handler->finder or e <= handler->cursor)
                     continue;
                 
-                processed = true;
-                launch_callback(handler->callbacks, receivedMessage.copy());
-                
-                std::lock_guard<std::mutex> lock(handler->mtx);
-                handler->message = receivedMessage.copy();
-                handler->cv.notify_one();
+                handler->cursor = e;
+                for (val i in etl::range(e)) {
+                    var receivedMessage = handler->codec->decode(byte_view{buffer.data() + i, e - i});
+                    if (receivedMessage.empty())
+                        continue;
+                    
+                    begin = std::min(begin, i);
+                    deliver(handler, receivedMessage, i);
+                    break;
+                }
+            }
+
+            if (begin < e) {
+                end = e;
+                break;
             }
-            codecMutex.unlock();
-            
-            if (not processed) 
-                continue;
-            
-            rxIndex = 0;
-            return;
         }
 
-        rxIndex++;
-        rxIndex %= sizeof(rxBuffer);
-    };
+        for (var &handler in handlers) if (handler->framing == Framing::UNSUPPORTED and handler->finder) {
+            val found = handler->finder->find(buffer);
+            if (found.length > 0 and found.begin + found.length == end) {
+                begin = std::min(begin, found.begin);
+                deliver(handler, found.message, found.begin);
+            }
+        }
+    }
 
-    val try_read = [&, this] {
-        std::scoped_lock lock(rxMutex);
-        return read(fd, rxBuffer + rxIndex, 1);
-    };
+    // no frame, the leading bytes can only be dropped if every codec has skipped them
+    if (end > buffer.len())
+        return {unframed ? 0 : discard, 0};
 
-    while (isRunning) {
-        if (not isConnected()) {
-            std::this_thread::sleep_for(1ms);
-            continue;
-        }
+    for (var &handler in handlers) if (handler->framing == Framing::COMPLETE and handler->end == end) {
+        begin = std::min(begin, handler->start);
+        deliver(handler, handler->frame, handler->start);
+    }
+
+    // returns the begin and end offset of the frame, or {discard, 0} if there is none
+    return {begin, end};
+}
 
-        val n = try_read();
+fun serial::Hardware::consume(size_t n) -> void {
+    // drop the first n bytes of rxBuffer and shift the scan cursors accordingly
+    rxBuffer.consume(n);
+    rxConsumed += n;
+    for (val &handler in rxTable()) {
+        handler->cursor = handler->cursor > n ? handler->cursor - n : 0;
+        if (handler->finder)
+            handler->finder->consume(n);
 
-        // success
-        if (n > 0) 
-            try_decode();
-        
-        // timeout
-        elif (n == 0)
-            continue;
+        // the frame start is gone, start framing again from the new begin of rxBuffer
+        if (handler->start < n) {
+            handler->framing = abstract::Codec::Framing::NEED_MORE;
+            handler->start = 0;
+            handler->end = 0;
+            handler->frame = {};
+        } else {
+            handler->start -= n;
+            handler->end = handler->end > n ? handler->end - n : 0;
+        }
+    }
+}
 
-        // disconnected
-        else 
-            disconnect();
+fun serial::Hardware::arrival(size_t offset) const -> std::chrono::steady_clock::time_point {
+    // the byte arrived with the first remembered read that ended after it
+    val pos = rxConsumed + offset;
+    val first = rxChunkCount > rxChunks.size() ? rxChunkCount - rxChunks.size() : 0;
+    for (val k in etl::range(first, rxChunkCount)) {
+        val &chunk = rxChunks[k % rxChunks.size()];
+        if (chunk.end > pos)
+            return chunk.time;
     }
+    return lastRx;
+}
+
+fun serial::Hardware::sent(size_t bytes) -> void {
+    val now = std::chrono::steady_clock::now();
+    lastTx = now.time_since_epoch().count();
+
+    // bytes still queued in the driver from an earlier write go out first
+    val drained = std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(txDrained.load()));
+    txDrained = (std::max(drained, now) + wireTime(speed, bytes)).time_since_epoch().count();
+    awaitingResponse = true;
+}
+
+fun serial::Hardware::frameComplete() -> void {
+    // the first frame completed after a write is its response
+    val tx = lastSent();
+    if (awaitingResponse and lastRx >= tx and awaitingResponse.exchange(false))
+        responseLatency.record(lastRx - tx);
+}
+
+fun serial::Hardware::lastSent() const -> std::chrono::steady_clock::time_point {
+    return std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(lastTx.load()));
 }
 
 extern "C" {
@@ -296,12 +1060,22 @@ extern "C" {
     typedef void* nexus_serial_hardware_callback_id_t;
     typedef void* nexus_codec_id_t;
     typedef void* nexus_codec_t;
+    typedef void* nexus_serial_reactor_t;
+    typedef void* nexus_serial_dispatcher_t;
+    typedef void* nexus_serial_hotplug_t;
+    typedef void* nexus_serial_arbiter_t;
+    typedef void* nexus_serial_capture_t;
 
     nexus_serial_hardware_t nexus_serial_hardware_new(const char* port, speed_t speed, int timeout, nexus_codec_t codec) {
         return new serial::Hardware(port, speed, std::chrono::milliseconds(timeout), 
             std::shared_ptr<abstract::Codec>(static_cast<abstract::Codec*>(codec)));
     }
 
+    nexus_serial_hardware_t nexus_serial_hardware_new_with_rx_buffer(const char* port, speed_t speed, int timeout, nexus_codec_t codec, size_t rx_buffer_size) {
+        return new serial::Hardware(port, speed, std::chrono::milliseconds(timeout), 
+            std::shared_ptr<abstract::Codec>(static_cast<abstract::Codec*>(codec)), rx_buffer_size);
+    }
+
     int nexus_serial_hardware_send_codec(nexus_serial_hardware_t ser, nexus_codec_t codec, const uint8_t* buffer, size_t length) {
         return static_cast<serial::Hardware*>(ser)->sendCodec(
             std::shared_ptr<abstract::Codec>(static_cast<abstract::Codec*>(codec)), 
@@ -340,4 +1114,50 @@ extern "C" {
         static_cast<serial::Hardware*>(ser)->removeCallback(*reinterpret_cast<serial::Hardware::CallbackId*>(callback));
         ::free(callback);
     }
-}
\ No newline at end of file
+
+    void nexus_serial_hardware_attach(nexus_serial_hardware_t ser, nexus_serial_reactor_t reactor) {
+        static_cast<serial::Hardware*>(ser)->attach(*static_cast<std::shared_ptr<serial::Reactor>*>(reactor));
+    }
+
+    void nexus_serial_hardware_detach(nexus_serial_hardware_t ser) {
+        static_cast<serial::Hardware*>(ser)->detach();
+    }
+
+    void nexus_serial_hardware_set_hotplug(nexus_serial_hardware_t ser, nexus_serial_hotplug_t hotplug) {
+        static_cast<serial::Hardware*>(ser)->setHotplug(hotplug ? *static_cast<std::shared_ptr<serial::Hotplug>*>(hotplug) : nullptr);
+    }
+
+    void nexus_serial_hardware_set_arbiter(nexus_serial_hardware_t ser, nexus_serial_arbiter_t arbiter) {
+        static_cast<serial::Hardware*>(ser)->setArbiter(arbiter ? *static_cast<std::shared_ptr<serial::Arbiter>*>(arbiter) : nullptr);
+    }
+
+    void nexus_serial_hardware_set_capture(nexus_serial_hardware_t ser, nexus_serial_capture_t capture) {
+        static_cast<serial::Hardware*>(ser)->setCapture(capture ? *static_cast<std::shared_ptr<serial::Capture>*>(capture) : nullptr);
+    }
+
+    void nexus_serial_hardware_set_dispatcher(nexus_serial_hardware_t ser, nexus_serial_dispatcher_t dispatcher) {
+        static_cast<serial::Hardware*>(ser)->setDispatcher(*static_cast<std::shared_ptr<serial::Dispatcher>*>(dispatcher));
+    }
+
+    void nexus_serial_hardware_set_baud_rate(nexus_serial_hardware_t ser, int baud) {
+        static_cast<serial::Hardware*>(ser)->setBaudRate(baud);
+    }
+
+    void nexus_serial_hardware_set_silence_framing(nexus_serial_hardware_t ser, int enable, int gap_us) {
+        static_cast<serial::Hardware*>(ser)->setSilenceFraming(enable, std::chrono::microseconds(gap_us));
+    }
+
+    void nexus_serial_hardware_set_message_queue_capacity(nexus_serial_hardware_t ser, size_t capacity) {
+        static_cast<serial::Hardware*>(ser)->setMessageQueueCapacity(capacity);
+    }
+
+    int nexus_serial_hardware_send_codec_async(nexus_serial_hardware_t ser, nexus_codec_t codec, const uint8_t* buffer, size_t length, void (*callback)(int res)) {
+        // the codec is owned by the caller
+        val queued = static_cast<serial::Hardware*>(ser)->sendAsync(
+            std::shared_ptr<abstract::Codec>(std::shared_ptr<abstract::Codec>(), static_cast<abstract::Codec*>(codec)), 
+            byte_view{buffer, length},
+            callback ? serial::Hardware::SendCallback(callback) : nullptr
+        );
+        return queued ? 0 : -1;
+    }
+}
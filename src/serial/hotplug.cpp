@@ -0,0 +1,213 @@
+#include "nexus/serial/hotplug.h"
+#include "nexus/tools/detect_virtual_comm.h"
+#include <sys/inotify.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <poll.h>
+#include <algorithm>
+#include <cstring>
+#include <etl/keywords.h>
+
+using namespace nexus;
+
+serial::Hotplug::Hotplug(std::string dir, std::chrono::milliseconds minBackoff, std::chrono::milliseconds maxBackoff)
+    : dir(std::move(dir))
+    , minBackoff(std::max(minBackoff, std::chrono::milliseconds(1)))
+    , maxBackoff(std::max(maxBackoff, this->minBackoff))
+{
+    infd = ::inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
+    evfd = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    ::inotify_add_watch(infd, this->dir.c_str(), IN_CREATE | IN_DELETE | IN_ATTRIB | IN_MOVED_TO | IN_MOVED_FROM);
+
+    worker = std::thread(&Hotplug::work, this);
+}
+
+serial::Hotplug::~Hotplug() {
+    isRunning = false;
+    uint64_t one = 1;
+    std::ignore = ::write(evfd, &one, sizeof(one));
+    worker.join();
+
+    ::close(evfd);
+    ::close(infd);
+}
+
+fun serial::Hotplug::ports() -> std::vector<std::string> {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    if (stale) {
+        cache = tools::detectVirtualComm(dir);
+        stale = false;
+        ++scans;
+    }
+    return cache;
+}
+
+fun serial::Hotplug::len() const -> size_t {
+    std::lock_guard<std::mutex> lock(mtx);
+    return entries.size();
+}
+
+fun serial::Hotplug::json() const -> std::string {
+    return "{"
+        "\"dir\": \"" + dir + "\", "
+        "\"ports\": " + std::to_string(len()) + ", "
+        "\"events\": " + std::to_string(events) + ", "
+        "\"scans\": " + std::to_string(scans) + ", "
+        "\"attempts\": " + std::to_string(attempts) + ", "
+        "\"reconnects\": " + std::to_string(reconnects) +
+    "}";
+}
+
+fun serial::Hotplug::add(Hardware* ser) -> void {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        val next = ser->isConnected() ? std::chrono::steady_clock::time_point::max() : std::chrono::steady_clock::now();
+        entries[ser] = {next, minBackoff};
+    }
+    uint64_t one = 1;
+    std::ignore = ::write(evfd, &one, sizeof(one));
+}
+
+fun serial::Hotplug::remove(Hardware* ser) -> void {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        entries.erase(ser);
+    }
+
+    // the watcher thread may still be reconnecting this port
+    std::lock_guard<std::mutex> lockAttempt(attemptMutex);
+}
+
+fun serial::Hotplug::wake(Hardware* ser) -> void {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        val it = entries.find(ser);
+        if (it == entries.end())
+            return;
+
+        it->second.next = std::chrono::steady_clock::now();
+    }
+    uint64_t one = 1;
+    std::ignore = ::write(evfd, &one, sizeof(one));
+}
+
+fun serial::Hotplug::work() -> void {
+    while (isRunning) {
+        struct pollfd fds[2] = {{infd, POLLIN, 0}, {evfd, POLLIN, 0}};
+        ::poll(fds, 2, waitTimeout());
+
+        if (fds[0].revents & POLLIN)
+            readEvents();
+
+        if (fds[1].revents & POLLIN) {
+            uint64_t value;
+            std::ignore = ::read(evfd, &value, sizeof(value));
+        }
+
+        if (isRunning)
+            reconnectDue();
+    }
+}
+
+fun serial::Hotplug::readEvents() -> void {
+    alignas(struct inotify_event) char buf[4096];
+    var changed = false;
+    var appeared = false;
+
+    while (true) {
+        val n = ::read(infd, buf, sizeof(buf));
+        if (n <= 0)
+            break;
+
+        for (ssize_t i = 0; i < n;) {
+            val event = reinterpret_cast<const struct inotify_event*>(buf + i);
+            i += sizeof(struct inotify_event) + event->len;
+            if (event->len == 0 or ::strncmp(event->name, "tty", 3) != 0)
+                continue;
+
+            ++events;
+            changed = true;
+            appeared = appeared or (event->mask & (IN_CREATE | IN_ATTRIB | IN_MOVED_TO));
+        }
+    }
+
+    if (changed) {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        stale = true;
+    }
+
+    // a device showed up, the disconnected ports skip their backoff
+    if (appeared) {
+        std::lock_guard<std::mutex> lock(mtx);
+        val now = std::chrono::steady_clock::now();
+        for (var &[ser, entry] in entries) if (entry.next != std::chrono::steady_clock::time_point::max())
+            entry.next = now;
+    }
+}
+
+fun serial::Hotplug::waitTimeout() const -> int {
+    std::lock_guard<std::mutex> lock(mtx);
+    var next = std::chrono::steady_clock::time_point::max();
+    for (val &[ser, entry] in entries)
+        next = std::min(next, entry.next);
+
+    if (next == std::chrono::steady_clock::time_point::max())
+        return -1;
+
+    // round up, waking up early would only spin
+    val wait = std::chrono::ceil<std::chrono::milliseconds>(next - std::chrono::steady_clock::now());
+    return std::max(int(wait.count()), 0);
+}
+
+fun serial::Hotplug::reconnectDue() -> void {
+    while (true) {
+        Hardware* ser = nullptr;
+        std::unique_lock<std::mutex> lockAttempt;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            val now = std::chrono::steady_clock::now();
+            val it = std::find_if(entries.begin(), entries.end(), [now] (val &item) { return item.second.next <= now; });
+            if (it == entries.end())
+                return;
+
+            ser = it->first;
+            it->second.next = std::chrono::steady_clock::time_point::max();
+            lockAttempt = std::unique_lock<std::mutex>(attemptMutex);
+        }
+
+        // opening the device may block, no lock is held that a port's callers could wait for
+        var connected = ser->isConnected();
+        if (not connected) {
+            ++attempts;
+            connected = ser->connect();
+            reconnects += connected;
+        }
+
+        // the port is not touched anymore, it is only looked up by address
+        lockAttempt.unlock();
+        std::lock_guard<std::mutex> lock(mtx);
+        val it = entries.find(ser);
+        if (it == entries.end())
+            continue;
+
+        var &entry = it->second;
+        if (connected) {
+            entry.backoff = minBackoff;
+        } elif (entry.next == std::chrono::steady_clock::time_point::max()) {
+            entry.next = std::chrono::steady_clock::now() + entry.backoff;
+            entry.backoff = std::min(entry.backoff * 2, maxBackoff);
+        }
+    }
+}
+
+extern "C" {
+    typedef void* nexus_serial_hotplug_t;
+
+    nexus_serial_hotplug_t nexus_serial_hotplug_new() {
+        return new std::shared_ptr<serial::Hotplug>(std::make_shared<serial::Hotplug>());
+    }
+
+    void nexus_serial_hotplug_delete(nexus_serial_hotplug_t hotplug) {
+        delete static_cast<std::shared_ptr<serial::Hotplug>*>(hotplug);
+    }
+}
@@ -0,0 +1,175 @@
+#include "nexus/serial/reactor.h"
+#include "nexus/serial/hotplug.h"
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <algorithm>
+#include <etl/keywords.h>
+
+using namespace nexus;
+
+serial::Reactor::Reactor(size_t n_threads) {
+    epfd = ::epoll_create1(EPOLL_CLOEXEC);
+    evfd = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+
+    // the stop event stays readable, waking every thread at once
+    epoll_event ev = {};
+    ev.events = EPOLLIN;
+    ev.data.ptr = nullptr;
+    ::epoll_ctl(epfd, EPOLL_CTL_ADD, evfd, &ev);
+
+    for (size_t i = 0; i < std::max(n_threads, size_t(1)); ++i)
+        workers.emplace_back(&Reactor::work, this);
+}
+
+serial::Reactor::~Reactor() {
+    isRunning = false;
+    uint64_t one = 1;
+    std::ignore = ::write(evfd, &one, sizeof(one));
+
+    for (var &worker in workers)
+        worker.join();
+
+    ::close(evfd);
+    ::close(epfd);
+}
+
+fun serial::Reactor::len() const -> size_t {
+    std::lock_guard<std::mutex> lock(mtx);
+    return ports.size();
+}
+
+fun serial::Reactor::add(Hardware* ser) -> void {
+    std::lock_guard<std::mutex> lock(mtx);
+    ports.insert(ser);
+    if (ser->isConnected())
+        arm(ser, EPOLL_CTL_ADD);
+}
+
+fun serial::Reactor::remove(Hardware* ser) -> void {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        ports.erase(ser);
+        deadlines.erase(ser);
+        if (ser->isConnected())
+            ::epoll_ctl(epfd, EPOLL_CTL_DEL, ser->fd, nullptr);
+    }
+
+    // a reactor thread may still be processing this port
+    std::lock_guard<std::mutex> lockRx(ser->rxMutex);
+}
+
+fun serial::Reactor::arm(Hardware* ser, int op) -> void {
+    // one shot, so only one thread at a time handles a port and its frames stay in order
+    epoll_event ev = {};
+    ev.events = EPOLLIN | EPOLLONESHOT;
+    ev.data.ptr = ser;
+    if (::epoll_ctl(epfd, op, ser->fd, &ev) < 0 and op == EPOLL_CTL_ADD and errno == EEXIST)
+        ::epoll_ctl(epfd, EPOLL_CTL_MOD, ser->fd, &ev);
+}
+
+fun serial::Reactor::schedule(Hardware* ser, std::chrono::steady_clock::time_point deadline) -> void {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (ports.count(ser) == 0 or deadline == std::chrono::steady_clock::time_point::max())
+        deadlines.erase(ser);
+    else
+        deadlines[ser] = deadline;
+}
+
+fun serial::Reactor::waitTimeout() const -> int {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (deadlines.empty())
+        return -1;
+
+    var deadline = std::chrono::steady_clock::time_point::max();
+    for (val &[ser, d] in deadlines)
+        deadline = std::min(deadline, d);
+
+    // round up, waking up early would only spin
+    val wait = std::chrono::ceil<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+    return std::max(int(wait.count()), 0);
+}
+
+fun serial::Reactor::closeSilentFrames() -> void {
+    while (true) {
+        Hardware* ser = nullptr;
+        std::unique_lock<std::mutex> lockRx;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            val now = std::chrono::steady_clock::now();
+            val it = std::find_if(deadlines.begin(), deadlines.end(), [now] (val &item) { return item.second <= now; });
+            if (it == deadlines.end())
+                return;
+
+            ser = it->first;
+            deadlines.erase(it);
+            lockRx = std::unique_lock<std::mutex>(ser->rxMutex);
+        }
+
+        if (std::chrono::steady_clock::now() >= ser->silenceDeadline())
+            ser->closeFrame();
+
+        val deadline = ser->silenceDeadline();
+        lockRx.unlock();
+        schedule(ser, deadline);
+    }
+}
+
+fun serial::Reactor::work() -> void {
+    epoll_event events[16];
+
+    while (isRunning) {
+        val n = ::epoll_wait(epfd, events, 16, waitTimeout());
+        ++wakeups_;
+
+        for (int i = 0; i < n; ++i) {
+            var ser = static_cast<Hardware*>(events[i].data.ptr);
+            if (ser == nullptr)
+                continue;
+
+            // hold the port's rx lock, so it can not be removed while being processed
+            std::unique_lock<std::mutex> lockRx;
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                if (ports.count(ser) == 0)
+                    continue;
+
+                lockRx = std::unique_lock<std::mutex>(ser->rxMutex);
+            }
+
+            if (not ser->isConnected())
+                continue;
+
+            // disconnected, the closed fd is dropped from the epoll set by the kernel
+            // the hotplug manager is woken without the port's lock, it only takes the port as a key
+            if (ser->process() < 0) {
+                val manager = ser->disconnectRx() ? std::atomic_load(&ser->hotplug) : nullptr;
+                lockRx.unlock();
+                if (manager)
+                    manager->wake(ser);
+                continue;
+            }
+
+            arm(ser, EPOLL_CTL_MOD);
+
+            // silence framing: the frame ends if nothing else arrives before the deadline
+            val deadline = ser->silenceDeadline();
+            lockRx.unlock();
+            schedule(ser, deadline);
+        }
+
+        closeSilentFrames();
+    }
+}
+
+extern "C" {
+    typedef void* nexus_serial_reactor_t;
+
+    nexus_serial_reactor_t nexus_serial_reactor_new(size_t n_threads) {
+        return new std::shared_ptr<serial::Reactor>(std::make_shared<serial::Reactor>(n_threads));
+    }
+
+    void nexus_serial_reactor_delete(nexus_serial_reactor_t reactor) {
+        delete static_cast<std::shared_ptr<serial::Reactor>*>(reactor);
+    }
+}
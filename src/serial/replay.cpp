@@ -0,0 +1,199 @@
+#include "nexus/serial/replay.h"
+#include "nexus/tools/json.h"
+#include <sys/socket.h>
+#include <sys/ioctl.h>
+#include <linux/sockios.h>
+#include <unistd.h>
+#include <poll.h>
+#include <etl/keywords.h>
+
+using namespace nexus;
+
+serial::Replay::Replay(std::string path, std::shared_ptr<abstract::Codec> codec, bool realtime, std::chrono::milliseconds timeout, size_t rxBufferSize)
+    : Hardware(-1, std::move(path), B0, timeout, std::move(codec), rxBufferSize)
+    , realtime(realtime)
+{
+    start();
+}
+
+serial::Replay::~Replay() {
+    // the port goes first, it would read the end of the stream otherwise
+    disconnect();
+    stop();
+}
+
+fun serial::Replay::json() const -> std::string {
+    var finished = false;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        finished = isFinished;
+    }
+    return tools::json_concat(Hardware::json(), "{"
+        "\"replay\": {"
+            "\"realtime\": " + std::string(realtime ? "true" : "false") + ", "
+            "\"chunks\": " + std::to_string(chunks_) + ", "
+            "\"bytes\": " + std::to_string(bytes_) + ", "
+            "\"finished\": " + std::string(finished ? "true" : "false") + ", "
+            "\"txDiscarded\": " + std::to_string(txDiscarded) +
+        "}"
+    "}");
+}
+
+fun serial::Replay::reconnect() -> void {
+    disconnect();
+    stop();
+    start();
+}
+
+fun serial::Replay::wait(std::chrono::milliseconds timeout) -> bool {
+    std::unique_lock<std::mutex> lock(mtx);
+    return cv.wait_for(lock, timeout, [this] { return isFinished; });
+}
+
+fun serial::Replay::start() -> void {
+    int fds[2];
+    if (::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) != 0)
+        return;
+
+    peer = fds[1];
+    chunks_ = 0;
+    bytes_ = 0;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        isPlaying = true;
+        isFinished = false;
+    }
+    adopt(fds[0]);
+    player = std::thread(&Replay::play, this);
+}
+
+fun serial::Replay::stop() -> void {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        isPlaying = false;
+    }
+    cv.notify_all();
+    if (player.joinable())
+        player.join();
+
+    if (peer >= 0)
+        ::close(peer);
+    peer = -1;
+}
+
+fun serial::Replay::play() -> void {
+    var reader = Capture::Reader(port);
+    var chunk = Capture::Reader::Chunk{};
+    var first = std::chrono::nanoseconds(-1);
+    val begin = std::chrono::steady_clock::now();
+
+    while (reader.next(chunk)) {
+        if (chunk.direction != Capture::RX)
+            continue;
+
+        if (first.count() < 0)
+            first = chunk.time;
+
+        // the captured gaps are kept, a stop request cuts the wait short
+        if (realtime) {
+            std::unique_lock<std::mutex> lock(mtx);
+            cv.wait_until(lock, begin + (chunk.time - first), [this] { return not isPlaying; });
+        }
+
+        if (not feed(chunk.data, chunk.length))
+            break;
+
+        ++chunks_;
+        bytes_ += chunk.length;
+    }
+
+    // finished once the port has read every byte, not when they are merely queued in the socket
+    for (int queued = 0; ::ioctl(peer, SIOCOUTQ, &queued) == 0 and queued > 0;) {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (not isPlaying)
+                break;
+        }
+        if (not drain(1))
+            break;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        isFinished = true;
+    }
+    cv.notify_all();
+
+    // a capture has no device to answer, what the port sends is dropped until the replay stops or the port closes
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (not isPlaying)
+                break;
+        }
+        if (not drain(50))
+            break;
+    }
+}
+
+fun serial::Replay::feed(const uint8_t* data, size_t length) -> bool {
+    var written = size_t(0);
+    while (written < length) {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (not isPlaying)
+                return false;
+        }
+
+        // the port may be writing to us as well, neither side may block the other
+        struct pollfd pfd = {peer, POLLOUT | POLLIN, 0};
+        if (::poll(&pfd, 1, 50) <= 0)
+            continue;
+
+        if ((pfd.revents & POLLIN) and not drain(0))
+            return false;
+
+        if (pfd.revents & (POLLHUP | POLLERR))
+            return false;
+
+        if (not (pfd.revents & POLLOUT))
+            continue;
+
+        val n = ::send(peer, data + written, length - written, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (n < 0 and (errno == EAGAIN or errno == EINTR))
+            continue;
+        if (n < 0)
+            return false;
+
+        written += n;
+    }
+    return true;
+}
+
+fun serial::Replay::drain(int timeout) -> bool {
+    struct pollfd pfd = {peer, POLLIN, 0};
+    if (::poll(&pfd, 1, timeout) <= 0 or not (pfd.revents & POLLIN))
+        return true;
+
+    uint8_t buf[4096];
+    val n = ::recv(peer, buf, sizeof(buf), MSG_DONTWAIT);
+    if (n > 0)
+        txDiscarded += n;
+
+    // the port closed its end
+    return n != 0;
+}
+
+extern "C" {
+    typedef void* nexus_serial_hardware_t;
+    typedef void* nexus_codec_t;
+
+    nexus_serial_hardware_t nexus_serial_replay_new(const char* path, nexus_codec_t codec, int realtime) {
+        return static_cast<serial::Hardware*>(new serial::Replay(path,
+            std::shared_ptr<abstract::Codec>(static_cast<abstract::Codec*>(codec)), realtime != 0));
+    }
+
+    int nexus_serial_replay_wait(nexus_serial_hardware_t replay, int timeout) {
+        return static_cast<serial::Replay*>(static_cast<serial::Hardware*>(replay))->wait(std::chrono::milliseconds(timeout));
+    }
+}
@@ -0,0 +1,224 @@
+#include "nexus/serial/simulator.h"
+#include "nexus/serial/hardware.h"
+#include <algorithm>
+#include <map>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#include <termios.h>
+#include <etl/keywords.h>
+
+using namespace nexus;
+using namespace std::literals;
+
+serial::Simulator::Simulator(std::shared_ptr<abstract::Codec> codec, Responder responder)
+    : Simulator(std::move(codec), std::move(responder), true)
+{}
+
+serial::Simulator::Simulator(std::shared_ptr<abstract::Codec> codec, Responder responder, bool start)
+    : codec(codec ? std::move(codec) : std::make_shared<Hardware::Codec>())
+    , responder(std::move(responder))
+{
+    master = ::posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0)
+        return;
+
+    char name[64] = {};
+    if (::grantpt(master) != 0 or ::unlockpt(master) != 0 or ::ptsname_r(master, name, sizeof(name)) != 0) {
+        ::close(master);
+        master = -1;
+        return;
+    }
+
+    // raw until the port configures the line itself, nothing is echoed back in the meantime
+    slave = ::open(name, O_RDWR | O_NOCTTY);
+    if (slave >= 0) {
+        struct termios tty = {};
+        ::tcgetattr(slave, &tty);
+        ::cfmakeraw(&tty);
+        ::tcsetattr(slave, TCSANOW, &tty);
+    }
+
+    port_ = name;
+    if (start)
+        this->start();
+}
+
+serial::Simulator::~Simulator() {
+    stop();
+
+    if (slave >= 0)
+        ::close(slave);
+    if (master >= 0)
+        ::close(master);
+}
+
+fun serial::Simulator::start() -> void {
+    if (master < 0 or worker.joinable())
+        return;
+
+    isRunning = true;
+    worker = std::thread(&Simulator::work, this);
+}
+
+fun serial::Simulator::stop() -> void {
+    isRunning = false;
+    if (worker.joinable())
+        worker.join();
+}
+
+fun serial::Simulator::echo() -> Responder {
+    return [] (byte_view request) { return request.to_vector(); };
+}
+
+fun serial::Simulator::script(const std::vector<std::pair<byte_view, byte_view>>& replies) -> Responder {
+    var table = std::make_shared<std::map<std::vector<uint8_t>, std::vector<uint8_t>>>();
+    for (val &[request, reply] in replies)
+        (*table)[request.to_vector()] = reply.to_vector();
+
+    return [table] (byte_view request) {
+        val it = table->find(request.to_vector());
+        return it == table->end() ? std::vector<uint8_t>() : it->second;
+    };
+}
+
+fun serial::Simulator::setDelay(std::chrono::microseconds delay) -> void {
+    setDelay(Delay([delay] { return delay; }));
+}
+
+fun serial::Simulator::setDelay(Delay delay) -> void {
+    std::lock_guard<std::mutex> lock(delayMutex);
+    this->delay = std::move(delay);
+}
+
+fun serial::Simulator::inject(byte_view buffer) -> int {
+    std::lock_guard<std::mutex> lock(txMutex);
+    var written = size_t(0);
+    while (written < buffer.len()) {
+        val n = ::write(master, buffer.data() + written, buffer.len() - written);
+        if (n < 0 and errno == EINTR)
+            continue;
+        if (n < 0)
+            return -1;
+        written += n;
+    }
+    return int(written);
+}
+
+fun serial::Simulator::json() const -> std::string {
+    return "{"
+        "\"port\": \"" + port_ + "\", "
+        "\"requests\": " + std::to_string(requests_) + ", "
+        "\"replies\": " + std::to_string(replies_) + ", "
+        "\"bytesReceived\": " + std::to_string(bytesReceived) + ", "
+        "\"bytesDiscarded\": " + std::to_string(bytesDiscarded) +
+    "}";
+}
+
+fun serial::Simulator::work() -> void {
+    uint8_t buf[4096];
+    while (isRunning) {
+        struct pollfd pfd = {master, POLLIN, 0};
+        if (::poll(&pfd, 1, 50) <= 0 or not (pfd.revents & POLLIN))
+            continue;
+
+        val n = ::read(master, buf, sizeof(buf));
+        if (n <= 0)
+            continue;
+
+        bytesReceived += n;
+        rxBuffer.insert(rxBuffer.end(), buf, buf + n);
+        decodeRequests();
+    }
+}
+
+fun serial::Simulator::decodeRequests() -> void {
+    using Framing = abstract::Codec::Framing;
+
+    while (not rxBuffer.empty()) {
+        val buffer = byte_view{rxBuffer.data(), rxBuffer.size()};
+        val res = codec->frame(buffer);
+
+        var consumed = size_t(0);
+        if (res.status == Framing::COMPLETE) {
+            val request = codec->decode(byte_view{rxBuffer.data(), res.length});
+            if (request.empty()) {
+                consumed = 1;
+                ++bytesDiscarded;
+            } else {
+                reply(request);
+                consumed = res.length;
+            }
+        }
+        elif (res.status == Framing::DISCARD) {
+            consumed = std::min(std::max(res.length, size_t(1)), rxBuffer.size());
+            bytesDiscarded += consumed;
+        }
+        elif (res.status == Framing::UNSUPPORTED) {
+            // the burst read at once is the frame, a partial burst waits for the rest
+            val request = codec->decode(buffer);
+            if (not request.empty()) {
+                reply(request);
+                consumed = rxBuffer.size();
+            } elif (rxBuffer.size() >= 4096) {
+                consumed = rxBuffer.size();
+                bytesDiscarded += consumed;
+            }
+        }
+
+        if (consumed == 0)
+            break;
+
+        rxBuffer.erase(rxBuffer.begin(), rxBuffer.begin() + consumed);
+    }
+}
+
+fun serial::Simulator::reply(byte_view request) -> void {
+    ++requests_;
+    val res = responder ? responder(request) : std::vector<uint8_t>();
+    if (res.empty())
+        return;
+
+    var wait = std::chrono::microseconds(0);
+    {
+        std::lock_guard<std::mutex> lock(delayMutex);
+        if (delay)
+            wait = delay();
+    }
+    if (wait.count() > 0)
+        std::this_thread::sleep_for(wait);
+
+    // counted before it is written, the port may see the reply before the write returns
+    ++replies_;
+    if (inject(codec->encode(res)) < 0)
+        --replies_;
+}
+
+extern "C" {
+    typedef void* nexus_serial_simulator_t;
+    typedef void* nexus_codec_t;
+
+    nexus_serial_simulator_t nexus_serial_simulator_new_echo(nexus_codec_t codec) {
+        // the codec is owned by the caller
+        return new serial::Simulator(
+            codec ? std::shared_ptr<abstract::Codec>(std::shared_ptr<abstract::Codec>(), static_cast<abstract::Codec*>(codec)) : nullptr,
+            serial::Simulator::echo()
+        );
+    }
+
+    void nexus_serial_simulator_delete(nexus_serial_simulator_t sim) {
+        delete static_cast<serial::Simulator*>(sim);
+    }
+
+    const char* nexus_serial_simulator_port(nexus_serial_simulator_t sim) {
+        return static_cast<serial::Simulator*>(sim)->port().c_str();
+    }
+
+    void nexus_serial_simulator_set_delay(nexus_serial_simulator_t sim, int delay_us) {
+        static_cast<serial::Simulator*>(sim)->setDelay(std::chrono::microseconds(delay_us));
+    }
+
+    int nexus_serial_simulator_inject(nexus_serial_simulator_t sim, const uint8_t* buffer, size_t length) {
+        return static_cast<serial::Simulator*>(sim)->inject(byte_view{buffer, length});
+    }
+}
@@ -2,6 +2,8 @@
 #include "nexus/tools/detect_virtual_comm.h"
 #include "nexus/tools/json.h"
 #include <future>
+#include <algorithm>
+#include <cctype>
 #include <fcntl.h>   /* File Control Definitions */
 #include <unistd.h>  /* UNIX Standard Definitions */
 #include <etl/keywords.h>
@@ -13,18 +15,35 @@ serial::Software::Software(std::shared_ptr<Hardware> ser) : Hardware::Interface(
 serial::Software::Software(std::shared_ptr<Hardware> ser, std::shared_ptr<abstract::Codec> codec) : Hardware::Interface(ser, codec) {}
 
 serial::Software::Software(Args args) 
-    : Hardware::Interface(std::make_shared<Hardware>(args.port, args.speed, args.timeout, args.codec)) 
+    : Hardware::Interface(std::make_shared<Hardware>(args.port, args.speed, args.timeout, args.codec, args.rxBufferSize)) 
 {}
 
 fun serial::Software::post(std::string_view method_name, std::string_view json_string) -> std:: string {
     val json = tools::json_parse(json_string);
     if (method_name == "reconnect") {
-        val port = json["port"].to_string_or(ser_->port.c_str());
-        val speed = json["speed"].to_string();
-        val timeout = json["timeout"].to_int_or(ser_->timeout.count());
+        val current = ser_->getPort();
+        val port = json["port"].to_string_or(current.c_str());
+        val speed = json["speed"];
+        val timeout = json["timeout"].to_int_or(ser_->timeout.load().count());
 
-        ser_->port = std::string(port.data(), port.len());
-        ser_->speed = speed == "B115200" ? B115200 : speed == "B9600" ? B9600 : speed == "B57600" ? B57600 : ser_->speed;
+        // a baud rate, e.g. 3000000, or the name of a termios constant, e.g. "B115200"
+        var baud = ser_->baudRate();
+        if (speed.is_number()) {
+            baud = speed.to_int();
+        } elif (speed.is_string()) {
+            val name = std::string(speed.to_string().begin(), speed.to_string().end());
+            val digits = not name.empty() and name[0] == 'B' ? name.substr(1) : name;
+            if (std::all_of(digits.begin(), digits.end(), ::isdigit) and not digits.empty())
+                baud = std::stoi(digits);
+            else
+                return tools::json_response_status_fail_mismatch_value_type();
+        }
+
+        if (baud <= 0)
+            return tools::json_response_status_fail_mismatch_value_type();
+
+        ser_->setPort(std::string(port.data(), port.len()));
+        ser_->speed = speed_t(baud);
         ser_->timeout = std::chrono::milliseconds(timeout);
         reconnect();
         return tools::json_response_status_success("Request to reconnect serial communication");
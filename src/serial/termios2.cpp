@@ -0,0 +1,19 @@
+// termios2 is only declared by the kernel headers, whose struct termios clashes with the one of <termios.h>,
+// so this translation unit includes neither <termios.h> nor nexus/tools/baud_rate.h
+#include <asm/termbits.h>
+#include <sys/ioctl.h>
+
+namespace Project::nexus::tools {
+
+    bool set_custom_baud_rate(int fd, int baud) {
+        struct termios2 tty = {};
+        if (baud <= 0 || ::ioctl(fd, TCGETS2, &tty) != 0)
+            return false;
+
+        tty.c_cflag &= ~(CBAUD | (CBAUD << IBSHIFT));
+        tty.c_cflag |= BOTHER | (BOTHER << IBSHIFT);
+        tty.c_ospeed = baud;
+        tty.c_ispeed = baud;
+        return ::ioctl(fd, TCSETS2, &tty) == 0;
+    }
+}
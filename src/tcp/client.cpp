@@ -78,19 +78,23 @@ fun tcp::Client::isConnected() const -> bool {
     return client_socket >= 0;
 }
 
-fun tcp::Client::request(nexus::byte_view buffer) -> nexus::byte_view {
+fun tcp::Client::transmit(nexus::byte_view buffer) -> bool {
     if (setup_error != Error::NONE) 
-        return set_error_(nexus::byte_view(), setup_error);
+        return set_error_(false, setup_error);
 
-    var n = ::send(client_socket, buffer.data(), buffer.size(), 0);
+    val n = ::send(client_socket, buffer.data(), buffer.size(), 0);
     if (n <= 0)
-        return set_error_(nexus::byte_view(), Error::SEND);
+        return set_error_(false, Error::SEND);
+
+    return receiveTimeout(args.timeout);
+}
 
-    if (not receiveTimeout(args.timeout))
+fun tcp::Client::request(nexus::byte_view buffer) -> nexus::byte_view {
+    if (not transmit(buffer))
         return {};
 
     std::vector<uint8_t> res(MAX_HANDLE_SZ);
-    n = ::recv(client_socket, res.data(), MAX_HANDLE_SZ, 0);
+    val n = ::recv(client_socket, res.data(), MAX_HANDLE_SZ, 0);
     if (n <= 0)
         return set_error_(nexus::byte_view(), Error::RECV);
 
@@ -98,6 +102,69 @@ fun tcp::Client::request(nexus::byte_view buffer) -> nexus::byte_view {
     return set_error_(std::move(res), Error::NONE);
 }
 
+fun tcp::Client::request(nexus::byte_view buffer, tools::FrameBuffer& res) -> bool {
+    res.reset();
+    if (not transmit(buffer))
+        return false;
+
+    val n = ::recv(client_socket, res.put(MAX_HANDLE_SZ), MAX_HANDLE_SZ, 0);
+    res.trim(n > 0 ? MAX_HANDLE_SZ - n : MAX_HANDLE_SZ);
+    if (n <= 0)
+        return set_error_(false, Error::RECV);
+
+    return set_error_(true, Error::NONE);
+}
+
+fun tcp::Client::send(nexus::byte_view buffer) -> bool {
+    if (setup_error != Error::NONE) 
+        return set_error_(false, setup_error);
+
+    if (client_socket < 0)
+        return set_error_(false, Error::SOCKET);
+
+    for (var sent = size_t(0); sent < buffer.len();) {
+        val n = ::send(client_socket, buffer.data() + sent, buffer.len() - sent, 0);
+        if (n > 0) {
+            sent += n;
+            continue;
+        }
+        if (n < 0 and (errno == EWOULDBLOCK or errno == EAGAIN)) {
+            // the socket buffer is full, wait for room
+            fd_set write_fds;
+            FD_ZERO(&write_fds);
+            FD_SET(client_socket, &write_fds);
+
+            struct timeval tv;
+            tv.tv_sec = args.timeout.count() / 1000;
+            tv.tv_usec = (args.timeout.count() % 1000) * 1000;
+
+            if (::select(client_socket + 1, nullptr, &write_fds, nullptr, &tv) > 0)
+                continue;
+        }
+        return set_error_(false, Error::SEND);
+    }
+    return set_error_(true, Error::NONE);
+}
+
+fun tcp::Client::receive(tools::FrameBuffer& res, std::chrono::milliseconds timeout) -> bool {
+    if (setup_error != Error::NONE) 
+        return set_error_(false, setup_error);
+
+    if (client_socket < 0)
+        return set_error_(false, Error::SOCKET);
+
+    if (not receiveTimeout(timeout))
+        return false;
+
+    constexpr size_t chunk = 512;
+    val n = ::recv(client_socket, res.put(chunk), chunk, 0);
+    res.trim(n > 0 ? chunk - n : chunk);
+    if (n <= 0)
+        return set_error_(false, Error::RECV);
+
+    return set_error_(true, Error::NONE);
+}
+
 fun tcp::Client::receiveTimeout(std::chrono::milliseconds timeout) -> bool {
     fd_set readfds;
     FD_ZERO(&readfds);
@@ -108,7 +175,7 @@ fun tcp::Client::receiveTimeout(std::chrono::milliseconds timeout) -> bool {
     tv.tv_usec = (timeout.count() % 1000) * 1000;
 
     auto res = select(client_socket + 1, &readfds, nullptr, nullptr, &tv) > 0;
-    return set_error_(res, res ? Error::RECV_TIMEOUT : Error::NONE);
+    return set_error_(res, res ? Error::NONE : Error::RECV_TIMEOUT);
 }
 
 extern "C" {
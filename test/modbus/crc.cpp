@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include "nexus/modbus/api.h"
+#include <random>
 #include <etl/keywords.h>
 
 static unsigned int crc(unsigned char * data, unsigned char length) {
@@ -41,3 +42,30 @@ TEST(modbus, crc) {
     }
 
 }
+
+TEST(modbus, crc_kernels) {
+    using nexus::modbus::api::CrcKernel;
+
+    var rng = std::mt19937(7);
+    var data = std::vector<uint8_t>(70000);
+    for (var& byte in data)
+        byte = rng();
+
+    // every tail length and offset around the 16 and 64 byte blocks, and large buffers
+    var lengths = std::vector<size_t>();
+    for (var len = size_t(0); len <= 300; ++len)
+        lengths.push_back(len);
+    for (val len in {1023, 4096, 65536, 65537})
+        lengths.push_back(len);
+
+    for (val len in lengths) {
+        for (val offset in {0, 1, 7}) {
+            val buffer = nexus::byte_view{data.data() + offset, len};
+            val expected = len <= 255 ? crc(data.data() + offset, len) : nexus::modbus::api::crc(buffer, CrcKernel::TABLE);
+            ASSERT_EQ(nexus::modbus::api::crc(buffer, CrcKernel::TABLE), expected) << len;
+            ASSERT_EQ(nexus::modbus::api::crc(buffer, CrcKernel::SLICING), expected) << len;
+            ASSERT_EQ(nexus::modbus::api::crc(buffer, CrcKernel::CLMUL), expected) << len;
+            ASSERT_EQ(nexus::modbus::api::crc(buffer), expected) << len;
+        }
+    }
+}
@@ -0,0 +1,146 @@
+#include <gtest/gtest.h>
+#include "nexus/modbus/api.h"
+#include "nexus/serial/hardware.h"
+#include "pty_fixture.h"
+#include <unistd.h>
+#include <thread>
+#include <etl/keywords.h>
+
+using Framing = nexus::abstract::Codec::Framing;
+
+TEST(modbus, framing) {
+    val codec = nexus::modbus::api::Codec();
+    val request_pdu = std::vector<uint8_t>({0xf8, 0x04, 0x00, 0x00, 0x00, 0x0a});
+    val response_pdu = std::vector<uint8_t>({0xf8, 0x04, 0x04, 0x08, 0xae, 0x28, 0xc3});
+    val exception_pdu = std::vector<uint8_t>({0xf8, 0x84, 0x02});
+    val request = codec.encode(request_pdu).to_vector();
+    val response = codec.encode(response_pdu).to_vector();
+
+    // read input registers request
+    var res = codec.frame(request);
+    EXPECT_EQ(res.status, Framing::COMPLETE);
+    EXPECT_EQ(res.length, 8);
+
+    res = codec.frame(nexus::byte_view{request.data(), 5});
+    EXPECT_EQ(res.status, Framing::NEED_MORE);
+    EXPECT_EQ(res.length, 3);
+
+    // read input registers response, the length comes from the byte count
+    res = codec.frame(response);
+    EXPECT_EQ(res.status, Framing::COMPLETE);
+    EXPECT_EQ(res.length, 9);
+
+    res = codec.frame(nexus::byte_view{response.data(), 2});
+    EXPECT_EQ(res.status, Framing::NEED_MORE);
+
+    // a frame followed by the next one
+    var stream = request;
+    stream.insert(stream.end(), response.begin(), response.end());
+    res = codec.frame(stream);
+    EXPECT_EQ(res.status, Framing::COMPLETE);
+    EXPECT_EQ(res.length, 8);
+
+    // exception response
+    res = codec.frame(codec.encode(exception_pdu));
+    EXPECT_EQ(res.status, Framing::COMPLETE);
+    EXPECT_EQ(res.length, 5);
+
+    // corrupted crc
+    var corrupted = request;
+    corrupted.back() ^= 0xff;
+    corrupted.insert(corrupted.end(), {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0});
+    EXPECT_EQ(codec.frame(corrupted).status, Framing::DISCARD);
+
+    // unknown function code
+    EXPECT_EQ(codec.frame({0xf8, 0x41, 0x00, 0x00}).status, Framing::UNSUPPORTED);
+}
+
+TEST(modbus, encode_into) {
+    val codec = nexus::modbus::api::Codec();
+    val pdu = std::vector<uint8_t>({0xf8, 0x04, 0x00, 0x00, 0x00, 0x0a});
+
+    // the crc goes into the tailroom, the same bytes as encode()
+    var frame = nexus::tools::FrameBuffer(64);
+    frame.assign(pdu, codec.headroom(), codec.tailroom());
+    val data = frame.data();
+    codec.encodeInto(frame);
+    EXPECT_EQ(frame.view(), codec.encode(pdu));
+    EXPECT_EQ(frame.data(), data);
+
+    // decoded in place
+    val res = codec.decodeView(frame.view());
+    EXPECT_EQ(res, nexus::byte_view(pdu));
+    EXPECT_EQ(res.data(), frame.data());
+    EXPECT_FALSE(res.is_owning());
+
+    frame.data()[2] ^= 1;
+    EXPECT_TRUE(codec.decodeView(frame.view()).empty());
+
+    // codecs without in-place framing copy encode()
+    struct Line : nexus::abstract::Codec {
+        nexus::byte_view encode(nexus::byte_view buffer) const override { return std::string(buffer.to_string()) + "\n"; }
+    };
+    frame.assign(std::string_view("ping"));
+    Line().encodeInto(frame);
+    EXPECT_EQ(frame.view().to_string(), "ping\n");
+}
+
+TEST(serial, framing) {
+    val codec = nexus::serial::Hardware::Codec();
+
+    var res = codec.frame(std::string_view("hello\nworld\n"));
+    EXPECT_EQ(res.status, Framing::COMPLETE);
+    EXPECT_EQ(res.length, 6);
+
+    res = codec.frame(std::string_view("hello"));
+    EXPECT_EQ(res.status, Framing::NEED_MORE);
+}
+
+TEST(modbus, frame_finder) {
+    val codec = nexus::modbus::api::Codec();
+    val vendor = codec.encode({0xf8, 0x41, 0x01, 0x02, 0x03}).to_vector(); // function code without a known layout
+    val response = codec.encode({0xf8, 0x04, 0x04, 0x08, 0xae, 0x28, 0xc3}).to_vector();
+
+    var stream = std::vector<uint8_t>({0x00, 0x13, 0x37});
+    stream.insert(stream.end(), vendor.begin(), vendor.end());
+    stream.insert(stream.end(), response.begin(), response.end());
+
+    // fed a byte at a time, the found frame is a view into the pending bytes
+    var finder = nexus::modbus::api::FrameFinder();
+    var pending = std::vector<uint8_t>();
+    var frames = std::vector<std::vector<uint8_t>>();
+    for (val byte in stream) {
+        pending.push_back(byte);
+        val found = finder.find(pending);
+        if (found.length == 0)
+            continue;
+
+        EXPECT_EQ(found.message.data(), pending.data() + found.begin);
+        frames.push_back(found.message.to_vector());
+        pending.erase(pending.begin(), pending.begin() + found.begin + found.length);
+        finder.consume(found.begin + found.length);
+    }
+    ASSERT_EQ(frames.size(), 2);
+    EXPECT_EQ(frames[0], std::vector<uint8_t>({0xf8, 0x41, 0x01, 0x02, 0x03}));
+    EXPECT_EQ(frames[1], std::vector<uint8_t>({0xf8, 0x04, 0x04, 0x08, 0xae, 0x28, 0xc3}));
+    EXPECT_TRUE(pending.empty());
+
+    // candidates don't outlive the maximum frame length
+    var noise = nexus::modbus::api::FrameFinder(16);
+    var bytes = std::vector<uint8_t>();
+    for (var i = 0; i < 64; ++i)
+        bytes.push_back(uint8_t(i * 37 + 11));
+    noise.find(bytes);
+    EXPECT_LE(noise.live(), 16);
+
+    // the port finds the vendor frame split over two reads, after the known layouts gave up on it
+    val pty = nexus::test::Pty();
+    ASSERT_TRUE(pty.isOpen());
+    {
+        var ser = nexus::serial::Hardware(pty.name, B115200, std::chrono::milliseconds(200), std::make_shared<nexus::modbus::api::Codec>());
+        ASSERT_EQ(::write(pty.master, vendor.data(), 4), 4);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        ASSERT_EQ(::write(pty.master, vendor.data() + 4, vendor.size() - 4), ssize_t(vendor.size() - 4));
+        EXPECT_EQ(ser.receive().to_vector(), std::vector<uint8_t>({0xf8, 0x41, 0x01, 0x02, 0x03}));
+    }
+}
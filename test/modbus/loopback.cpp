@@ -0,0 +1,166 @@
+#include "gtest/gtest.h"
+#include "nexus/loopback/client.h"
+#include "nexus/modbus/loopback/client.h"
+#include "nexus/modbus/rtu/server.h"
+#include <thread>
+#include <etl/keywords.h>
+
+using namespace std::literals;
+
+TEST(loopback, serial) {
+    // raw bytes, a receive takes everything sent so far
+    {
+        val [a, b] = nexus::loopback::Serial::pair(nullptr, 16, 20ms);
+        EXPECT_EQ(a->send(std::string_view("ping")), 4);
+        EXPECT_EQ(b->receive().to_string(), "ping");
+        EXPECT_TRUE(b->receive().empty());
+
+        // more than the ring buffer holds goes through while the other end reads
+        val big = std::string(100, 'x');
+        var received = std::string();
+        var reader = std::thread([&, b = b] {
+            while (received.size() < big.size()) {
+                val res = b->receive();
+                if (res.empty())
+                    break;
+                received += res.to_string();
+            }
+        });
+        EXPECT_EQ(a->send(big), 100);
+        reader.join();
+        EXPECT_EQ(received, big);
+
+        a->disconnect();
+        EXPECT_FALSE(b->isConnected());
+        EXPECT_EQ(b->send(std::string_view("pong")), -1);
+        a->reconnect();
+        EXPECT_EQ(b->send(std::string_view("pong")), 4);
+        EXPECT_EQ(a->receive().to_string(), "pong");
+    }
+
+    // framed by the codec, frames that don't pass the filter and corrupted bytes are dropped
+    {
+        val [a, b] = nexus::loopback::Serial::pair(std::make_shared<nexus::modbus::api::Codec>(), 64, 20ms);
+        a->send({0x01, 0x06, 0x00, 0x10, 0x12, 0x34});
+        a->send({0x02, 0x06, 0x00, 0x10, 0x12, 0x34});
+        EXPECT_EQ(b->receive([] (nexus::byte_view res) { return res[0] == 0x02; }).to_vector(),
+            std::vector<uint8_t>({0x02, 0x06, 0x00, 0x10, 0x12, 0x34}));
+        EXPECT_EQ(b->received(), 2);
+
+        var client = nexus::loopback::Client(b);
+        var server = std::thread([a = a] {
+            val req = a->receive();
+            a->send(req);
+        });
+        EXPECT_EQ(client.request({0x01, 0x05, 0x00, 0x01, 0xFF, 0x00}).to_vector(), std::vector<uint8_t>({0x01, 0x05, 0x00, 0x01, 0xFF, 0x00}));
+        server.join();
+        EXPECT_NE(a->json().find("\"sent\": 3"), std::string::npos) << a->json();
+    }
+}
+
+TEST(modbus, loopback) {
+    val [a, b] = nexus::loopback::Serial::pair(std::make_shared<nexus::modbus::api::Codec>(), 4096, 20ms);
+
+    uint16_t reg = 0x1234;
+    var server = nexus::modbus::rtu::Server(0x01);
+    server.HoldingRegisterGetter(0x0010, [&reg] { return reg; });
+    server.HoldingRegisterSetter(0x0010, [&reg] (uint16_t value) { reg = value; });
+    var listener = std::thread([&server, b = b] { server.serve(b); });
+
+    var client = nexus::modbus::loopback::Client(0x01, a);
+    EXPECT_EQ(client.ReadHoldingRegisters(0x0010, 1), std::vector<uint16_t>({0x1234}));
+    EXPECT_EQ(client.WriteSingleRegister(0x0010, 0xABCD), 0xABCD);
+    EXPECT_EQ(reg, 0xABCD);
+    for (var i = 0; i < 1000; ++i)
+        ASSERT_EQ(client.ReadHoldingRegisters(0x0010, 1), std::vector<uint16_t>({0xABCD}));
+    EXPECT_EQ(b->received(), 1002);
+
+    uint16_t res[2] = {};
+    EXPECT_EQ(client.ReadHoldingRegisters(0x0010, 1, res), 1);
+    EXPECT_EQ(res[0], 0xABCD);
+
+    // unknown registers are not answered
+    EXPECT_TRUE(client.ReadHoldingRegisters(0x0020, 1).empty());
+    EXPECT_EQ(client.error(), nexus::modbus::Error::TIMEOUT);
+
+    server.stop();
+    listener.join();
+    EXPECT_FALSE(server.isRunning());
+}
+
+TEST(modbus, loopback_async) {
+    val [a, b] = nexus::loopback::Serial::pair(std::make_shared<nexus::modbus::api::Codec>(), 4096, 20ms);
+
+    uint16_t reg = 0x1234;
+    var server = nexus::modbus::rtu::Server(0x01);
+    server.HoldingRegisterGetter(0x0010, [&reg] { return reg; });
+    server.HoldingRegisterSetter(0x0010, [&reg] (uint16_t value) { reg = value; });
+    var listener = std::thread([&server, b = b] { server.serve(b); });
+
+    {
+        // the transactions of the client run on a shared dispatcher, in the order they are queued
+        var client = nexus::modbus::loopback::Client(0x01, a);
+        client.setDispatcher(std::make_shared<nexus::serial::Dispatcher>(1, 64, nexus::serial::Dispatcher::BLOCK));
+        val deadline = std::chrono::steady_clock::now() + 1s;
+
+        var write = client.WriteSingleRegisterAsync(0x0010, 0xABCD, deadline);
+        var read = client.ReadHoldingRegistersAsync(0x0010, 1, deadline);
+        EXPECT_EQ(write.get().value, 0xABCD);
+        val res = read.get();
+        EXPECT_EQ(res.error, nexus::modbus::Error::NONE);
+        EXPECT_EQ(res.value, std::vector<uint16_t>({0xABCD}));
+
+        var completed = std::promise<nexus::modbus::Error>();
+        EXPECT_TRUE(client.ReadHoldingRegistersAsync(0x0020, 1, deadline, [&completed] (nexus::modbus::api::Response<std::vector<uint16_t>> res) {
+            completed.set_value(res.error);
+        }));
+        EXPECT_EQ(completed.get_future().get(), nexus::modbus::Error::TIMEOUT);
+
+        // the transactions of a plan complete together, a failed one only empties its own ranges
+        val plan = client.ReadAsync(nexus::modbus::api::ReadPlan().HoldingRegisters(0x0010, 1).HoldingRegisters(0x0030, 1), deadline).get();
+        EXPECT_EQ(plan.error, nexus::modbus::Error::TIMEOUT);
+        EXPECT_EQ(plan.value.HoldingRegisters(0x0010, 1), std::vector<uint16_t>({0xABCD}));
+        EXPECT_TRUE(plan.value.HoldingRegisters(0x0030, 1).empty());
+
+        // async calls leave the error of the blocking ones alone
+        EXPECT_EQ(client.error(), nexus::modbus::Error::NONE);
+    }
+
+    {
+        // transactions dropped by the dispatcher complete with TIMEOUT, the client still goes
+        var dispatcher = std::make_shared<nexus::serial::Dispatcher>(1, 1, nexus::serial::Dispatcher::DROP_OLDEST);
+        var client = nexus::modbus::loopback::Client(0x01, a);
+        client.setDispatcher(dispatcher);
+        val deadline = std::chrono::steady_clock::now() + 1s;
+
+        var started = std::promise<void>();
+        var release = std::promise<void>();
+        dispatcher->dispatch([&started, released = release.get_future().share()] { started.set_value(); released.wait(); });
+        started.get_future().wait();
+
+        var reads = std::vector<std::future<nexus::modbus::api::Response<std::vector<uint16_t>>>>();
+        for (int i = 0; i < 4; ++i)
+            reads.push_back(client.ReadHoldingRegistersAsync(0x0010, 1, deadline));
+
+        for (int i = 0; i < 3; ++i) {
+            EXPECT_EQ(reads[i].wait_for(0s), std::future_status::ready);
+            EXPECT_EQ(reads[i].get().error, nexus::modbus::Error::TIMEOUT);
+        }
+
+        release.set_value();
+        EXPECT_EQ(reads[3].get().error, nexus::modbus::Error::NONE);
+        EXPECT_EQ(client.ReadHoldingRegisters(0x0010, 1), std::vector<uint16_t>({0xABCD}));
+    }
+
+    server.stop();
+    listener.join();
+
+    {
+        // nobody answers, the deadline comes before the timeout of the line
+        val [c, d] = nexus::loopback::Serial::pair(std::make_shared<nexus::modbus::api::Codec>(), 4096, 5s);
+        var client = nexus::modbus::loopback::Client(0x01, c);
+        val start = std::chrono::steady_clock::now();
+        EXPECT_EQ(client.ReadHoldingRegistersAsync(0x0010, 1, start + 50ms).get().error, nexus::modbus::Error::TIMEOUT);
+        EXPECT_LT(std::chrono::steady_clock::now() - start, 1s);
+    }
+}
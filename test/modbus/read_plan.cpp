@@ -0,0 +1,88 @@
+#include "gtest/gtest.h"
+#include "nexus/loopback/serial.h"
+#include "nexus/modbus/loopback/client.h"
+#include "nexus/modbus/rtu/server.h"
+#include <thread>
+#include <etl/keywords.h>
+
+using namespace std::literals;
+
+fun static transactions(const nexus::modbus::api::ReadPlan& plan) {
+    var res = std::vector<std::tuple<int, int, int>>();
+    for (val& t in plan.transactions())
+        res.emplace_back(t.function_code, t.register_address, t.n_register);
+    return res;
+}
+
+TEST(modbus, read_plan) {
+    using namespace nexus::modbus;
+
+    // adjacent and overlapping ranges merge, the others only within the gap
+    var plan = api::ReadPlan(3);
+    plan.HoldingRegisters(0x100a, 6).HoldingRegisters(0x1001, 6).HoldingRegisters(0x3000, 1).HoldingRegisters(0x8000, 1);
+    plan.InputRegisters(0, 10).InputRegisters(5, 10).Coils(0x10, 2).Coils(0x12, 1);
+    EXPECT_EQ(transactions(plan), (std::vector<std::tuple<int, int, int>>({
+        {READ_COILS, 0x10, 3},
+        {READ_HOLDING_REGISTERS, 0x1001, 15},
+        {READ_HOLDING_REGISTERS, 0x3000, 1},
+        {READ_HOLDING_REGISTERS, 0x8000, 1},
+        {READ_INPUT_REGISTERS, 0, 15},
+    })));
+
+    EXPECT_EQ(transactions(api::ReadPlan().HoldingRegisters(0x1001, 6).HoldingRegisters(0x100a, 6)), (std::vector<std::tuple<int, int, int>>({
+        {READ_HOLDING_REGISTERS, 0x1001, 6},
+        {READ_HOLDING_REGISTERS, 0x100a, 6},
+    })));
+
+    // 125 registers per transaction, longer ranges are split
+    EXPECT_EQ(transactions(api::ReadPlan(10).HoldingRegisters(0, 100).HoldingRegisters(105, 100).HoldingRegisters(250, 10)), (std::vector<std::tuple<int, int, int>>({
+        {READ_HOLDING_REGISTERS, 0, 125},
+        {READ_HOLDING_REGISTERS, 125, 80},
+        {READ_HOLDING_REGISTERS, 250, 10},
+    })));
+    EXPECT_EQ(transactions(api::ReadPlan().Coils(0, 2500)), (std::vector<std::tuple<int, int, int>>({
+        {READ_COILS, 0, 2000},
+        {READ_COILS, 2000, 500},
+    })));
+}
+
+TEST(modbus, read_plan_client) {
+    val [a, b] = nexus::loopback::Serial::pair(std::make_shared<nexus::modbus::api::Codec>(), 4096, 20ms);
+
+    var server = nexus::modbus::rtu::Server(0x01);
+    for (val reg in etl::range<uint16_t>(0x1000, 0x1200))
+        server.HoldingRegisterGetter(reg, [reg] { return reg; });
+    for (val reg in etl::range<uint16_t>(4))
+        server.CoilGetter(reg, [reg] { return reg % 2 == 1; });
+    var listener = std::thread([&server, b = b] { server.serve(b); });
+
+    var client = nexus::modbus::loopback::Client(0x01, a);
+    val plan = nexus::modbus::api::ReadPlan(4).HoldingRegisters(0x1001, 6).HoldingRegisters(0x100a, 6).HoldingRegisters(0x1080, 130).Coils(1, 3);
+
+    val res = client.Read(plan);
+    EXPECT_EQ(client.error(), nexus::modbus::Error::NONE);
+    EXPECT_EQ(b->received(), 4);
+    EXPECT_EQ(res.HoldingRegisters(0x100a, 2), std::vector<uint16_t>({0x100a, 0x100b}));
+    EXPECT_EQ(res.HoldingRegisters(0x1007, 1), std::vector<uint16_t>({0x1007}));
+
+    // across the split of the long range
+    val across = res.HoldingRegisters(0x10fb, 7);
+    ASSERT_EQ(across.size(), 7);
+    EXPECT_EQ(across.front(), 0x10fb);
+    EXPECT_EQ(across.back(), 0x1101);
+    EXPECT_TRUE(res.HoldingRegisters(0x10fb, 8).empty());
+
+    EXPECT_EQ(res.Coils(1, 3), std::vector<bool>({true, false, true}));
+    EXPECT_TRUE(res.HoldingRegisters(0x1000, 2).empty());
+    EXPECT_TRUE(res.InputRegisters(0, 1).empty());
+
+    // a failed transaction only empties its own ranges
+    val bad = client.Read(nexus::modbus::api::ReadPlan().HoldingRegisters(0x1001, 2).HoldingRegisters(0x2000, 1));
+    EXPECT_EQ(client.error(), nexus::modbus::Error::TIMEOUT);
+    EXPECT_EQ(bad.error(), nexus::modbus::Error::TIMEOUT);
+    EXPECT_EQ(bad.HoldingRegisters(0x1001, 2), std::vector<uint16_t>({0x1001, 0x1002}));
+    EXPECT_TRUE(bad.HoldingRegisters(0x2000, 1).empty());
+
+    server.stop();
+    listener.join();
+}
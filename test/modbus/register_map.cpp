@@ -0,0 +1,80 @@
+#include "gtest/gtest.h"
+#include "nexus/loopback/serial.h"
+#include "nexus/modbus/loopback/client.h"
+#include "nexus/modbus/rtu/server.h"
+#include "nexus/modbus/register_map.h"
+#include <thread>
+#include <etl/keywords.h>
+
+using namespace std::literals;
+using nexus::modbus::Field;
+using nexus::modbus::WordOrder;
+using nexus::modbus::READ_INPUT_REGISTERS;
+using nexus::modbus::READ_HOLDING_REGISTERS;
+
+static constexpr Field fields[] = {
+    {"threshold", READ_HOLDING_REGISTERS, 0x0001, Field::U16, 1., 0},
+    {"voltage", READ_INPUT_REGISTERS, 0x0000, Field::U16, .1, 1, "V"},
+    {"energy", READ_INPUT_REGISTERS, 0x0005, Field::U32, 1., 0, "Wh", NAN, NAN, WordOrder::LITTLE},
+    {"current", READ_INPUT_REGISTERS, 0x0001, Field::U32, .001, 3, "A", NAN, NAN, WordOrder::LITTLE},
+    {"alarm", READ_INPUT_REGISTERS, 0x0009, Field::BOOL},
+    {"overload", READ_INPUT_REGISTERS, 0x0008, Field::FLAG, 1., 0, "", 0.},
+    {"distance", READ_HOLDING_REGISTERS, 0x0010, Field::I16, .1, 1, "cm", -1., -1.},
+};
+
+using Map = nexus::modbus::RegisterMap<fields, 2>;
+
+// the input registers 0, 1-2, 5-6 and 9 merge across the gaps of 2, the holding registers are too far apart
+static_assert(Map::plan.n_blocks == 3);
+static_assert(Map::plan.blocks[0].function_code == READ_HOLDING_REGISTERS and Map::plan.blocks[0].register_address == 0x0001);
+static_assert(Map::plan.blocks[1].register_address == 0x0010 and Map::plan.blocks[1].n_register == 1);
+static_assert(Map::plan.blocks[2].function_code == READ_INPUT_REGISTERS and Map::plan.blocks[2].n_register == 10);
+static_assert(Map::plan.n_registers == 12);
+static_assert(Map::plan.register_[2] == 2 + 5);
+
+TEST(modbus, register_map) {
+    val [a, b] = nexus::loopback::Serial::pair(std::make_shared<nexus::modbus::api::Codec>(), 4096, 20ms);
+
+    var inputs = std::vector<uint16_t>({2301, 0x86a0, 0x0001, 0, 0, 0x5678, 0x1234, 0, 1, 0xFFFF});
+    var server = nexus::modbus::rtu::Server(0x01);
+    for (val reg in etl::range<uint16_t>(10))
+        server.AnalogInputGetter(reg, [&inputs, reg] { return inputs[reg]; });
+    server.HoldingRegisterGetter(0x0001, [] { return uint16_t(80); });
+    var distance = uint16_t(0xFFFF);
+    server.HoldingRegisterGetter(0x0010, [&distance] { return distance; });
+    var listener = std::thread([&server, b = b] { server.serve(b); });
+
+    var client = nexus::modbus::loopback::Client(0x01, a);
+    var map = Map();
+    EXPECT_EQ(map.json(), R"({"threshold": "NaN", "voltage": "NaN", "energy": "NaN", "current": "NaN", "alarm": false, "overload": false, "distance": -1.0})");
+
+    EXPECT_TRUE(map.update(client));
+    EXPECT_EQ(b->received(), 3);
+    EXPECT_DOUBLE_EQ(map.get("voltage"), 230.1);
+    EXPECT_DOUBLE_EQ(map[2], 0x12345678);
+    EXPECT_EQ(map.json(), R"({"threshold": 80, "voltage": 230.1, "energy": 305419896, "current": 100.000, "alarm": true, "overload": false, "distance": -1.0})");
+
+    // signed
+    distance = 0xFF9C;
+    inputs[9] = 0;
+    EXPECT_TRUE(map.update(client));
+    EXPECT_DOUBLE_EQ(map.get("distance"), -10.);
+    EXPECT_DOUBLE_EQ(map.get("alarm"), 0.);
+    EXPECT_TRUE(std::isnan(map.get("nothing")));
+
+    // a flag is only on at 0xFFFF
+    inputs[8] = 0xFFFF;
+    EXPECT_TRUE(map.update(client));
+    EXPECT_DOUBLE_EQ(map.get("overload"), 1.);
+
+    // a written value shows until the next update
+    EXPECT_TRUE(map.set("threshold", 100));
+    EXPECT_FALSE(map.set("nothing", 100));
+    EXPECT_EQ(map.text(), "threshold = 100, voltage = 230.1 V, energy = 305419896 Wh, current = 100.000 A, alarm = false, overload = true, distance = -10.0 cm");
+
+    // without a server the fields fall back
+    server.stop();
+    listener.join();
+    EXPECT_FALSE(map.update(client));
+    EXPECT_EQ(map.json(), R"({"threshold": "NaN", "voltage": "NaN", "energy": "NaN", "current": "NaN", "alarm": false, "overload": false, "distance": -1.0})");
+}
@@ -58,4 +58,125 @@ TEST(modbus, tcp) {
     server.stop();
     var r = nexus::await | future;
     std::cout << int(r) << (r == nexus::tcp::Server::Error::NONE ? ": Server stop" : ": Server fail to start in the first place")  << std::endl;
-}
\ No newline at end of file
+}
+
+TEST(modbus, tcp_mbap) {
+    val host = std::string("127.0.0.1");
+    val port = 5002;
+
+    var server = nexus::modbus::tcp::Server();
+    var holding_registers = std::vector<uint16_t>({0x0102, 0x0304});
+    server.HoldingRegisterGetter(0x0100, [&holding_registers] { return holding_registers[0];});
+    server.HoldingRegisterGetter(0x0101, [&holding_registers] { return holding_registers[1];});
+    server.HoldingRegisterSetter(0x0100, [&holding_registers] (uint16_t value) { holding_registers[0] = value;});
+
+    var future = std::async(std::launch::async, [&server, host, port] { return server.listen(host, port); });
+    std::this_thread::sleep_for(1ms);
+
+    var client = nexus::modbus::tcp::Client({host, port, 1000ms, nexus::modbus::tcp::Protocol::MBAP, 1});
+    client.WriteSingleRegister(0x0100, 0xabcd);
+    EXPECT_EQ(holding_registers[0], 0xabcd);
+    EXPECT_EQ(client.ReadHoldingRegisters(0x0100, 2), std::vector<uint16_t>({0xabcd, 0x0304}));
+
+    // responses come back in the order of the requests, whatever the window
+    var requests = std::vector<nexus::byte_view>();
+    for (val i in etl::range(10))
+        requests.push_back({1, nexus::modbus::READ_HOLDING_REGISTERS, 0x01, 0x00, 0x00, uint8_t(i % 2 + 1)});
+
+    for (val window in {size_t(1), size_t(4), size_t(16)}) {
+        val res = client.pipeline(requests, window);
+        ASSERT_EQ(res.size(), requests.size());
+        for (val i in etl::range(10)) {
+            if (i % 2 == 0)
+                EXPECT_EQ(res[i], nexus::byte_view({1, 3, 2, 0xab, 0xcd}));
+            else
+                EXPECT_EQ(res[i], nexus::byte_view({1, 3, 4, 0xab, 0xcd, 0x03, 0x04}));
+        }
+    }
+
+    // RTU clients are still served on the same port
+    client.disconnect();
+    var rtu = nexus::modbus::tcp::Client(host, port);
+    EXPECT_EQ(rtu.ReadHoldingRegisters(0x0100, 1), std::vector<uint16_t>({0xabcd}));
+
+    server.stop();
+    nexus::await | future;
+}
+
+/// Blocking read of register 0x0101 from the callback of an asynchronous one, empty if it doesn't return in time
+fun static nested_read(nexus::modbus::tcp::Client& client) -> std::vector<uint16_t> {
+    var nested = std::promise<std::vector<uint16_t>>();
+    var res = nested.get_future();
+    val queued = client.ReadHoldingRegistersAsync(0x0100, 1, std::chrono::steady_clock::now() + 1s, [&client, &nested] (nexus::modbus::api::Response<std::vector<uint16_t>>) {
+        nested.set_value(client.ReadHoldingRegisters(0x0101, 1));
+    });
+    if (not queued or res.wait_for(2s) != std::future_status::ready)
+        return {};
+    return res.get();
+}
+
+TEST(modbus, tcp_async) {
+    val host = std::string("127.0.0.1");
+    val port = 5003;
+
+    var server = nexus::modbus::tcp::Server();
+    var holding_registers = std::vector<uint16_t>({0x0102, 0x0304});
+    server.HoldingRegisterGetter(0x0100, [&holding_registers] { return holding_registers[0];});
+    server.HoldingRegisterGetter(0x0101, [&holding_registers] { return holding_registers[1];});
+    server.HoldingRegisterSetter(0x0100, [&holding_registers] (uint16_t value) { holding_registers[0] = value;});
+
+    var future = std::async(std::launch::async, [&server, host, port] { return server.listen(host, port); });
+    std::this_thread::sleep_for(1ms);
+
+    {
+        var client = nexus::modbus::tcp::Client({host, port, 1000ms, nexus::modbus::tcp::Protocol::MBAP, 1});
+        val deadline = std::chrono::steady_clock::now() + 1s;
+
+        // many in flight at once, each matched to its own response
+        var reads = std::vector<std::future<nexus::modbus::api::Response<std::vector<uint16_t>>>>();
+        for (val i in etl::range(100))
+            reads.push_back(client.ReadHoldingRegistersAsync(0x0100, i % 2 + 1, deadline));
+        for (val i in etl::range(100)) {
+            val res = reads[i].get();
+            EXPECT_EQ(res.error, nexus::modbus::Error::NONE);
+            EXPECT_EQ(res.value, i % 2 == 0 ? std::vector<uint16_t>({0x0102}) : std::vector<uint16_t>({0x0102, 0x0304}));
+        }
+
+        var written = std::promise<nexus::modbus::api::Response<uint16_t>>();
+        EXPECT_TRUE(client.WriteSingleRegisterAsync(0x0100, 0xabcd, deadline, [&written] (nexus::modbus::api::Response<uint16_t> res) {
+            written.set_value(res);
+        }));
+        val res = written.get_future().get();
+        EXPECT_EQ(res.error, nexus::modbus::Error::NONE);
+        EXPECT_EQ(res.value, 0xabcd);
+        EXPECT_EQ(holding_registers[0], 0xabcd);
+
+        // an unanswered request times out at its deadline
+        val unknown = client.ReadHoldingRegistersAsync(0x0200, 1, std::chrono::steady_clock::now() + 50ms).get();
+        EXPECT_EQ(unknown.error, nexus::modbus::Error::TIMEOUT);
+
+        // blocking calls and pipelines go through the reader alongside
+        EXPECT_EQ(client.ReadHoldingRegisters(0x0100, 2), std::vector<uint16_t>({0xabcd, 0x0304}));
+        val pipelined = client.pipeline({{1, nexus::modbus::READ_HOLDING_REGISTERS, 0x01, 0x01, 0x00, 0x01}}, 4);
+        EXPECT_EQ(pipelined[0], nexus::byte_view({1, 3, 2, 0x03, 0x04}));
+
+        // the callback isn't on the reader, a blocking call in it gets its answer
+        EXPECT_EQ(nested_read(client), std::vector<uint16_t>({0x0304}));
+    }
+
+    // RTU framing runs the transactions one at a time on the client's worker
+    {
+        var client = nexus::modbus::tcp::Client(host, port);
+        val res = client.ReadHoldingRegistersAsync(0x0100, 2, std::chrono::steady_clock::now() + 1s).get();
+        EXPECT_EQ(res.error, nexus::modbus::Error::NONE);
+        EXPECT_EQ(res.value, std::vector<uint16_t>({0xabcd, 0x0304}));
+
+        val expired = client.ReadHoldingRegistersAsync(0x0100, 2, std::chrono::steady_clock::now() - 1ms).get();
+        EXPECT_EQ(expired.error, nexus::modbus::Error::TIMEOUT);
+
+        EXPECT_EQ(nested_read(client), std::vector<uint16_t>({0x0304}));
+    }
+
+    server.stop();
+    nexus::await | future;
+}
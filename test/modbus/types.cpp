@@ -0,0 +1,47 @@
+#include "gtest/gtest.h"
+#include "nexus/modbus/types.h"
+#include <etl/keywords.h>
+
+using namespace nexus::modbus;
+
+TEST(modbus, types) {
+    // 0x12345678 as ABCD, CDAB, BADC and DCBA
+    uint16_t abcd[2] = {0x1234, 0x5678};
+    uint16_t cdab[2] = {0x5678, 0x1234};
+    uint16_t badc[2] = {0x3412, 0x7856};
+    uint16_t dcba[2] = {0x7856, 0x3412};
+    EXPECT_EQ((decode<uint32_t>(abcd)), 0x12345678u);
+    EXPECT_EQ((decode<uint32_t, WordOrder::LITTLE>(cdab)), 0x12345678u);
+    EXPECT_EQ((decode<uint32_t, WordOrder::BIG, ByteOrder::LITTLE>(badc)), 0x12345678u);
+    EXPECT_EQ((decode<uint32_t, WordOrder::LITTLE, ByteOrder::LITTLE>(dcba)), 0x12345678u);
+
+    uint16_t res[4] = {};
+    encode<uint32_t, WordOrder::LITTLE>(0x12345678u, res);
+    EXPECT_EQ(res[0], 0x5678);
+    EXPECT_EQ(res[1], 0x1234);
+    encode<uint32_t, WordOrder::LITTLE, ByteOrder::LITTLE>(0x12345678u, res);
+    EXPECT_EQ(res[0], 0x7856);
+    EXPECT_EQ(res[1], 0x3412);
+
+    // signed and floating point values keep their bits
+    uint16_t minus_two[1] = {0xFFFE};
+    EXPECT_EQ(decode<int16_t>(minus_two), -2);
+    uint16_t minus_one[2] = {0xFFFF, 0xFFFF};
+    EXPECT_EQ(decode<int32_t>(minus_one), -1);
+    uint16_t pi[2] = {0x4049, 0x0FDB};
+    EXPECT_FLOAT_EQ(decode<float>(pi), 3.14159265f);
+
+    for (val value in {0.1, -1234.5678, 1e300}) {
+        encode<double, WordOrder::LITTLE>(value, res);
+        EXPECT_EQ((decode<double, WordOrder::LITTLE>(res)), value);
+        encode<double, WordOrder::BIG, ByteOrder::LITTLE>(value, res);
+        EXPECT_EQ((decode<double, WordOrder::BIG, ByteOrder::LITTLE>(res)), value);
+    }
+
+    // consecutive values
+    uint16_t registers[4] = {0x0001, 0x0002, 0x0003, 0x0004};
+    uint32_t values[2] = {};
+    decode<uint32_t, WordOrder::LITTLE>(registers, values, 2);
+    EXPECT_EQ(values[0], 0x00020001u);
+    EXPECT_EQ(values[1], 0x00040003u);
+}
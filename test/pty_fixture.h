@@ -0,0 +1,37 @@
+#ifndef PROJECT_NEXUS_TEST_PTY_FIXTURE_H
+#define PROJECT_NEXUS_TEST_PTY_FIXTURE_H
+
+#include <pty.h>
+#include <unistd.h>
+#include <string>
+
+namespace Project::nexus::test {
+
+    /// Pseudo terminal for the port tests: `serial::Hardware` opens `name`, the test plays the device on `master`.
+    /// Use `serial::Simulator` instead when the device only needs to reply to frames.
+    struct Pty {
+        int master = -1;
+        int slave = -1; ///< kept open, the port survives while `serial::Hardware` reconnects
+        std::string name;
+
+        Pty() {
+            char buf[64] = {};
+            if (::openpty(&master, &slave, buf, nullptr, nullptr) == 0)
+                name = buf;
+        }
+
+        Pty(const Pty&) = delete;
+        Pty& operator=(const Pty&) = delete;
+
+        ~Pty() {
+            if (slave >= 0)
+                ::close(slave);
+            if (master >= 0)
+                ::close(master);
+        }
+
+        bool isOpen() const { return master >= 0; }
+    };
+}
+
+#endif // PROJECT_NEXUS_TEST_PTY_FIXTURE_H
@@ -0,0 +1,85 @@
+#include "gtest/gtest.h"
+#include "nexus/serial/arbiter.h"
+#include "nexus/modbus/rtu/simulator.h"
+#include "nexus/modbus/rtu/client.h"
+#include <thread>
+#include <etl/keywords.h>
+
+using namespace std::literals;
+
+TEST(serial, arbiter) {
+    var arbiter = nexus::serial::Arbiter(2ms);
+    var order = std::vector<int>();
+    var orderMutex = std::mutex();
+
+    // queue behind a running transaction: low first, then two high ones
+    var slot = arbiter.acquire();
+
+    // a turn that doesn't come by the deadline leaves the queue
+    {
+        val scope = nexus::serial::Arbiter::Scope(nexus::serial::Arbiter::HIGH);
+        EXPECT_EQ(nexus::serial::Arbiter::Scope::priority(), nexus::serial::Arbiter::HIGH);
+        EXPECT_FALSE(arbiter.acquire(nexus::serial::Arbiter::Scope::priority(), std::chrono::steady_clock::now() + 5ms));
+        EXPECT_EQ(arbiter.queued(), 0);
+    }
+    EXPECT_EQ(nexus::serial::Arbiter::Scope::priority(), nexus::serial::Arbiter::NORMAL);
+
+    var threads = std::vector<std::thread>();
+    for (val priority in std::vector<int>{nexus::serial::Arbiter::LOW, nexus::serial::Arbiter::HIGH, nexus::serial::Arbiter::HIGH + 10}) {
+        threads.emplace_back([&, priority] {
+            val scope = nexus::serial::Arbiter::Scope(priority);
+            val held = arbiter.acquire();
+            std::lock_guard<std::mutex> lock(orderMutex);
+            order.push_back(priority);
+        });
+        while (arbiter.queued() < threads.size())
+            std::this_thread::sleep_for(1ms);
+    }
+
+    val released = std::chrono::steady_clock::now();
+    slot = {};
+    for (var &thread in threads)
+        thread.join();
+
+    // higher priority first, every transaction waits for the gap
+    EXPECT_EQ(order, std::vector<int>({nexus::serial::Arbiter::HIGH + 10, nexus::serial::Arbiter::HIGH, nexus::serial::Arbiter::LOW}));
+    EXPECT_GE(std::chrono::steady_clock::now() - released, 6ms);
+    EXPECT_EQ(arbiter.queued(), 0);
+    EXPECT_NE(arbiter.json().find("\"transactions\": 4"), std::string::npos) << arbiter.json();
+}
+
+TEST(modbus, rtu_shared_line) {
+    uint16_t reg = 0x1234;
+    var slave = nexus::modbus::rtu::Simulator(0x01);
+    slave.HoldingRegisterGetter(0x0010, [&reg] { return reg; });
+    ASSERT_FALSE(slave.port().empty());
+
+    // two clients on one line, their requests must not interleave
+    val ser = std::make_shared<nexus::serial::Hardware>(slave.port(), B9600, 100ms, std::make_shared<nexus::modbus::api::Codec>());
+    var poller = nexus::modbus::rtu::Client(0x01, ser);
+    var writer = nexus::modbus::rtu::Client(0x01, ser);
+    ASSERT_TRUE(ser->getArbiter());
+
+    var failures = std::atomic<int>(0);
+    var threads = std::vector<std::thread>();
+    for (val client in {&poller, &writer}) {
+        threads.emplace_back([client, &failures] {
+            for (var i = 0; i < 10; ++i)
+                failures += client->ReadHoldingRegisters(0x0010, 1) != std::vector<uint16_t>({0x1234});
+        });
+    }
+    for (var &thread in threads)
+        thread.join();
+
+    EXPECT_EQ(failures, 0);
+    EXPECT_EQ(slave.requests(), 20);
+    EXPECT_NE(poller.json().find("\"transactions\": 20"), std::string::npos) << poller.json();
+
+    // the asynchronous transactions of both clients run on the line's dispatcher
+    val deadline = std::chrono::steady_clock::now() + 1s;
+    var polled = poller.ReadHoldingRegistersAsync(0x0010, 1, deadline);
+    var read = writer.ReadHoldingRegistersAsync(0x0010, 1, deadline);
+    EXPECT_EQ(polled.get().value, std::vector<uint16_t>({0x1234}));
+    EXPECT_EQ(read.get().value, std::vector<uint16_t>({0x1234}));
+    EXPECT_NE(ser->getDispatcher()->json().find("\"dispatched\": 2"), std::string::npos) << ser->getDispatcher()->json();
+}
@@ -0,0 +1,94 @@
+#include "gtest/gtest.h"
+#include "nexus/serial/hardware.h"
+#include "nexus/serial/replay.h"
+#include "pty_fixture.h"
+#include <unistd.h>
+#include <thread>
+#include <etl/keywords.h>
+
+using namespace std::literals;
+
+TEST(serial, capture_replay) {
+    char dir[] = "/tmp/nexus_capture_XXXXXX";
+    ASSERT_NE(::mkdtemp(dir), nullptr);
+    val path = std::string(dir) + "/port.cap";
+
+    val pty = nexus::test::Pty();
+    ASSERT_TRUE(pty.isOpen());
+
+    val codec = std::make_shared<nexus::serial::Hardware::Codec>();
+    val all = [] (nexus::byte_view) { return true; };
+    val receive = [&] (nexus::serial::Replay& replay) {
+        var res = std::vector<nexus::serial::Hardware::Message>();
+        for (var more = replay.receiveMessages(codec, all); not more.empty(); more = replay.receiveMessages(codec, all))
+            std::move(more.begin(), more.end(), std::back_inserter(res));
+        return res;
+    };
+
+    // record two frames 30ms apart and a request
+    {
+        var ser = nexus::serial::Hardware(pty.name, B115200, 100ms, codec);
+        val capture = std::make_shared<nexus::serial::Capture>(path, 64);
+        ASSERT_TRUE(capture->isOpen());
+        ser.setCapture(capture);
+
+        ASSERT_EQ(::write(pty.master, "first\n", 6), 6);
+        EXPECT_EQ(ser.receive().to_string(), "first\n");
+        std::this_thread::sleep_for(30ms);
+        ASSERT_EQ(::write(pty.master, "second\n", 7), 7);
+        EXPECT_EQ(ser.receive().to_string(), "second\n");
+        EXPECT_EQ(ser.send(std::string_view("ping\n")), 5);
+
+        // the mapping grew past its initial 64 bytes
+        EXPECT_EQ(capture->bytes(), 18);
+        EXPECT_NE(ser.json().find("\"capture\": {"), std::string::npos);
+        ser.setCapture(nullptr);
+    }
+
+    var reader = nexus::serial::Capture::Reader(path);
+    ASSERT_TRUE(reader.isOpen());
+    var rx = std::string();
+    var tx = std::string();
+    var chunk = nexus::serial::Capture::Reader::Chunk{};
+    var last = std::chrono::nanoseconds(0);
+    while (reader.next(chunk)) {
+        EXPECT_GE(chunk.time, last);
+        last = chunk.time;
+        (chunk.direction == nexus::serial::Capture::RX ? rx : tx).append(reinterpret_cast<const char*>(chunk.data), chunk.length);
+    }
+    EXPECT_EQ(rx, "first\nsecond\n");
+    EXPECT_EQ(tx, "ping\n");
+
+    // as fast as possible, through the same decode path
+    {
+        var replay = nexus::serial::Replay(path, codec, false);
+        EXPECT_TRUE(replay.wait(1s));
+        val frames = receive(replay);
+        ASSERT_EQ(frames.size(), 2);
+        EXPECT_EQ(frames[0].data.to_string(), "first\n");
+        EXPECT_EQ(frames[1].data.to_string(), "second\n");
+
+        // sent frames are dropped, playing again starts over
+        EXPECT_EQ(replay.send(std::string_view("ping\n")), 5);
+        replay.reconnect();
+        EXPECT_TRUE(replay.wait(1s));
+        EXPECT_EQ(receive(replay).size(), 2);
+        EXPECT_EQ(replay.chunks(), 2);
+    }
+
+    // at the captured timing
+    {
+        var replay = nexus::serial::Replay(path, codec, true);
+        EXPECT_TRUE(replay.wait(1s));
+        val frames = receive(replay);
+        ASSERT_EQ(frames.size(), 2);
+        EXPECT_GE(frames[1].timestamp - frames[0].timestamp, 25ms);
+    }
+
+    // not a capture
+    ASSERT_EQ(::truncate(path.c_str(), 4), 0);
+    EXPECT_FALSE(nexus::serial::Capture::Reader(path).isOpen());
+
+    ::unlink(path.c_str());
+    ::rmdir(dir);
+}
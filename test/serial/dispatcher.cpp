@@ -0,0 +1,80 @@
+#include "gtest/gtest.h"
+#include "nexus/serial/dispatcher.h"
+#include <future>
+#include <etl/keywords.h>
+
+using namespace std::literals;
+using nexus::serial::Dispatcher;
+
+/// Fill a single worker dispatcher while its worker is held by a gate task
+fun static fill(Dispatcher& dispatcher, std::vector<int>& result, std::promise<void>& gate, int n) -> std::vector<bool> {
+    var opened = gate.get_future().share();
+    dispatcher.dispatch([opened] { opened.wait(); });
+    while (dispatcher.depth() > 0)
+        std::this_thread::yield();
+
+    var res = std::vector<bool>();
+    for (val i in etl::range(n))
+        res.push_back(dispatcher.dispatch([&result, i] { result.push_back(i); }));
+    return res;
+}
+
+TEST(serial, dispatcher_drop_oldest) {
+    var result = std::vector<int>();
+    var gate = std::promise<void>();
+    {
+        var dispatcher = Dispatcher(1, 2, Dispatcher::DROP_OLDEST);
+        val accepted = fill(dispatcher, result, gate, 4);
+        EXPECT_EQ(accepted, std::vector<bool>({true, true, true, true}));
+        EXPECT_EQ(dispatcher.depth(), 2);
+        gate.set_value();
+    }
+    EXPECT_EQ(result, std::vector<int>({2, 3}));
+}
+
+TEST(serial, dispatcher_drop_newest) {
+    var result = std::vector<int>();
+    var gate = std::promise<void>();
+    {
+        var dispatcher = Dispatcher(1, 2, Dispatcher::DROP_NEWEST);
+        val accepted = fill(dispatcher, result, gate, 4);
+        EXPECT_EQ(accepted, std::vector<bool>({true, true, false, false}));
+        gate.set_value();
+    }
+    EXPECT_EQ(result, std::vector<int>({0, 1}));
+}
+
+TEST(serial, dispatcher_block) {
+    var result = std::vector<int>();
+    var gate = std::promise<void>();
+    {
+        var dispatcher = Dispatcher(1, 2, Dispatcher::BLOCK);
+        var producer = std::async(std::launch::async, [&] { return fill(dispatcher, result, gate, 4); });
+        EXPECT_EQ(producer.wait_for(50ms), std::future_status::timeout);
+
+        gate.set_value();
+        EXPECT_EQ(producer.get(), std::vector<bool>({true, true, true, true}));
+    }
+    EXPECT_EQ(result, std::vector<int>({0, 1, 2, 3}));
+}
+
+TEST(serial, dispatcher_failure) {
+    var result = std::vector<int>();
+    var worker_accepted = std::promise<bool>();
+    {
+        var dispatcher = Dispatcher(1, 1);
+
+        // a throwing task is counted, the worker goes on
+        dispatcher.dispatch([] { throw std::runtime_error("callback"); });
+        dispatcher.dispatch([&result] { result.push_back(0); });
+
+        // a worker posting to its own full queue doesn't wait for itself
+        dispatcher.dispatch([&] {
+            dispatcher.dispatch([&result] { result.push_back(1); });
+            worker_accepted.set_value(dispatcher.dispatch([&result] { result.push_back(2); }));
+        });
+        EXPECT_FALSE(worker_accepted.get_future().get());
+        EXPECT_NE(dispatcher.json().find("\"failed\": 1"), std::string::npos);
+    }
+    EXPECT_EQ(result, std::vector<int>({0, 1}));
+}
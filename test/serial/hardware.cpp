@@ -0,0 +1,243 @@
+#include "gtest/gtest.h"
+#include "nexus/serial/hardware.h"
+#include "nexus/serial/software.h"
+#include "pty_fixture.h"
+#include <unistd.h>
+#include <etl/keywords.h>
+
+using namespace std::literals;
+
+TEST(serial, message_queue) {
+    val pty = nexus::test::Pty();
+    ASSERT_TRUE(pty.isOpen());
+
+    val codec = std::make_shared<nexus::serial::Hardware::Codec>();
+    var ser = nexus::serial::Hardware(pty.name, B115200, 100ms, codec);
+    ser.setMessageQueueCapacity(3);
+    val all = [] (nexus::byte_view) { return true; };
+
+    // frames received between two reads are queued in order instead of overwritten
+    val frames = std::string_view("a\nb\nc\nd\n");
+    ASSERT_EQ(::write(pty.master, frames.data(), frames.size()), ssize_t(frames.size()));
+    std::this_thread::sleep_for(50ms);
+
+    EXPECT_EQ(ser.sequence(codec), 4);
+    var res = ser.receiveMessages(codec, all);
+    ASSERT_EQ(res.size(), 3);
+    EXPECT_EQ(res[0].seq, 2);
+    EXPECT_EQ(nexus::byte_view(res[0].data).to_string(), "b\n");
+    EXPECT_EQ(nexus::byte_view(res[2].data).to_string(), "d\n");
+    EXPECT_LE(res[0].timestamp, res[2].timestamp);
+
+    // frames that don't pass the filter stay queued
+    val more = std::string_view("x\ny\n");
+    ASSERT_EQ(::write(pty.master, more.data(), more.size()), ssize_t(more.size()));
+    res = ser.receiveMessages(codec, [] (nexus::byte_view buffer) { return buffer[0] == 'y'; }, 1, 4);
+    ASSERT_EQ(res.size(), 1);
+    EXPECT_EQ(res[0].seq, 6);
+    EXPECT_EQ(ser.receiveCodec(codec, all).to_string(), "x\n");
+
+    // nothing newer than the given sequence number
+    EXPECT_TRUE(ser.receiveMessages(codec, all, 1, ser.sequence(codec)).empty());
+}
+
+TEST(serial, codec_registry) {
+    val pty = nexus::test::Pty();
+    ASSERT_TRUE(pty.isOpen());
+
+    var ser = std::make_shared<nexus::serial::Hardware>(pty.name, B115200, 100ms, nullptr);
+    std::atomic<size_t> received = 0;
+    ser->addCallback([&received] (nexus::byte_view) { ++received; });
+
+    // registrations are counted, the handler goes with the last one
+    val codec = std::make_shared<nexus::serial::Hardware::Codec>();
+    val id = ser->addCodec(codec);
+    EXPECT_EQ(ser->addCodec(codec), id);
+    ser->removeCodec(id);
+    EXPECT_EQ(ser->sequence(codec), 0);
+
+    val line = std::string_view("line\n");
+    ASSERT_EQ(::write(pty.master, line.data(), line.size()), ssize_t(line.size()));
+    EXPECT_EQ(ser->receiveCodec(codec, [] (nexus::byte_view) { return true; }).to_string(), "line\n");
+    ser->removeCodec(id);
+    EXPECT_TRUE(ser->receiveMessages(codec, [] (nexus::byte_view) { return true; }, 1).empty());
+
+    // interfaces come and go while frames are decoded
+    var isRunning = std::atomic<bool>(true);
+    var churn = std::thread([&] {
+        while (isRunning) {
+            val iface = nexus::serial::Hardware::Interface(ser, std::make_shared<nexus::serial::Hardware::Codec>());
+            iface.getSerialHardware();
+        }
+    });
+
+    for (var n = 0; n < 200; ++n) {
+        EXPECT_EQ(::write(pty.master, line.data(), line.size()), ssize_t(line.size()));
+        std::this_thread::sleep_for(100us);
+    }
+
+    val deadline = std::chrono::steady_clock::now() + 1s;
+    while (received < 201 and std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(1ms);
+
+    isRunning = false;
+    churn.join();
+    EXPECT_EQ(received, 201);
+
+    ser.reset();
+}
+
+TEST(serial, callback_reentrancy) {
+    val pty = nexus::test::Pty();
+    ASSERT_TRUE(pty.isOpen());
+
+    var ser = std::make_shared<nexus::serial::Hardware>(pty.name, B115200, 100ms, nullptr);
+    std::atomic<size_t> first = 0;
+    std::atomic<size_t> second = 0;
+
+    // a callback that replaces itself, the next frames go to its replacement
+    var id = nexus::serial::Hardware::CallbackId();
+    id = ser->addCallback([&] (nexus::byte_view) {
+        ++first;
+        ser->removeCallback(id);
+        ser->addCallback([&second] (nexus::byte_view) { ++second; });
+    });
+
+    val wait_for = [] (std::atomic<size_t>& n, size_t expected) {
+        val deadline = std::chrono::steady_clock::now() + 1s;
+        while (n < expected and std::chrono::steady_clock::now() < deadline)
+            std::this_thread::sleep_for(1ms);
+    };
+
+    val line = std::string_view("line\n");
+    ASSERT_EQ(::write(pty.master, line.data(), line.size()), ssize_t(line.size()));
+    wait_for(first, 1);
+    for (var n = 0; n < 2; ++n) {
+        ASSERT_EQ(::write(pty.master, line.data(), line.size()), ssize_t(line.size()));
+        std::this_thread::sleep_for(10ms);
+    }
+    wait_for(second, 2);
+
+    EXPECT_EQ(first, 1);
+    EXPECT_EQ(second, 2);
+
+    ser.reset();
+}
+
+TEST(serial, send_async) {
+    val pty = nexus::test::Pty();
+    ASSERT_TRUE(pty.isOpen());
+
+    val codec = std::make_shared<nexus::serial::Hardware::Codec>();
+    var ser = nexus::serial::Hardware(pty.name, B115200, 100ms, codec);
+
+    // frames from many threads, with futures and callbacks
+    std::atomic<size_t> completed = 0;
+    var futures = std::vector<std::future<int>>();
+    var senders = std::vector<std::thread>();
+    std::mutex mtx;
+    for (var t = 0; t < 4; ++t) senders.emplace_back([&] {
+        for (var n = 0; n < 25; ++n) {
+            var future = ser.sendAsync(codec, std::string_view("0123456789\n"));
+            std::lock_guard<std::mutex> lock(mtx);
+            futures.push_back(std::move(future));
+        }
+        for (var n = 0; n < 25; ++n)
+            ser.sendAsync(codec, std::string_view("0123456789\n"), [&completed] (int res) { completed += res == 11; });
+    });
+
+    for (var &sender in senders)
+        sender.join();
+
+    for (var &future in futures)
+        EXPECT_EQ(future.get(), 11);
+
+    // everything arrives in whole frames
+    var received = std::string();
+    while (received.size() < 200 * 11) {
+        char buf[512];
+        val n = ::read(pty.master, buf, sizeof(buf));
+        ASSERT_GT(n, 0);
+        received.append(buf, n);
+    }
+    EXPECT_EQ(received.size(), 200 * 11);
+    for (size_t i = 0; i < received.size(); i += 11)
+        EXPECT_EQ(received.substr(i, 11), "0123456789\n");
+
+    val deadline = std::chrono::steady_clock::now() + 1s;
+    while (completed < 100 and std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(1ms);
+    EXPECT_EQ(completed, 100);
+
+    val json = ser.json();
+    EXPECT_NE(json.find("\"frames\": 200"), std::string::npos) << json;
+}
+
+TEST(serial, timing) {
+    val pty = nexus::test::Pty();
+    ASSERT_TRUE(pty.isOpen());
+
+    val codec = std::make_shared<nexus::serial::Hardware::Codec>();
+    var ser = nexus::serial::Hardware(pty.name, B115200, 100ms, codec);
+
+    // request, then a response that arrives in two parts
+    val after = ser.sequence(codec);
+    ASSERT_EQ(ser.sendCodec(codec, std::string_view("req\n")), 4);
+    char buf[16];
+    ASSERT_EQ(::read(pty.master, buf, sizeof(buf)), 4);
+
+    std::this_thread::sleep_for(5ms);
+    ASSERT_EQ(::write(pty.master, "re", 2), 2);
+    std::this_thread::sleep_for(20ms);
+    ASSERT_EQ(::write(pty.master, "s\n", 2), 2);
+
+    val res = ser.receiveMessages(codec, [] (nexus::byte_view) { return true; }, 1, after);
+    ASSERT_EQ(res.size(), 1);
+    EXPECT_EQ(nexus::byte_view(res[0].data).to_string(), "res\n");
+    EXPECT_GE(res[0].firstByte, ser.lastSent() + 5ms);
+    EXPECT_GE(res[0].timestamp, res[0].firstByte + 20ms);
+
+    val json = ser.json();
+    val latency = json.find("\"responseLatencyUs\": {\"count\": 1");
+    val gaps = json.find("\"interByteGapUs\": {\"count\": 1");
+    EXPECT_NE(latency, std::string::npos) << json;
+    EXPECT_NE(gaps, std::string::npos) << json;
+}
+
+TEST(serial, baud_rate) {
+    // a speed is a termios constant or a baud rate
+    EXPECT_EQ(nexus::tools::baud_rate(B115200), 115200);
+    EXPECT_EQ(nexus::tools::baud_rate(250000), 250000);
+    EXPECT_EQ(nexus::tools::speed_constant(9600), B9600);
+    EXPECT_EQ(nexus::tools::speed_constant(250000), B0);
+    EXPECT_EQ(nexus::serial::Hardware::t35(9600), nexus::serial::Hardware::t35(B9600));
+    EXPECT_EQ(nexus::serial::Hardware::t35(250000), 1750us);
+    EXPECT_EQ(nexus::serial::Hardware::wireTime(B9600, 96), 100ms);
+
+    val pty = nexus::test::Pty();
+    ASSERT_TRUE(pty.isOpen());
+
+    // no termios constant, set with termios2
+    val codec = std::make_shared<nexus::serial::Hardware::Codec>();
+    var ser = nexus::serial::Hardware(pty.name, 250000, 100ms, codec);
+    ASSERT_TRUE(ser.isConnected());
+    EXPECT_EQ(ser.baudRate(), 250000);
+    EXPECT_NE(ser.json().find("\"baudRate\": 250000"), std::string::npos);
+
+    val frame = std::string_view("fast\n");
+    ASSERT_EQ(::write(pty.master, frame.data(), frame.size()), ssize_t(frame.size()));
+    EXPECT_EQ(ser.receive().to_string(), "fast\n");
+
+    ser.setBaudRate(3000000);
+    EXPECT_TRUE(ser.isConnected());
+    EXPECT_EQ(ser.baudRate(), 3000000);
+
+    // REST reconnect takes the rate or the constant's name
+    val shared = std::make_shared<nexus::serial::Hardware>(pty.name, B9600, 100ms, codec);
+    var sw = nexus::serial::Software(shared);
+    sw.post("reconnect", "{\"speed\": 1500000}");
+    EXPECT_EQ(shared->baudRate(), 1500000);
+    sw.post("reconnect", "{\"speed\": \"B57600\"}");
+    EXPECT_EQ(shared->baudRate(), 57600);
+    EXPECT_TRUE(shared->isConnected());
+}
@@ -0,0 +1,77 @@
+#include "gtest/gtest.h"
+#include "nexus/serial/hotplug.h"
+#include "nexus/serial/simulator.h"
+#include <unistd.h>
+#include <etl/keywords.h>
+
+using namespace std::literals;
+
+TEST(serial, hotplug) {
+    char dir[] = "/tmp/nexus_hotplug_XXXXXX";
+    ASSERT_NE(::mkdtemp(dir), nullptr);
+    val link = std::string(dir) + "/ttyUSB0";
+
+    var sim = nexus::serial::Simulator(nullptr, nexus::serial::Simulator::echo());
+    val hotplug = std::make_shared<nexus::serial::Hotplug>(dir, 20ms, 200ms);
+    EXPECT_TRUE(hotplug->ports().empty());
+
+    // the device is not plugged in yet, senders fail fast while the manager backs off
+    val codec = std::make_shared<nexus::serial::Hardware::Codec>();
+    var ser = nexus::serial::Hardware(link, B115200, 500ms, codec);
+    ser.setHotplug(hotplug);
+    EXPECT_FALSE(ser.isConnected());
+    EXPECT_EQ(ser.send(std::string_view("lost\n")), -1);
+
+    val attempts = [&hotplug] {
+        val json = hotplug->json();
+        return std::stoul(json.substr(json.find("\"attempts\": ") + 12));
+    };
+    std::this_thread::sleep_for(300ms);
+    EXPECT_GE(attempts(), 2);
+    EXPECT_LE(attempts(), 6);
+
+    // plugging the device in reconnects at once, not after the backoff
+    ASSERT_EQ(::symlink(sim.port().c_str(), link.c_str()), 0);
+    var deadline = std::chrono::steady_clock::now() + 100ms;
+    while (not ser.isConnected() and std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(1ms);
+
+    ASSERT_TRUE(ser.isConnected());
+    EXPECT_EQ(hotplug->ports(), std::vector<std::string>({link}));
+    EXPECT_EQ(ser.send(std::string_view("hello\n")), 6);
+    EXPECT_EQ(ser.receiveCodec(codec, [] (nexus::byte_view) { return true; }).to_string(), "hello\n");
+
+    // a receiver waiting for a frame gives up as soon as the port is gone
+    var start = std::chrono::steady_clock::now();
+    var waiting = std::thread([&] { ser.receiveCodec(codec, [] (nexus::byte_view) { return true; }); });
+    std::this_thread::sleep_for(20ms);
+    ser.disconnect();
+    waiting.join();
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 250ms);
+
+    // and it comes back on the manager's thread, reconnect() doesn't wait for it
+    deadline = std::chrono::steady_clock::now() + 100ms;
+    while (not ser.isConnected() and std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(1ms);
+    EXPECT_TRUE(ser.isConnected());
+
+    start = std::chrono::steady_clock::now();
+    ser.reconnect();
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 10ms);
+
+    // the attempt may have opened the device already, let it land before unplugging
+    deadline = std::chrono::steady_clock::now() + 100ms;
+    while (not ser.isConnected() and std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(1ms);
+
+    // unplugged for good
+    ::unlink(link.c_str());
+    ser.disconnect();
+    std::this_thread::sleep_for(50ms);
+    EXPECT_FALSE(ser.isConnected());
+    EXPECT_TRUE(hotplug->ports().empty());
+
+    ser.setHotplug(nullptr);
+    EXPECT_EQ(hotplug->len(), 0);
+    ::rmdir(dir);
+}
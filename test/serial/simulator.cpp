@@ -0,0 +1,59 @@
+#include "gtest/gtest.h"
+#include "nexus/serial/simulator.h"
+#include "nexus/serial/hardware.h"
+#include "nexus/modbus/rtu/simulator.h"
+#include "nexus/modbus/rtu/client.h"
+#include <etl/keywords.h>
+
+using namespace std::literals;
+
+TEST(serial, simulator) {
+    val codec = std::make_shared<nexus::serial::Hardware::Codec>();
+    var echo = nexus::serial::Simulator(codec, nexus::serial::Simulator::echo());
+    ASSERT_FALSE(echo.port().empty());
+
+    var ser = nexus::serial::Hardware(echo.port(), B115200, 100ms, codec);
+    val all = [] (nexus::byte_view) { return true; };
+    ASSERT_TRUE(ser.isConnected());
+
+    // echo with an injected reply delay
+    echo.setDelay(20ms);
+    val after = ser.sequence(codec);
+    ASSERT_EQ(ser.sendCodec(codec, std::string_view("hello\n")), 6);
+    val res = ser.receiveMessages(codec, all, 1, after);
+    ASSERT_EQ(res.size(), 1);
+    EXPECT_EQ(nexus::byte_view(res[0].data).to_string(), "hello\n");
+    EXPECT_GE(res[0].firstByte, ser.lastSent() + 20ms);
+    EXPECT_EQ(echo.requests(), 1);
+    EXPECT_EQ(echo.replies(), 1);
+
+    // unsolicited frames
+    echo.inject(std::string_view("event\n"));
+    EXPECT_EQ(ser.receiveCodec(codec, all).to_string(), "event\n");
+
+    // scripted replies, unknown requests stay unanswered
+    var script = nexus::serial::Simulator(nullptr, nexus::serial::Simulator::script({
+        {"ping\n"sv, "pong\n"sv},
+    }));
+    var dev = nexus::serial::Hardware(script.port(), B115200, 50ms, codec);
+    dev.send(std::string_view("ping\n"));
+    EXPECT_EQ(dev.receiveCodec(codec, all).to_string(), "pong\n");
+    dev.send(std::string_view("what\n"));
+    EXPECT_TRUE(dev.receiveCodec(codec, all).empty());
+    EXPECT_EQ(script.requests(), 2);
+    EXPECT_EQ(script.replies(), 1);
+}
+
+TEST(modbus, rtu_simulator) {
+    uint16_t reg = 0x1234;
+    var slave = nexus::modbus::rtu::Simulator(0x01);
+    slave.HoldingRegisterGetter(0x0010, [&reg] { return reg; });
+    slave.HoldingRegisterSetter(0x0010, [&reg] (uint16_t value) { reg = value; });
+
+    var client = nexus::modbus::rtu::Client(0x01, slave.port(), B9600);
+    EXPECT_EQ(client.ReadHoldingRegisters(0x0010, 1), std::vector<uint16_t>({0x1234}));
+    EXPECT_EQ(client.WriteSingleRegister(0x0010, 0xABCD), 0xABCD);
+    EXPECT_EQ(reg, 0xABCD);
+    EXPECT_EQ(slave.requests(), 2);
+    EXPECT_NE(slave.json().find("\"replies\": 2"), std::string::npos) << slave.json();
+}
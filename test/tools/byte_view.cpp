@@ -44,4 +44,13 @@ TEST(tools, byte_view) {
     EXPECT_EQ(bv.slice(0, 5, 2), nexus::byte_view({1, 3, 5}));
     EXPECT_EQ(bv.slice(4, -1, -1), nexus::byte_view({5, 4, 3, 2, 1}));
     EXPECT_EQ(bv, foo());
+
+    // copies of an owning view share the bytes
+    var d = foo();
+    var e = d;
+    var f = d.slice(1);
+    d = {};
+    EXPECT_EQ(e, nexus::byte_view({1, 2, 3, 4, 5}));
+    EXPECT_EQ(f, nexus::byte_view({2, 3, 4, 5}));
+    EXPECT_EQ(e.data() + 1, f.data());
 }
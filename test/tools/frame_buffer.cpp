@@ -0,0 +1,43 @@
+#include "gtest/gtest.h"
+#include "nexus/tools/frame_buffer.h"
+#include <etl/keywords.h>
+
+TEST(tools, frame_buffer) {
+    var frame = nexus::tools::FrameBuffer(16);
+    frame.assign({3, 4}, 4, 2);
+    EXPECT_EQ(frame.view(), nexus::byte_view({3, 4}));
+    EXPECT_EQ(frame.headroom(), 4);
+    EXPECT_EQ(frame.tailroom(), 10);
+
+    // header and trailer go into the reserved room without moving the bytes
+    val storage = frame.data() - frame.headroom();
+    var head = frame.push(2);
+    head[0] = 1;
+    head[1] = 2;
+    var tail = frame.put(2);
+    tail[0] = 5;
+    tail[1] = 6;
+    EXPECT_EQ(frame.view(), nexus::byte_view({1, 2, 3, 4, 5, 6}));
+    EXPECT_EQ(frame.data() - frame.headroom(), storage);
+
+    frame.pull(1);
+    frame.trim(2);
+    EXPECT_EQ(frame.view(), nexus::byte_view({2, 3, 4}));
+    EXPECT_EQ(frame.headroom(), 3);
+
+    // a view into the frame itself
+    frame.assign(nexus::byte_view{frame.data() + 1, 2});
+    EXPECT_EQ(frame.view(), nexus::byte_view({3, 4}));
+    EXPECT_EQ(frame.headroom(), 0);
+
+    // short room grows the storage, keeping the bytes
+    frame.push(20)[0] = 0xAA;
+    EXPECT_EQ(frame.len(), 22);
+    EXPECT_EQ(frame.data()[0], 0xAA);
+    EXPECT_EQ(frame.view().slice(20).to_vector(), std::vector<uint8_t>({3, 4}));
+    EXPECT_GE(frame.capacity(), 22);
+
+    frame.reset(8);
+    EXPECT_TRUE(frame.empty());
+    EXPECT_EQ(frame.headroom(), 8);
+}
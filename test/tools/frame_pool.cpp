@@ -0,0 +1,39 @@
+#include "gtest/gtest.h"
+#include "nexus/tools/frame_pool.h"
+#include <etl/keywords.h>
+
+TEST(tools, frame_pool) {
+    var pool = std::make_shared<nexus::tools::FramePool>(8, 2);
+    val bytes = std::vector<uint8_t>({1, 2, 3, 4});
+
+    // copies share one block
+    var a = pool->copy(bytes);
+    var b = a;
+    var c = a.slice(1, 3);
+    EXPECT_EQ(a, nexus::byte_view(bytes));
+    EXPECT_EQ(b.data(), a.data());
+    EXPECT_EQ(c, nexus::byte_view({2, 3}));
+    EXPECT_EQ(pool->blocks(), 2);
+    EXPECT_EQ(pool->available(), 1);
+
+    // the block is recycled when the last view is gone
+    val data = a.data();
+    a = {};
+    b = {};
+    EXPECT_EQ(pool->available(), 1);
+    c = {};
+    EXPECT_EQ(pool->available(), 2);
+    EXPECT_EQ(pool->copy(bytes).data(), data);
+
+    // owning views are shared as they are, larger frames fall back to the heap
+    var owned = nexus::byte_view(std::vector<uint8_t>(bytes));
+    val owned_data = owned.data();
+    EXPECT_EQ(pool->share(std::move(owned)).data(), owned_data);
+    EXPECT_EQ(pool->copy(std::vector<uint8_t>(16)).len(), 16);
+    EXPECT_EQ(pool->blocks(), 2);
+
+    // blocks outlive the pool owner
+    var frame = pool->copy(bytes);
+    pool.reset();
+    EXPECT_EQ(frame, nexus::byte_view(bytes));
+}
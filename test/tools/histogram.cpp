@@ -0,0 +1,41 @@
+#include "gtest/gtest.h"
+#include "nexus/tools/histogram.h"
+#include <etl/keywords.h>
+
+using namespace std::literals;
+
+TEST(tools, histogram) {
+    var hist = nexus::tools::Histogram();
+    EXPECT_EQ(hist.count(), 0);
+    EXPECT_EQ(hist.percentile(50), 0);
+
+    // small values are exact, larger values within 1/16
+    for (var v = 1; v <= 1000; ++v)
+        hist.record(uint64_t(v));
+
+    EXPECT_EQ(hist.count(), 1000);
+    EXPECT_EQ(hist.min(), 1);
+    EXPECT_EQ(hist.max(), 1000);
+    EXPECT_EQ(hist.mean(), 500);
+    EXPECT_EQ(hist.percentile(1), 10);
+    EXPECT_NEAR(double(hist.percentile(50)), 500, 500 / 16);
+    EXPECT_NEAR(double(hist.percentile(99)), 990, 990 / 16);
+    EXPECT_EQ(hist.percentile(100), 1000);
+
+    // every value falls into the bucket it is the upper bound of, or below
+    for (val v in {uint64_t(31), uint64_t(32), uint64_t(33), uint64_t(1) << 20, (uint64_t(1) << 20) - 1}) {
+        val i = nexus::tools::Histogram::index(v);
+        EXPECT_GE(nexus::tools::Histogram::highest(i), v);
+        EXPECT_LT(nexus::tools::Histogram::highest(i - 1), v);
+    }
+
+    // durations are recorded in microseconds, huge values are capped
+    hist.reset();
+    hist.record(-5ms);
+    hist.record(2ms);
+    hist.record(UINT64_MAX);
+    EXPECT_EQ(hist.min(), 0);
+    EXPECT_EQ(hist.max(), nexus::tools::Histogram::maxValue);
+    EXPECT_NEAR(double(hist.percentile(50)), 2000, 2000 / 16);
+    EXPECT_NE(hist.json().find("\"count\": 3"), std::string::npos);
+}
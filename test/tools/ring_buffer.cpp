@@ -0,0 +1,61 @@
+#include "gtest/gtest.h"
+#include "nexus/tools/ring_buffer.h"
+#include <thread>
+#include <etl/keywords.h>
+
+TEST(tools, ring_buffer) {
+    var rb = nexus::tools::RingBuffer(8);
+    EXPECT_TRUE(rb.empty());
+    EXPECT_EQ(rb.capacity(), 8);
+
+    EXPECT_EQ(rb.write({1, 2, 3, 4, 5, 6}), 6);
+    EXPECT_EQ(rb.view(), nexus::byte_view({1, 2, 3, 4, 5, 6}));
+
+    rb.consume(4);
+    EXPECT_EQ(rb.view(), nexus::byte_view({5, 6}));
+
+    // wraps around the end of the storage, the view stays contiguous
+    EXPECT_EQ(rb.write({7, 8, 9, 10, 11, 12, 13}), 6);
+    EXPECT_TRUE(rb.full());
+    EXPECT_EQ(rb.view(), nexus::byte_view({5, 6, 7, 8, 9, 10, 11, 12}));
+
+    size_t length;
+    rb.reserve(length);
+    EXPECT_EQ(length, 0);
+
+    rb.consume(3);
+    var ptr = rb.reserve(length);
+    ASSERT_EQ(length, 3);
+    ptr[0] = 13;
+    rb.commit(1);
+    EXPECT_EQ(rb.view(), nexus::byte_view({8, 9, 10, 11, 12, 13}));
+}
+
+TEST(tools, ring_buffer_spsc) {
+    var rb = nexus::tools::RingBuffer(64);
+    val total = 100000;
+
+    var producer = std::thread([&rb, total] {
+        for (int i = 0; i < total;) {
+            uint8_t byte = i;
+            if (rb.write(nexus::byte_view{&byte, 1}) == 1)
+                ++i;
+            else
+                std::this_thread::yield();
+        }
+    });
+
+    var ok = true;
+    for (int i = 0; i < total;) {
+        val view = rb.view();
+        if (view.empty())
+            std::this_thread::yield();
+        
+        for (val byte in view)
+            ok = ok and byte == uint8_t(i++);
+        rb.consume(view.len());
+    }
+
+    producer.join();
+    EXPECT_TRUE(ok);
+}